@@ -1,5 +1,48 @@
 #include "ATCS.h"
 
+// single byte replies have no ';' to terminate in place
+static const char s_szAckFrame[] = { char(ATCL_ACK), 0 };
+static const char s_szNackFrame[] = { char(ATCL_NACK), 0 };
+
+// in place parsers for the typed getters, they only capture references so std::function doesn't allocate
+static ATCLResponseParser parseNumberInto(double &dValue)
+{
+    return [&dValue](const ATCLResponseView &resp) -> int { return atclParseNumber(resp.pszResp, dValue) ? PLUGIN_OK : ERR_PARSE; };
+}
+
+static ATCLResponseParser parseIntegerInto(int &nValue)
+{
+    return [&nValue](const ATCLResponseView &resp) -> int { return atclParseInteger(resp.pszResp, nValue) ? PLUGIN_OK : ERR_PARSE; };
+}
+
+// anything but "Yes" is a no
+static ATCLResponseParser parseYesNoInto(bool &bYes)
+{
+    return [&bYes](const ATCLResponseView &resp) -> int { atclParseYesNo(resp.pszResp, bYes); return PLUGIN_OK; };
+}
+
+// "N/A" when the controller has no coordinates (not aligned yet), dValue is then left at 0
+static ATCLResponseParser parseSexagesimalInto(double &dValue, bool &bNotAvailable)
+{
+    return [&dValue, &bNotAvailable](const ATCLResponseView &resp) -> int {
+        dValue = 0;
+        bNotAvailable = atclIsNotAvailable(resp.pszResp);
+        if(bNotAvailable)
+            return PLUGIN_OK;
+        return atclParseSexagesimal(resp.pszResp, dValue) ? PLUGIN_OK : ERR_PARSE;
+    };
+}
+
+// a batch waits for the link with the priority of its most urgent command
+static ATCLPriority batchPriority(const std::vector<ATCLRequest> &vCmds)
+{
+    ATCLPriority nPriority = ATCL_PRIO_POLL;
+
+    for(size_t i = 0; i < vCmds.size(); i++)
+        nPriority = std::max(nPriority, atclPriority(vCmds[i].nCmd));
+    return nPriority;
+}
+
 // Constructor for ATCS
 ATCS::ATCS()
 {
@@ -12,7 +55,58 @@ ATCS::ATCS()
     m_b24h = false;
     m_bDdMmYy = false;
     m_bTimeSetOnce = false;
-    m_bLimitCached = false;
+    m_nSiteNumber = 0;
+    m_pIniUtil = NULL;
+    m_nInstanceIndex = 0;
+    snapshotClear(m_Snapshot);
+
+    m_pSerx = NULL;
+    m_pTransport = &m_SerXTransport;
+    m_pLinkTransport = &m_SerXTransport;
+    m_pNativeTransport = NULL;
+    m_pReactorChannel = NULL;
+    m_nTransportType = TRANSPORT_SERX;
+    m_ulRxPendingLen = 0;
+    m_ulRxStart = 0;
+    m_bRxResyncNeeded = false;
+    m_nRxLateFrames = 0;
+    m_nRxLateDueNs = 0;
+
+    m_nOpenLoopAxisDir[OL_AXIS_RA] = OL_AXIS_IDLE;
+    m_nOpenLoopAxisDir[OL_AXIS_DEC] = OL_AXIS_IDLE;
+    m_nOpenLoopRate = OL_RATE_UNKNOWN;
+
+    m_bTimedMoveThreadRunning = false;
+    m_bTimedMovePending = false;
+    m_nTimedMoveId = 0;
+    memset(&m_TimedMoveStats, 0, sizeof(m_TimedMoveStats));
+
+    m_bNonSiderealRunning = false;
+    m_dNonSiderealMaxError = NS_DEFAULT_MAX_ERROR;
+    m_nNonSiderealPeriodMs = NS_DEFAULT_PERIOD_MS;
+    memset(&m_NonSiderealStats, 0, sizeof(m_NonSiderealStats));
+
+    m_bSatelliteRunning = false;
+    m_dSatelliteStart = 0;
+    memset(&m_SatelliteStats, 0, sizeof(m_SatelliteStats));
+
+    m_nPollGeneration = 0;
+    m_nAbortGeneration = 0;
+    m_nSlewStartNs = 0;
+    m_bSnapshotPending = false;
+    m_nConnectGeneration = 0;
+    memset(&m_ConnectProgress, 0, sizeof(m_ConnectProgress));
+    m_ConnectProgress.pszStep = "";
+    memset(&m_PollStats, 0, sizeof(m_PollStats));
+    memset(m_nSetterInFlight, 0, sizeof(m_nSetterInFlight));
+    memset(m_bSetterConflict, 0, sizeof(m_bSetterConflict));
+    memset(m_nSetterSeq, 0, sizeof(m_nSetterSeq));
+
+    // sized for the largest exchange up front, they only grow past that for unusually long replies
+    m_sTxBuffer.reserve(SERIAL_BUFFER_SIZE);
+    m_vPollCmds.reserve(POLL_MAX_BATCH);
+    m_svPollResp.reserve(POLL_MAX_BATCH);
+    m_nvPollErr.reserve(POLL_MAX_BATCH);
 
 #ifdef PLUGIN_DEBUG
 #if defined(SB_WIN_BUILD)
@@ -45,6 +139,17 @@ ATCS::~ATCS(void)
     m_sLogFile.flush();
 #endif
 
+    stopConnectThread();
+    stopNonSiderealTracking();
+    stopSatelliteTracking();
+    stopTimedMoveThread();
+    flushTrace();
+
+    if(m_pReactorChannel)
+        delete m_pReactorChannel;
+    if(m_pNativeTransport)
+        delete m_pNativeTransport;
+
 #ifdef    PLUGIN_DEBUG
     // Close LogFile
     if(m_sLogFile.is_open())
@@ -52,11 +157,128 @@ ATCS::~ATCS(void)
 #endif
 }
 
+// select how we talk to the controller, only valid while disconnected.
+int ATCS::setTransportType(ATCSTransportType nType)
+{
+    bool bShared;
+
+    if(m_bIsConnected)
+        return ATCS_ERROR;
+
+    bShared = (m_pReactorChannel != NULL);
+    setSharedReactor(false);
+
+    if(m_pNativeTransport) {
+        delete m_pNativeTransport;
+        m_pNativeTransport = NULL;
+    }
+
+    switch(nType) {
+#ifdef SB_LINUX_BUILD
+        case TRANSPORT_NATIVE_SERIAL:
+            m_pNativeTransport = new LinuxSerialTransport();
+            m_pLinkTransport = m_pNativeTransport;
+            break;
+#endif
+#ifndef SB_WIN_BUILD
+        case TRANSPORT_TCP:
+            m_pNativeTransport = new TCPTransport();
+            m_pLinkTransport = m_pNativeTransport;
+            break;
+#endif
+        default:
+            nType = TRANSPORT_SERX;
+            m_pLinkTransport = &m_SerXTransport;
+            break;
+    }
+    m_pTransport = m_pLinkTransport;
+    m_nTransportType = nType;
+
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
+    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [setTransportType] using " << m_pTransport->name() << " transport." << std::endl;
+    m_sLogFile.flush();
+#endif
+
+    return setSharedReactor(bShared);
+}
+
+// when enabled, reads are done by the I/O thread shared by all the instances in the process
+int ATCS::setSharedReactor(bool bEnable)
+{
+    if(m_bIsConnected)
+        return ATCS_ERROR;
+
+    if(m_pReactorChannel) {
+        delete m_pReactorChannel;
+        m_pReactorChannel = NULL;
+    }
+
+    if(bEnable) {
+        m_pReactorChannel = new ATCSReactorChannel(m_pLinkTransport);
+        m_pTransport = m_pReactorChannel;
+    }
+    else
+        m_pTransport = m_pLinkTransport;
+
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
+    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [setSharedReactor] shared reactor " << (bEnable?"enabled":"disabled") << std::endl;
+    m_sLogFile.flush();
+#endif
+
+    return PLUGIN_OK;
+}
+
+// Chrome trace-event file (load it in chrome://tracing or ui.perfetto.dev)
+int ATCS::setTraceEnabled(bool bEnable)
+{
+    std::string sTracePath;
+
+    if(!bEnable) {
+        CATCSTracer::stop();
+        return PLUGIN_OK;
+    }
+
+#if defined(SB_WIN_BUILD)
+    sTracePath = getenv("HOMEDRIVE");
+    sTracePath += getenv("HOMEPATH");
+    sTracePath += "\\ATCSTrace.json";
+#else
+    sTracePath = getenv("HOME");
+    sTracePath += "/ATCSTrace.json";
+#endif
+    if(!CATCSTracer::start(sTracePath))
+        return ERR_CMDFAILED;
+
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
+    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [setTraceEnabled] tracing to " << sTracePath << std::endl;
+    m_sLogFile.flush();
+#endif
+    return PLUGIN_OK;
+}
+
+int ATCS::flushTrace()
+{
+    return CATCSTracer::flush();
+}
+
+#ifndef SB_WIN_BUILD
+// only the TCP transport keeps latency stats
+int ATCS::getTransportLatencyStats(TransportLatencyStats &stats)
+{
+    TCPTransport *pTCP;
+
+    pTCP = dynamic_cast<TCPTransport *>(m_pLinkTransport);
+    if(!pTCP)
+        return ERR_NOT_IMPL;
+    pTCP->getLatencyStats(stats);
+    return PLUGIN_OK;
+}
+#endif
+
 int ATCS::Connect(char *pszPort)
 {
     int nErr = PLUGIN_OK;
-    bool bIsParked;
-    bool bIsAligned;
+    unsigned int nGeneration;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [Connect] Connect Called." << std::endl;
@@ -64,8 +286,33 @@ int ATCS::Connect(char *pszPort)
     m_sLogFile.flush();
 #endif
 
-    // 19200 8N1
-    if(m_pSerx->open(pszPort, 19200, SerXInterface::B_NOPARITY, "-DTR_CONTROL 1") == 0)
+    stopConnectThread();
+    savePendingSnapshot();
+    nGeneration = m_nConnectGeneration.load();
+
+    m_ulRxPendingLen = 0;
+    m_ulRxStart = 0;
+    m_bRxResyncNeeded = false;
+    m_nRxLateFrames = 0;
+    resetOpenLoopState();
+    m_CommandTimeouts.reset();
+    invalidateSetterShadow();
+    m_nPollGeneration++;
+    m_sFirmwareVersion.clear();
+    m_sHardwareModel.clear();
+    {
+        std::lock_guard<std::mutex> lock(m_PierSideMutex);
+        m_PierSide.reset();
+        m_SlewLimits.clearLimits();
+        m_SlewLimits.clearLatitude();
+        m_tPierSideRead = std::chrono::steady_clock::time_point();
+    }
+    {
+        std::lock_guard<std::mutex> lock(m_SiderealMutex);
+        m_SiderealClock.clearLongitude();
+    }
+    snapshotLoad(m_pIniUtil, m_nInstanceIndex, m_Snapshot);
+    if(m_pTransport->open(pszPort) == 0)
         m_bIsConnected = true;
     else
         m_bIsConnected = false;
@@ -74,6 +321,15 @@ int ATCS::Connect(char *pszPort)
         return ERR_COMMNOLINK;
     timer.Reset();
     while(true) {
+        if(m_nConnectGeneration.load() != nGeneration) {
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
+            m_sLogFile << "["<<getTimeStamp()<<"]"<< " [Connect] cancelled during the handshake." << std::endl;
+            m_sLogFile.flush();
+#endif
+            m_pTransport->close();
+            m_bIsConnected = false;
+            return ERR_ABORTEDPROCESS;
+        }
         nErr = atclEnter();
         if(!nErr)
             break;
@@ -84,79 +340,366 @@ int ATCS::Connect(char *pszPort)
             return ERR_NOLINK;
         }
     }
-    setAsyncUpdateEnabled(false);
-    disablePacketSeqChecking();
-	disableStaticStatusChangeNotification();
-    m_pSerx->purgeTxRx();
+
+    // the link is usable from here, the rest of the setup runs in the background
+    {
+        std::lock_guard<std::mutex> lock(m_ConnectMutex);
+        m_sConnectPort.assign(pszPort);
+        m_ConnectProgress.nStep = 0;
+        m_ConnectProgress.nSteps = 0;
+        m_ConnectProgress.pszStep = "";
+        m_ConnectProgress.nErr = PLUGIN_OK;
+        m_ConnectProgress.bRunning = true;
+        m_ConnectThread = std::thread(&ATCS::connectThread, this, nGeneration);
+    }
+
+    return SB_OK;
+}
+
+// Everything Connect used to do after the handshake.
+// Cancelled by cancelConnect() between steps, Abort() doesn't stop it.
+void ATCS::connectThread(unsigned int nGeneration)
+{
+    int nErr = PLUGIN_OK;
+    bool bIsParked = false;
+    bool bIsAligned = false;
+    bool bStateRead = false;
+    bool bWarm = false;
+
+    std::vector<ATCSStep> steps = {
+        {"controller state", [&]() -> int {
+            // a link error here is caught by the sequential path below
+            bStateRead = (readConnectState(m_sConnectPort.c_str(), bWarm, bIsParked, bIsAligned) == PLUGIN_OK);
+            return PLUGIN_OK;
+        }},
+        {"controller setup", [&]() -> int {
+            if(bStateRead)
+                return PLUGIN_OK;   // done in the state batch
+            setAsyncUpdateEnabled(false);
+            disablePacketSeqChecking();
+            disableStaticStatusChangeNotification();
+            purgeRx();
+            return PLUGIN_OK;
+        }},
+        {"site position", [&]() -> int {
+            int nSiteNb;
+            std::string sLongitude;
+            std::string sLatitude;
+            // for the local hour angles and the horizon check, they just aren't as good without it
+            if(!bStateRead)
+                getUsingSiteNumber(nSiteNb);
+            getSiteLongitude(m_nSiteNumber, sLongitude);
+            getSiteLatitude(m_nSiteNumber, sLatitude);
+            return PLUGIN_OK;
+        }},
+        {"mount type", [&]() -> int {
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
+            m_sLogFile << "["<<getTimeStamp()<<"]"<< " [Connect] m_mountType " << m_mountType << std::endl;
+            m_sLogFile.flush();
+#endif
+            // set mount type
+            switch(m_mountType) {
+                case MountTypeInterface::Symmetrical_Equatorial:
+                    setAlignementType("Polar");
+                    setMeridianAvoidMethod("Lower");
+                    break;
+
+                case MountTypeInterface::Asymmetrical_Equatorial :
+                    setAlignementType("Polar");
+                    setMeridianAvoidMethod("Full(GEM)");
+                    break;
+
+                case MountTypeInterface::AltAz :
+                    setAlignementType("AltAz");
+                    setMeridianAvoidMethod("Lower");
+                    break;
+
+                default :
+                    break;
+            }
+            m_bJNOW = true;
+            setEpochOfEntry("Now");
+            return PLUGIN_OK;
+        }},
+        {"time and date formats", [&]() -> int {
+            if(bStateRead)
+                return PLUGIN_OK;   // read with the fingerprint
+            getLocalTimeFormat(m_b24h);
+            getDateFormat(m_bDdMmYy);
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
+            m_sLogFile << "["<<getTimeStamp()<<"]"<< " [Connect] Time format : " << (m_b24h?"24H":"12H") << std::endl;
+            m_sLogFile << "["<<getTimeStamp()<<"]"<< " [Connect] Date format : " << (m_bDdMmYy?"D/M/Y":"M/D/Y") << std::endl;
+            m_sLogFile.flush();
+#endif
+            return PLUGIN_OK;
+        }},
+        {"time and date", [&]() -> int {
+            // do we need to set the time ?
+            if(!bStateRead && checkSiteTimeDateSetOnce(m_bTimeSetOnce))
+                return ERR_CMDFAILED;
+            if(!m_bTimeSetOnce) {
+                syncTime();
+                syncDate();
+            }
+            return PLUGIN_OK;
+        }},
+        {"resume tracking", [&]() -> int {
+            // are we parked ?
+            if(!bStateRead)
+                getAtPark(bIsParked);
+            if(!bIsParked) {
+                // are we aligned ?
+                if(!bStateRead)
+                    isAligned(bIsAligned);
+                if(bIsAligned) { // if aligned, resume tracking
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
+                    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [Connect] Not parked but aligned, resuming sidereal tracking." << std::endl;
+                    m_sLogFile.flush();
+#endif
+                    setTrackingRates(true, true, 0, 0);
+                }
+            }
+            return PLUGIN_OK;
+        }},
+        {"snapshot", [&]() -> int {
+            if(bWarm)
+                return PLUGIN_OK;
+            // not worth failing the connection for, the next connect will just be a cold one again
+            takeSnapshot(m_sConnectPort.c_str());
+            return PLUGIN_OK;
+        }}
+    };
+    {
+        std::lock_guard<std::mutex> lock(m_ConnectMutex);
+        m_ConnectProgress.nSteps = steps.size();
+    }
+
+    nErr = runSteps("Connect", steps, m_nConnectGeneration, nGeneration, [this, &steps](size_t nStep) {
+        std::lock_guard<std::mutex> lock(m_ConnectMutex);
+        m_ConnectProgress.nStep = nStep;
+        m_ConnectProgress.pszStep = steps[nStep].pszName;
+    });
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
-    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [Connect] m_mountType " << m_mountType << std::endl;
+    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [connectThread] initialization done, nErr = " << nErr << std::endl;
     m_sLogFile.flush();
 #endif
 
-    // set mount type
-    switch(m_mountType) {
-        case MountTypeInterface::Symmetrical_Equatorial:
-            setAlignementType("Polar");
-            setMeridianAvoidMethod("Lower");
-            break;
+    // the link stays up on an error, the operations waiting on the setup report it
+    std::lock_guard<std::mutex> lock(m_ConnectMutex);
+    if(!nErr)
+        m_ConnectProgress.nStep = steps.size();
+    m_ConnectProgress.nErr = nErr;
+    m_ConnectProgress.bRunning = false;
+    m_cvConnect.notify_all();
+}
 
-        case MountTypeInterface::Asymmetrical_Equatorial :
-            setAlignementType("Polar");
-            setMeridianAvoidMethod("Full(GEM)");
-            break;
+void ATCS::getConnectProgress(ConnectProgress &progress)
+{
+    std::lock_guard<std::mutex> lock(m_ConnectMutex);
+    progress = m_ConnectProgress;
+}
 
-        case MountTypeInterface::AltAz :
-            setAlignementType("AltAz");
-            setMeridianAvoidMethod("Lower");
-            break;
-            
-        default :
-            break;
+// The operations that change the mount state wait here for the background part of Connect.
+// Returns its error, PLUGIN_OK when it's done or when called from the setup steps themselves.
+int ATCS::waitConnectDone()
+{
+    std::unique_lock<std::mutex> lock(m_ConnectMutex);
+
+    if(std::this_thread::get_id() == m_ConnectThread.get_id())
+        return PLUGIN_OK;
+    m_cvConnect.wait(lock, [this] { return !m_ConnectProgress.bRunning; });
+    return m_ConnectProgress.nErr;
+}
+
+void ATCS::stopConnectThread()
+{
+    cancelConnect();
+    if(m_ConnectThread.joinable())
+        m_ConnectThread.join();
+}
+
+
+// Controller setup, the snapshot fingerprint and the park/alignment state, all in one write.
+// The formats and limits come from the fingerprint replies. bWarm when the fingerprint matches the saved snapshot, the model and epoch are then taken from it.
+int ATCS::readConnectState(const char *pszPort, bool &bWarm, bool &bIsParked, bool &bIsAligned)
+{
+    int nErr;
+    size_t i;
+    size_t nFingerprint;
+    size_t nState;
+    double dEastAngle = 0;
+    double dWestAngle = 0;
+    std::string sFingerprint;
+    std::vector<ATCLRequest> vCmds = {
+        {ATCL_CMD_QSAU, "No"},
+        {ATCL_CMD_QDPS, ""},
+        {ATCL_CMD_QDCN, ""}
+    };
+    std::vector<std::string> svResp;
+    std::vector<int> nvErr;
+    unsigned int nAlignmentTypeSeq = setterShadowSeq(ATCL_CMD_NSAT);
+    unsigned int nAvoidMethodSeq = setterShadowSeq(ATCL_CMD_NSAM);
+
+    bWarm = false;
+    nFingerprint = vCmds.size();
+    for(i = 0; i < SNAPSHOT_NB_FINGERPRINT; i++)
+        vCmds.push_back({g_SnapshotFingerprintCmds[i], ""});
+    nState = vCmds.size();
+    vCmds.push_back({ATCL_CMD_AGAK, ""});
+    vCmds.push_back({ATCL_CMD_AGAS, ""});
+
+    nErr = ATCSSendCommands(vCmds, svResp, ADAPTIVE_TIMEOUT, &nvErr);
+    if(nvErr.size() != vCmds.size())
+        return nErr ? nErr : ERR_CMDFAILED;
+    // a setup command the controller refused is not a reason to give up on the state
+    for(i = nFingerprint; i < vCmds.size(); i++) {
+        if(nvErr[i])
+            return nvErr[i];
+    }
+
+    for(i = 0; i < SNAPSHOT_NB_FINGERPRINT; i++) {
+        const std::string &sResp = svResp[nFingerprint + i];
+        switch(g_SnapshotFingerprintCmds[i]) {
+            case ATCL_CMD_HGFV:
+                m_sFirmwareVersion = sResp;
+                break;
+            case ATCL_CMD_SGUU:
+                if(!atclParseInteger(sResp.c_str(), m_nSiteNumber))
+                    return ERR_PARSE;
+                break;
+            case ATCL_CMD_ACST:
+                atclParseYesNo(sResp.c_str(), m_bTimeSetOnce);
+                break;
+            // what the controller has now, the mount type setters are skipped when it's already right
+            case ATCL_CMD_NGAT:
+                updateSetterShadow(ATCL_CMD_NSAT, sResp, nAlignmentTypeSeq);
+                break;
+            case ATCL_CMD_NGAM:
+                updateSetterShadow(ATCL_CMD_NSAM, sResp, nAvoidMethodSeq);
+                {
+                    std::lock_guard<std::mutex> lock(m_PierSideMutex);
+                    m_PierSide.setAvoidMethod(sResp);
+                }
+                break;
+            case ATCL_CMD_NGLE:
+                if(!atclParseNumber(sResp.c_str(), dEastAngle))
+                    return ERR_PARSE;
+                break;
+            case ATCL_CMD_NGLW:
+                if(!atclParseNumber(sResp.c_str(), dWestAngle))
+                    return ERR_PARSE;
+                break;
+            case ATCL_CMD_TGLF:
+                m_b24h = (sResp.find("24hr") != std::string::npos);
+                break;
+            case ATCL_CMD_TGDF:
+                m_bDdMmYy = (sResp.find("dd/mm/yy") != std::string::npos);
+                break;
+            default:
+                break;
+        }
     }
-    m_bJNOW = true;
-    setEpochOfEntry("Now");
+    {
+        std::lock_guard<std::mutex> lock(m_PierSideMutex);
+        setLimitAnglesLocked(dEastAngle, dWestAngle);
+    }
+    atclParseYesNo(svResp[nState].c_str(), bIsParked);
+    bIsAligned = (svResp[nState + 1].find("Complete") != std::string::npos);
 
-    nErr = getLocalTimeFormat(m_b24h);
-    nErr = getDateFormat(m_bDdMmYy);
+    sFingerprint = snapshotFingerprint(pszPort, &svResp[nFingerprint], SNAPSHOT_NB_FINGERPRINT);
+    bWarm = m_Snapshot.bValid && m_Snapshot.sFingerprint == sFingerprint;
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
-    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [Connect] Time format : " << (m_b24h?"24H":"12H") << std::endl;
-    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [Connect] Date format : " << (m_bDdMmYy?"D/M/Y":"M/D/Y") << std::endl;
+    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [readConnectState] fingerprint " << sFingerprint << (bWarm ? " matches the snapshot" : " doesn't match the snapshot, full read") << std::endl;
     m_sLogFile.flush();
 #endif
+    if(!bWarm)
+        return PLUGIN_OK;
 
-    // do we need to set the time ?
-    nErr = checkSiteTimeDateSetOnce(m_bTimeSetOnce);
-    if(!nErr) {
-        if(!m_bTimeSetOnce) {
-            nErr = syncTime();
-            nErr = syncDate();
-        }
+    m_sHardwareModel = m_Snapshot.sModel;
+    {
+        // everything the pier side model needs, no refresh before PIER_SIDE_REFRESH_MS
+        std::lock_guard<std::mutex> lock(m_PierSideMutex);
+        m_tPierSideRead = std::chrono::steady_clock::now();
+    }
+    if(!m_Snapshot.sEpoch.empty())
+        updateSetterShadow(ATCL_CMD_PSEP, m_Snapshot.sEpoch, setterShadowSeq(ATCL_CMD_PSEP));
+    return PLUGIN_OK;
+}
+
+// After a cold connect : read what the snapshot holds and save it with the fingerprint of the state we left the controller in.
+int ATCS::takeSnapshot(const char *pszPort)
+{
+    int nErr;
+    ControllerSnapshot snapshot;
+    std::vector<ATCLRequest> vCmds;
+    std::vector<std::string> svResp;
+    std::map<ATCLCommandId, std::string>::iterator it;
+
+    if(!m_pIniUtil)
+        return PLUGIN_OK;
+
+    snapshotClear(snapshot);
+    nErr = getFirmwareVersion(snapshot.sFirmware);
+    nErr |= getModel(snapshot.sModel);
+    nErr |= getUsingSiteNumber(snapshot.nSiteNumber);
+    if(nErr) {
+        snapshotClear(snapshot);
+        queueSnapshot(snapshot);
+        return nErr;
     }
-    else
     {
-        m_bIsConnected = false;
-        return ERR_CMDFAILED;
+        std::lock_guard<std::mutex> lock(m_SetterShadowMutex);
+        it = m_mSetterShadow.find(ATCL_CMD_PSEP);
+        if(it != m_mSetterShadow.end())
+            snapshot.sEpoch = it->second;
     }
 
-    // are we parked ?
-    getAtPark(bIsParked);
-    if(!bIsParked) {
-        // are we aligned ?
-        isAligned(bIsAligned);
-        if(bIsAligned) { // if aligned, resume tracking
+    // the time sync and the mount type setters may have changed some of the fingerprint fields
+    for(size_t i = 0; i < SNAPSHOT_NB_FINGERPRINT; i++)
+        vCmds.push_back({g_SnapshotFingerprintCmds[i], ""});
+    nErr = ATCSSendCommands(vCmds, svResp);
+    if(nErr || svResp.size() != SNAPSHOT_NB_FINGERPRINT) {
+        snapshotClear(snapshot);
+        queueSnapshot(snapshot);
+        return nErr ? nErr : ERR_CMDFAILED;
+    }
+    snapshot.sFingerprint = snapshotFingerprint(pszPort, &svResp[0], SNAPSHOT_NB_FINGERPRINT);
+    snapshot.bValid = true;
+    queueSnapshot(snapshot);
+    m_Snapshot = snapshot;
+
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
-            m_sLogFile << "["<<getTimeStamp()<<"]"<< " [Connect] Not parked but aligned, resuming sidereal tracking." << std::endl;
-            m_sLogFile.flush();
+    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [takeSnapshot] saved, fingerprint " << snapshot.sFingerprint << std::endl;
+    m_sLogFile.flush();
 #endif
-            setTrackingRates(true, true, 0, 0);
-        }
-    }
-    m_bLimitCached = false;
+    return PLUGIN_OK;
+}
 
-    return SB_OK;
+// connect thread, an invalid snapshot erases the saved one
+void ATCS::queueSnapshot(const ControllerSnapshot &snapshot)
+{
+    std::lock_guard<std::mutex> lock(m_ConnectMutex);
+    m_PendingSnapshot = snapshot;
+    m_bSnapshotPending = true;
 }
 
+void ATCS::savePendingSnapshot()
+{
+    ControllerSnapshot snapshot;
+
+    if(!m_bSnapshotPending)
+        return;
+    {
+        std::lock_guard<std::mutex> lock(m_ConnectMutex);
+        snapshot = m_PendingSnapshot;
+        m_bSnapshotPending = false;
+    }
+    if(snapshot.bValid)
+        snapshotSave(m_pIniUtil, m_nInstanceIndex, snapshot);
+    else
+        snapshotInvalidate(m_pIniUtil, m_nInstanceIndex);
+}
 
 int ATCS::Disconnect(void)
 {
@@ -165,19 +708,36 @@ int ATCS::Disconnect(void)
     m_sLogFile.flush();
 #endif
 
+    stopConnectThread();
+    savePendingSnapshot();
+    stopNonSiderealTracking();
+    stopSatelliteTracking();
+    stopTimedMoveThread();
+    invalidateSetterShadow();
+
     if (m_bIsConnected) {
-        if(m_pSerx){
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
-            m_sLogFile << "["<<getTimeStamp()<<"]"<< " [Disconnect] closing serial port." << std::endl;
-            m_sLogFile.flush();
+        m_sLogFile << "["<<getTimeStamp()<<"]"<< " [Disconnect] closing " << m_pTransport->name() << " port." << std::endl;
+#ifndef SB_WIN_BUILD
+        TransportLatencyStats stats;
+        if(getTransportLatencyStats(stats) == PLUGIN_OK && stats.ulSamples)
+            m_sLogFile << "["<<getTimeStamp()<<"]"<< " [Disconnect] round trip latency (us) min " << stats.llMin << " max " << stats.llMax << " mean " << stats.llTotal/(long long)stats.ulSamples << " over " << stats.ulSamples << " commands" << std::endl;
+#endif
+        PollStats pollStats;
+        getPollStats(pollStats);
+        m_sLogFile << "["<<getTimeStamp()<<"]"<< " [Disconnect] status polls : " << pollStats.ulRequests << " requests, " << pollStats.ulCacheHits << " from cache, " << pollStats.ulCommands << " commands in " << pollStats.ulBatches << " batches, " << pollStats.ulFailedBatches << " failed" << std::endl;
+        m_sLogFile << "["<<getTimeStamp()<<"]"<< " [Disconnect] timing :" << std::endl;
+        CTimingSite::report(m_sLogFile.stream());
+        m_sLogFile.flush();
 #endif
-            m_pSerx->flushTx();
-            m_pSerx->purgeTxRx();
-            m_pSerx->close();
-        }
+        // let a sync or slew started from another thread finish its exchanges
+        std::lock_guard<std::mutex> targetLock(m_TargetMutex);
+        purgeRx();
+        m_pTransport->close();
     }
+    flushTrace();
 	m_bIsConnected = false;
-    m_bLimitCached = false;
+    resetOpenLoopState();
 
 	return SB_OK;
 }
@@ -200,193 +760,716 @@ int ATCS::getRateName(int nZeroBasedIndex, std::string &sOut)
 
 #pragma mark - ATCS communication
 
-int ATCS::ATCSSendCommand(const std::string sCmd, std::string &sResp, int nTimeout)
+int ATCS::ATCSSendCommand(ATCLCommandId nCmd, std::string &sResp, int nTimeout)
+{
+    return ATCSSendCommand(nCmd, "", sResp, nTimeout);
+}
+
+// the reply is copied out for callers that keep it as a string (names, versions, ... going back to TheSkyX)
+int ATCS::ATCSSendCommand(ATCLCommandId nCmd, const std::string &sArgs, std::string &sResp, int nTimeout)
+{
+    int nErr;
+    ATCLResponseView resp;
+    ATCS_TIMED_LOCK(lock, &m_CommandMutex.level(atclPriority(nCmd)), "ATCS command mutex wait");
+
+    nErr = sendCommandLocked(nCmd, sArgs, resp, nTimeout);
+    sResp.assign(resp.pszResp, resp.nLen);
+    return nErr;
+}
+
+int ATCS::ATCSSendCommand(ATCLCommandId nCmd, const ATCLResponseParser &fnParse, int nTimeout)
+{
+    return ATCSSendCommand(nCmd, "", fnParse, nTimeout);
+}
+
+// the reply is parsed where it was received, fnParse runs before anything else can use the link
+int ATCS::ATCSSendCommand(ATCLCommandId nCmd, const std::string &sArgs, const ATCLResponseParser &fnParse, int nTimeout)
+{
+    int nErr;
+    ATCLResponseView resp;
+    ATCS_TIMED_LOCK(lock, &m_CommandMutex.level(atclPriority(nCmd)), "ATCS command mutex wait");
+
+    nErr = sendCommandLocked(nCmd, sArgs, resp, nTimeout);
+    if(!nErr)
+        nErr = fnParse(resp);
+    return nErr;
+}
+
+// m_CommandMutex held by the caller
+int ATCS::sendCommandLocked(ATCLCommandId nCmd, const std::string &sArgs, ATCLResponseView &resp, int nTimeout)
 {
+    ATCS_SCOPED_SPAN("ATCS::ATCSSendCommand");
     int nErr = PLUGIN_OK;
-    unsigned long  ulBytesWrite;
-    bool resp_ok = false;
+    int nAttempt;
+    int64_t nSendNs;
 
-    sResp.clear();
+    m_sTxBuffer.clear();
+    atclAppend(m_sTxBuffer, nCmd, sArgs);
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
-    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [ATCSSendCommand std::string] sending " << sCmd << std::endl;
+    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [ATCSSendCommand std::string] sending " << m_sTxBuffer << std::endl;
     m_sLogFile.flush();
 #endif
 
-    nErr = m_pSerx->writeFile((void *)sCmd.c_str(), sCmd.size(), ulBytesWrite);
-    m_pSerx->flushTx();
-    if(nErr)
-        return nErr;
-    // read response
-    while(!resp_ok) {
-        nErr = ATCSreadResponse(sResp, nTimeout);
-        if(nErr) {
+    if(nTimeout == ADAPTIVE_TIMEOUT)
+        nTimeout = m_CommandTimeouts.timeoutFor(nCmd);
+    // anything but a query may change what the status polls would return
+    if(!atclIsQuery(nCmd))
+        m_nPollGeneration++;
+
+    resyncRxIfNeeded();
+
+    for(nAttempt = 0; ; nAttempt++) {
+        nSendNs = CSteadyTimer::NowNs();
+        ATCS_PROBE_CMD_SEND(ATCS_CMD_MNEMONIC(nCmd), ATCS_CMD_MNEMONIC_LEN(nCmd));
+        {
+            ATCS_SCOPED_SPAN("transport write");
+            nErr = m_pTransport->write(m_sTxBuffer.c_str(), m_sTxBuffer.size());
+        }
+        if(nErr)
+            return nErr;
+
+        nErr = ATCSwaitCommandResponse(resp, nTimeout);
+        // On a retry the earlier replies may still come in first. They answer the same query so the
+        // first one we can parse will do, what's left of a truncated one is dropped.
+        while(nAttempt && !nErr && m_nRxLateFrames > 0 && !atclResponseValid(nCmd, resp.pszResp)) {
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
-            if(sResp[0] == char(ATCL_NACK ))
-                m_sLogFile << "["<<getTimeStamp()<<"]"<< " [ATCSSendCommand std::string] ERROR reading response , ATCL_NACK received " << std::uppercase << std::setfill('0') << std::setw(2) << std::hex << (unsigned int)((unsigned char)sResp[0]) << std::endl;
-            else if(sResp[0] == char(ATCL_ACK ))
-                m_sLogFile << "["<<getTimeStamp()<<"]"<< " [ATCSSendCommand std::string] ERROR reading response , ATCL_ACK received " << std::uppercase << std::setfill('0') << std::setw(2) << std::hex << (unsigned int)((unsigned char)sResp[0]) << std::endl;
-            else
-                m_sLogFile << "["<<getTimeStamp()<<"]"<< " [ATCSSendCommand std::string] ERROR " << nErr<< " reading response :" << sResp << std::endl;
+            m_sLogFile << "["<<getTimeStamp()<<"]"<< " [ATCSSendCommand std::string] dropping late frame " << resp.pszResp << std::endl;
             m_sLogFile.flush();
-            m_sLogFile << std::dec;
 #endif
-            return nErr;
+            m_nRxLateFrames--;
+            nErr = ATCSwaitCommandResponse(resp, nTimeout);
+        }
+        // a NACK is still a reply, only real timeouts are left out of the latency stats
+        if(nErr == COMMAND_TIMEOUT) {
+            m_CommandTimeouts.recordTimeout(nCmd);
+            expectLateReply(nCmd, nSendNs);
         }
+        else if(!nAttempt && (!nErr || nErr == ATCS_BAD_CMD_RESPONSE))
+            m_CommandTimeouts.recordLatency(nCmd, CSteadyTimer::NowNs() - nSendNs);
+        // we took an earlier reply, the one to this attempt is now the late one
+        else if(nAttempt && !nErr && m_nRxLateFrames > 0)
+            m_nRxLateDueNs = std::max(m_nRxLateDueNs, nSendNs + (int64_t)atclCommand(nCmd).nTimeoutMs * 1000000);
+#ifdef ATCS_PROBES_ENABLED
+        probeCommandDone(nCmd, nSendNs, nErr);
+#endif
 
+        // queries can be asked again right away, anything that moves or changes the mount is never resent
+        if(nErr != COMMAND_TIMEOUT || nAttempt >= CMD_MAX_RETRY || !atclIsQuery(nCmd))
+            break;
 
-        // filter out async status and log them in debug mode
-        if(sResp.size()) {
-            if(sResp[0] == char(ATCL_STATUS) ||
-               sResp[0]== char(ATCL_WARNING) ||
-               sResp[0] == char(ATCL_ALERT) ||
-               sResp[0] == char(ATCL_INTERNAL_ERROR) ||
-               sResp[0] == char(ATCL_IDC_ASYNCH)
-               ) {
-#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
-                m_sLogFile << "["<<getTimeStamp()<<"]"<< " [ATCSSendCommand std::string] Async message :  " << sResp.substr(1, sResp.length()) << std::endl;
-                m_sLogFile.flush();
-#endif
-            }
-            else {
-                if(sResp[0] == char(ATCL_SYNTAX_ERROR)) { // not async but we need to log it
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
-                    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [ATCSSendCommand std::string] Async message :  " << sResp.substr(1, sResp.length()) << std::endl;
-                    m_sLogFile.flush();
+        m_sLogFile << "["<<getTimeStamp()<<"]"<< " [ATCSSendCommand std::string] timeout, retrying " << m_sTxBuffer << std::endl;
+        m_sLogFile.flush();
 #endif
+        // Don't wait for the late reply, the controller is as fast as usual and only that reply was lost
+        // or cut short. Drop the rest of a truncated frame so it's not taken as the start of the retry
+        // answer and ask again with a timeout of a few times the usual latency.
+        resyncRxIfNeeded(false, resp.nLen != 0);
+        nTimeout = m_CommandTimeouts.retryTimeoutFor(nCmd, nTimeout);
+    }
+    return nErr;
+}
+
+// After a timeout the late reply (or the rest of a corrupted frame) may still arrive.
+// Before the next command we read and drop one frame per reply that timed out, for as long as
+// its default timeout allows, then wait for the line to stay quiet and purge what's left.
+// Otherwise a late reply would be taken as the next command's answer.
+// Before a retry (bWaitLateReplies false) we only drop what comes until the line is quiet, the replies still
+// due are counted and sorted out while waiting for the retry answer. bPartialFrame tells that the reply that
+// timed out was cut short, the bytes that follow finish it, if none come it's not coming.
+void ATCS::resyncRxIfNeeded(bool bWaitLateReplies, bool bPartialFrame)
+{
+    int nErr;
+    int nWaitMs;
+    unsigned long ulBytesRead;
+    unsigned long ulDropped = 0;
+    char cFrameStart = 0;
+    char c;
+
+    if(!m_bRxResyncNeeded)
+        return;
+
+    while(true) {
+        if(bWaitLateReplies && m_nRxLateFrames > 0)
+            nWaitMs = (int)((m_nRxLateDueNs - CSteadyTimer::NowNs()) / 1000000);
+        else
+            nWaitMs = 0;
+        nWaitMs = std::max(nWaitMs, RX_RESYNC_QUIET_MS);
+        nErr = m_pTransport->read(m_szRxPending, SERIAL_BUFFER_SIZE - 1, ulBytesRead, nWaitMs);
+        if(nErr)
+            break;  // quiet (or the link is gone, the next write will tell)
+        ulDropped += ulBytesRead;
+        for(unsigned long i = 0; i < ulBytesRead; i++) {
+            c = m_szRxPending[i];
+            if(bPartialFrame) {
+                // the rest of the reply that timed out
+                if(c == ';') {
+                    m_nRxLateFrames--;
+                    bPartialFrame = false;
                 }
-                resp_ok = true;
+                continue;
             }
+            if(!cFrameStart && (c == char(ATCL_ACK) || c == char(ATCL_NACK))) {
+                m_nRxLateFrames--;
+                continue;
+            }
+            if(!cFrameStart)
+                cFrameStart = c;
+            if(c != ';')
+                continue;
+            // async messages are not replies
+            if(cFrameStart != char(ATCL_STATUS) && cFrameStart != char(ATCL_WARNING) && cFrameStart != char(ATCL_ALERT) &&
+               cFrameStart != char(ATCL_INTERNAL_ERROR) && cFrameStart != char(ATCL_IDC_ASYNCH))
+                m_nRxLateFrames--;
+            cFrameStart = 0;
         }
-    } // end while(!resp_ok)
-    if(sResp.size()) {
-        sResp = rtrim(sResp, "%");
+    }
+    // the line went quiet in the middle of that reply, it was truncated
+    if(bPartialFrame)
+        m_nRxLateFrames--;
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
-        if(sResp[0] == char(ATCL_ACK) )
-            m_sLogFile << "["<<getTimeStamp()<<"]"<< " [ATCSSendCommand std::string]  got ATCL_ACK : " << std::uppercase << std::setfill('0') << std::setw(2) << std::hex << (unsigned int)((unsigned char)sResp[0]) << std::endl;
-        else if(sResp[0] == char(ATCL_NACK) )
-            m_sLogFile << "["<<getTimeStamp()<<"]"<< " [ATCSSendCommand std::string]  got ATCL_NACK : " << std::uppercase << std::setfill('0') << std::setw(2) << std::hex << (unsigned int)((unsigned char)sResp[0]) << std::endl;
-        else {
-            m_sLogFile << "["<<getTimeStamp()<<"]"<< " [ATCSSendCommand std::string]  got response : " << sResp << std::endl;
-        }
-        m_sLogFile.flush();
-        m_sLogFile << std::dec;
+    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [resyncRxIfNeeded] dropped " << m_ulRxPendingLen + ulDropped << " bytes, " << std::max(m_nRxLateFrames, 0) << (bWaitLateReplies ? " late replies never came" : " late replies still due") << std::endl;
+    m_sLogFile.flush();
 #endif
-
+    if(bWaitLateReplies || m_nRxLateFrames <= 0) {
+        purgeRx();
+        return;
     }
+    m_ulRxPendingLen = 0;
+    m_ulRxStart = 0;
+}
 
-    return nErr;
+void ATCS::expectLateReply(ATCLCommandId nCmd, int64_t nSendNs)
+{
+    m_bRxResyncNeeded = true;
+    m_nRxLateFrames++;
+    m_nRxLateDueNs = std::max(m_nRxLateDueNs, nSendNs + (int64_t)atclCommand(nCmd).nTimeoutMs * 1000000);
 }
 
+// Run a multi-step operation one step at a time.
+// Each step takes the command mutex for its own exchanges only, so the status polls and the tracking
+// threads get the link between steps, and a requestAbort() from any thread stops the sequence there.
+int ATCS::runSteps(const char *pszOperation, const std::vector<ATCSStep> &steps)
+{
+    return runSteps(pszOperation, steps, m_nAbortGeneration, m_nAbortGeneration.load(), nullptr);
+}
 
-int ATCS::ATCSreadResponse(std::string &sResp, int nTimeout)
+// same, stopped by a change of nCancelGeneration from nGeneration, fnProgress (if set) is called before each step
+int ATCS::runSteps(const char *pszOperation, const std::vector<ATCSStep> &steps, const std::atomic<unsigned int> &nCancelGeneration, unsigned int nGeneration, const std::function<void(size_t)> &fnProgress)
 {
     int nErr = PLUGIN_OK;
-    char pszBuf[SERIAL_BUFFER_SIZE];
-    unsigned long ulBytesRead = 0;
-    unsigned long ulTotalBytesRead = 0;
-    char *pszBufPtr;
-    int nBytesWaiting = 0 ;
-    int nbTimeouts = 0;
-
-    memset(pszBuf, 0, SERIAL_BUFFER_SIZE);
-    pszBufPtr = pszBuf;
+    (void)pszOperation; // only logged
 
-    do {
-        nErr = m_pSerx->bytesWaitingRx(nBytesWaiting);
-#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 3
-        m_sLogFile << "["<<getTimeStamp()<<"]"<< " [readResponse std::string] nBytesWaiting      : " << nBytesWaiting << std::endl;
-        m_sLogFile << "["<<getTimeStamp()<<"]"<< " [readResponse std::string] nBytesWaiting nErr : " << nErr << std::endl;
-        m_sLogFile.flush();
-#endif
-        if(!nBytesWaiting) {
-            nbTimeouts += MAX_READ_WAIT_TIMEOUT;
-            if(nbTimeouts >= nTimeout) {
-#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 3
-                m_sLogFile << "["<<getTimeStamp()<<"]"<< " [readResponse std::string] bytesWaitingRx timeout, no data for " << nbTimeouts << " ms"<< std::endl;
-                m_sLogFile.flush();
+    for(size_t i = 0; i < steps.size(); i++) {
+        if(nCancelGeneration.load() != nGeneration) {
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
+            m_sLogFile << "["<<getTimeStamp()<<"]"<< " [" << pszOperation << "] aborted before step " << steps[i].pszName << std::endl;
+            m_sLogFile.flush();
 #endif
-                nErr = COMMAND_TIMEOUT;
-                break;
-            }
-            std::this_thread::sleep_for(std::chrono::milliseconds(MAX_READ_WAIT_TIMEOUT));
+            return ATCS_ABORTED;
+        }
+        if(fnProgress)
+            fnProgress(i);
+        nErr = steps[i].fnStep();
+        if(nErr) {
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
+            m_sLogFile << "["<<getTimeStamp()<<"]"<< " [" << pszOperation << "] " << steps[i].pszName << " nErr = " << nErr << std::endl;
+            m_sLogFile.flush();
+#endif
+            return nErr;
+        }
+    }
+    return PLUGIN_OK;
+}
+
+// send several commands in a single write and collect one reply per command.
+// Replies are copied into svResp's existing strings, pass the same vector again to reuse them.
+int ATCS::ATCSSendCommands(const std::vector<ATCLRequest> &vCmds, std::vector<std::string> &svResp, int nTimeout, std::vector<int> *pnvErr)
+{
+    ATCS_SCOPED_SPAN("ATCS::ATCSSendCommands");
+    int nErr = PLUGIN_OK;
+    int nRespErr;
+    int nCmdTimeout = 0;
+    int64_t nSendNs;
+    size_t nReplies = 0;
+    ATCLResponseView resp;
+    ATCS_TIMED_LOCK(lock, &m_CommandMutex.level(batchPriority(vCmds)), "ATCS command mutex wait");
+
+    if(pnvErr)
+        pnvErr->clear();
+    if(vCmds.empty()) {
+        svResp.clear();
+        return PLUGIN_OK;
+    }
+    svResp.resize(vCmds.size());
+
+    m_sTxBuffer.clear();
+    for(size_t i = 0; i < vCmds.size(); i++) {
+        atclAppend(m_sTxBuffer, vCmds[i].nCmd, vCmds[i].sArgs);
+        if(!atclIsQuery(vCmds[i].nCmd))
+            m_nPollGeneration++;
+        if(nTimeout == ADAPTIVE_TIMEOUT)
+            nCmdTimeout = std::max(nCmdTimeout, m_CommandTimeouts.timeoutFor(vCmds[i].nCmd));
+    }
+    if(nTimeout == ADAPTIVE_TIMEOUT)
+        nTimeout = nCmdTimeout;
+
+    resyncRxIfNeeded();
+
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
+    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [ATCSSendCommands] sending " << m_sTxBuffer << std::endl;
+    m_sLogFile.flush();
+#endif
+
+    nSendNs = CSteadyTimer::NowNs();
+#ifdef ATCS_PROBES_ENABLED
+    for(size_t i = 0; i < vCmds.size(); i++)
+        ATCS_PROBE_CMD_SEND(ATCS_CMD_MNEMONIC(vCmds[i].nCmd), ATCS_CMD_MNEMONIC_LEN(vCmds[i].nCmd));
+#endif
+    {
+        ATCS_SCOPED_SPAN("transport write");
+        nErr = m_pTransport->write(m_sTxBuffer.c_str(), m_sTxBuffer.size());
+    }
+    if(nErr) {
+        svResp.clear();
+        return nErr;
+    }
+
+    // the controller answers in order, keep reading even if one failed so the next exchange isn't out of sync
+    for(size_t i = 0; i < vCmds.size(); i++) {
+        nRespErr = ATCSwaitCommandResponse(resp, nTimeout);
+        svResp[i].assign(resp.pszResp, resp.nLen);
+        nReplies++;
+        // later replies in the batch queue behind the first one, only the first is a clean sample
+        if(nRespErr == COMMAND_TIMEOUT) {
+            m_CommandTimeouts.recordTimeout(vCmds[i].nCmd);
+            // none of the replies behind it came either
+            for(size_t j = i; j < vCmds.size(); j++)
+                expectLateReply(vCmds[j].nCmd, nSendNs);
+        }
+        else if(i == 0 && (!nRespErr || nRespErr == ATCS_BAD_CMD_RESPONSE))
+            m_CommandTimeouts.recordLatency(vCmds[i].nCmd, CSteadyTimer::NowNs() - nSendNs);
+#ifdef ATCS_PROBES_ENABLED
+        probeCommandDone(vCmds[i].nCmd, nSendNs, nRespErr);
+#endif
+        if(pnvErr)
+            pnvErr->push_back(nRespErr);
+        if(nRespErr && !nErr)
+            nErr = nRespErr;
+        if(nRespErr && nRespErr != ATCS_BAD_CMD_RESPONSE)
+            break; // timeout or link error, the remaining replies are not coming
+    }
+    svResp.resize(nReplies);
+    return nErr;
+}
+
+// Read a status field, at most nMaxAgeMs old.
+// Callers say how fresh they need a field to be and get the cached reply when it still is.
+// When it isn't, every other field that is stale or about to be is read in the same write,
+// so the link load only depends on the fields and their freshness, not on how often they're polled.
+int ATCS::pollRead(ATCLCommandId nCmd, std::string &sResp, int nMaxAgeMs, bool *pbFromLink)
+{
+    return pollRead(nCmd, [&sResp](const ATCLResponseView &resp) -> int { sResp.assign(resp.pszResp, resp.nLen); return PLUGIN_OK; }, nMaxAgeMs, pbFromLink);
+}
+
+// fnParse gets the cached or freshly read reply under m_PollMutex, it must not call pollRead.
+// *pbFromLink tells if the reply was read by this call rather than taken from the cache.
+int ATCS::pollRead(ATCLCommandId nCmd, const ATCLResponseParser &fnParse, int nMaxAgeMs, bool *pbFromLink)
+{
+    int nErr = PLUGIN_OK;
+    unsigned int nGeneration;
+    long long llAgeMs;
+    std::map<ATCLCommandId, PollField>::iterator it;
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+
+    if(pbFromLink)
+        *pbFromLink = true;
+    // only status queries are cached
+    if(!atclIsPolled(nCmd))
+        return ATCSSendCommand(nCmd, fnParse);
+    if(nMaxAgeMs == POLL_AGE_DEFAULT)
+        nMaxAgeMs = atclCommand(nCmd).nPollAgeMs;
+
+    std::lock_guard<std::mutex> lock(m_PollMutex);
+    m_PollStats.ulRequests++;
+    it = m_mPollFields.find(nCmd);
+    if(it == m_mPollFields.end()) {
+        PollField newField;
+        newField.bValid = false;
+        newField.nGeneration = 0;
+        newField.nMaxAgeMs = nMaxAgeMs;
+        newField.tLastRequest = now;
+        it = m_mPollFields.insert(std::make_pair(nCmd, newField)).first;
+    }
+    PollField &field = it->second;
+    // renew the registration, a lapsed one starts over with this caller's freshness
+    if(std::chrono::duration_cast<std::chrono::milliseconds>(now - field.tLastRequest).count() > POLL_REG_EXPIRE_MS)
+        field.nMaxAgeMs = nMaxAgeMs;
+    else
+        field.nMaxAgeMs = std::min(field.nMaxAgeMs, nMaxAgeMs);
+    field.tLastRequest = now;
+
+    if(field.bValid && field.nGeneration == m_nPollGeneration &&
+       std::chrono::duration_cast<std::chrono::milliseconds>(now - field.tRead).count() <= nMaxAgeMs) {
+        m_PollStats.ulCacheHits++;
+        if(pbFromLink)
+            *pbFromLink = false;
+        return fnParse(ATCLResponseView{field.sResp.c_str(), field.sResp.size()});
+    }
+
+    // this tick's batch : the field asked for + the registered ones expiring before the next tick
+    std::vector<ATCLRequest> &vCmds = m_vPollCmds;
+    std::vector<std::string> &svResp = m_svPollResp;
+    std::vector<int> &nvErr = m_nvPollErr;
+    vCmds.clear();
+    vCmds.push_back({nCmd, ""});
+    for(it = m_mPollFields.begin(); it != m_mPollFields.end() && vCmds.size() < POLL_MAX_BATCH; ++it) {
+        if(it->first == nCmd)
+            continue;
+        if(std::chrono::duration_cast<std::chrono::milliseconds>(now - it->second.tLastRequest).count() > POLL_REG_EXPIRE_MS)
             continue;
+        llAgeMs = std::chrono::duration_cast<std::chrono::milliseconds>(now - it->second.tRead).count();
+        if(!it->second.bValid || it->second.nGeneration != m_nPollGeneration || llAgeMs + POLL_TICK_MS > it->second.nMaxAgeMs)
+            vCmds.push_back({it->first, ""});
+    }
+
+    nGeneration = m_nPollGeneration;
+    nErr = ATCSSendCommands(vCmds, svResp, ADAPTIVE_TIMEOUT, &nvErr);
+    m_PollStats.ulBatches++;
+    m_PollStats.ulCommands += vCmds.size();
+    if(nErr)
+        m_PollStats.ulFailedBatches++;
+    now = std::chrono::steady_clock::now();
+
+    // a reply that doesn't hold the command's response type (garbled, or the answer to another command) isn't cached
+    for(size_t i = 0; i < vCmds.size(); i++) {
+        PollField &batchField = m_mPollFields[vCmds[i].nCmd];
+        if(i < nvErr.size() && !nvErr[i] && atclResponseValid(vCmds[i].nCmd, svResp[i].c_str())) {
+            batchField.sResp.swap(svResp[i]);   // the batch string becomes the cache, no copy
+            batchField.bValid = true;
+            batchField.nGeneration = nGeneration;
+            batchField.tRead = now;
         }
-        nbTimeouts = 0;
-        if(ulTotalBytesRead + nBytesWaiting <= SERIAL_BUFFER_SIZE) {
-            nErr = m_pSerx->readFile(pszBufPtr, nBytesWaiting, ulBytesRead, nTimeout);
-            // check for  errors or single ACK
-            if(*pszBufPtr == char(ATCL_NACK)) {
-#if defined PLUGIN_DEBUG
-                m_sLogFile << "["<<getTimeStamp()<<"]"<< " [readResponse std::string] ATCL_NACK received." << std::endl;
-                m_sLogFile.flush();
+        else
+            batchField.bValid = false;
+    }
+
+    PollField &askedField = m_mPollFields[nCmd];
+    if(askedField.bValid)
+        return fnParse(ATCLResponseView{askedField.sResp.c_str(), askedField.sResp.size()});
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
+    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [pollRead] batch read of " << atclMnemonic(nCmd) << " failed, nErr = " << nErr << ", reading it on its own" << std::endl;
+    m_sLogFile.flush();
 #endif
-                ulTotalBytesRead += ulBytesRead;
-                nErr = ATCS_BAD_CMD_RESPONSE;
-                break;
-            }
+    // on its own, with the usual retry
+    return ATCSSendCommand(nCmd, fnParse);
+}
 
-            if(*pszBufPtr == char(ATCL_ACK)) {
-#if defined PLUGIN_DEBUG
-                m_sLogFile << "["<<getTimeStamp()<<"]"<< " [readResponse std::string] ATCL_ACK received." << std::endl;
+void ATCS::getPollStats(PollStats &stats)
+{
+    std::lock_guard<std::mutex> lock(m_PollMutex);
+    stats = m_PollStats;
+}
+
+#ifdef ATCS_PROBES_ENABLED
+void ATCS::probeCommandDone(ATCLCommandId nCmd, int64_t nSendNs, int nErr)
+{
+    int64_t nLatencyNs = CSteadyTimer::NowNs() - nSendNs;
+
+    if(nErr == COMMAND_TIMEOUT)
+        ATCS_PROBE_TIMEOUT(ATCS_CMD_MNEMONIC(nCmd), ATCS_CMD_MNEMONIC_LEN(nCmd), nLatencyNs);
+    else if(nErr == ATCS_BAD_CMD_RESPONSE)
+        ATCS_PROBE_NACK(ATCS_CMD_MNEMONIC(nCmd), ATCS_CMD_MNEMONIC_LEN(nCmd), nLatencyNs);
+    ATCS_PROBE_CMD_DONE(ATCS_CMD_MNEMONIC(nCmd), ATCS_CMD_MNEMONIC_LEN(nCmd), nLatencyNs, nErr);
+}
+#endif
+
+// setters go through here, a command identical to the last one the controller accepted is not resent.
+int ATCS::ATCSSendSetter(ATCLCommandId nCmd, const std::string &sArgs, std::string &sResp)
+{
+    int nErr;
+    std::map<ATCLCommandId, std::string>::iterator it;
+
+    // the lock only covers the shadow, the exchange itself runs without it
+    {
+        std::lock_guard<std::mutex> lock(m_SetterShadowMutex);
+        it = m_mSetterShadow.find(nCmd);
+        if(it != m_mSetterShadow.end() && it->second == sArgs) {
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 3
+            m_sLogFile << "["<<getTimeStamp()<<"]"<< " [ATCSSendSetter] " << atclMnemonic(nCmd) << sArgs << " already set, skipping." << std::endl;
+            m_sLogFile.flush();
+#endif
+            sResp.clear();
+            return PLUGIN_OK;
+        }
+        // unknown until the controller answers, a concurrent identical set is sent too
+        m_mSetterShadow.erase(nCmd);
+        if(m_nSetterInFlight[nCmd])
+            m_bSetterConflict[nCmd] = true;
+        m_nSetterInFlight[nCmd]++;
+        m_nSetterSeq[nCmd]++;
+    }
+
+    nErr = ATCSSendCommand(nCmd, sArgs, sResp);
+
+    std::lock_guard<std::mutex> lock(m_SetterShadowMutex);
+    m_nSetterInFlight[nCmd]--;
+    m_nSetterSeq[nCmd]++;
+    // on error we don't know what the controller ended up with, nor with overlapping sends
+    if(nErr || m_bSetterConflict[nCmd])
+        m_mSetterShadow.erase(nCmd);
+    else
+        m_mSetterShadow[nCmd] = sArgs;
+    if(!m_nSetterInFlight[nCmd])
+        m_bSetterConflict[nCmd] = false;
+    return nErr;
+}
+
+// taken before reading back a setter's value, see updateSetterShadow
+unsigned int ATCS::setterShadowSeq(ATCLCommandId nCmd)
+{
+    std::lock_guard<std::mutex> lock(m_SetterShadowMutex);
+    return m_nSetterSeq[nCmd];
+}
+
+// record the setter arguments matching a value read back from the controller.
+// nSeq is setterShadowSeq from before the read, if that setter was sent or invalidated since
+// (or still is on its way) the value read may already be stale and is not recorded.
+void ATCS::updateSetterShadow(ATCLCommandId nCmd, const std::string &sArgs, unsigned int nSeq)
+{
+    std::lock_guard<std::mutex> lock(m_SetterShadowMutex);
+    if(m_nSetterSeq[nCmd] != nSeq || m_nSetterInFlight[nCmd])
+        return;
+    m_mSetterShadow[nCmd] = sArgs;
+}
+
+void ATCS::invalidateSetterShadow()
+{
+    std::lock_guard<std::mutex> lock(m_SetterShadowMutex);
+    m_mSetterShadow.clear();
+    // a setter still on its way must not record its arguments afterwards
+    for(int i = 0; i < ATCL_NB_COMMANDS; i++) {
+        if(m_nSetterInFlight[i])
+            m_bSetterConflict[i] = true;
+        m_nSetterSeq[i]++;
+    }
+}
+
+void ATCS::invalidateSetterShadow(ATCLCommandId nCmd)
+{
+    std::lock_guard<std::mutex> lock(m_SetterShadowMutex);
+    m_mSetterShadow.erase(nCmd);
+    if(m_nSetterInFlight[nCmd])
+        m_bSetterConflict[nCmd] = true;
+    m_nSetterSeq[nCmd]++;
+}
+
+// read replies until we get one that isn't an async status message
+int ATCS::ATCSwaitCommandResponse(ATCLResponseView &resp, int nTimeout)
+{
+    int nErr = PLUGIN_OK;
+    bool resp_ok = false;
+
+    // read response
+    while(!resp_ok) {
+        nErr = ATCSreadResponse(resp, nTimeout);
+        if(nErr) {
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
+            if(resp.pszResp[0] == char(ATCL_NACK ))
+                m_sLogFile << "["<<getTimeStamp()<<"]"<< " [ATCSSendCommand std::string] ERROR reading response , ATCL_NACK received " << std::uppercase << std::setfill('0') << std::setw(2) << std::hex << (unsigned int)((unsigned char)resp.pszResp[0]) << std::endl;
+            else if(resp.pszResp[0] == char(ATCL_ACK ))
+                m_sLogFile << "["<<getTimeStamp()<<"]"<< " [ATCSSendCommand std::string] ERROR reading response , ATCL_ACK received " << std::uppercase << std::setfill('0') << std::setw(2) << std::hex << (unsigned int)((unsigned char)resp.pszResp[0]) << std::endl;
+            else
+                m_sLogFile << "["<<getTimeStamp()<<"]"<< " [ATCSSendCommand std::string] ERROR " << nErr<< " reading response :" << resp.pszResp << std::endl;
+            m_sLogFile.flush();
+            m_sLogFile << std::dec;
+#endif
+            return nErr;
+        }
+
+
+        // filter out async status and log them in debug mode
+        if(resp.nLen) {
+            if(resp.pszResp[0] == char(ATCL_STATUS) ||
+               resp.pszResp[0]== char(ATCL_WARNING) ||
+               resp.pszResp[0] == char(ATCL_ALERT) ||
+               resp.pszResp[0] == char(ATCL_INTERNAL_ERROR) ||
+               resp.pszResp[0] == char(ATCL_IDC_ASYNCH)
+               ) {
+                ATCS_PROBE_ASYNC_DROPPED((unsigned char)resp.pszResp[0], resp.pszResp, resp.nLen);
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
+                m_sLogFile << "["<<getTimeStamp()<<"]"<< " [ATCSSendCommand std::string] Async message :  " << (resp.pszResp + 1) << std::endl;
                 m_sLogFile.flush();
 #endif
-                ulTotalBytesRead += ulBytesRead;
-                nErr = PLUGIN_OK;
-                break;
             }
-
+            else {
+                if(resp.pszResp[0] == char(ATCL_SYNTAX_ERROR)) { // not async but we need to log it
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
+                    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [ATCSSendCommand std::string] Async message :  " << (resp.pszResp + 1) << std::endl;
+                    m_sLogFile.flush();
+#endif
+                }
+                resp_ok = true;
+            }
         }
+    } // end while(!resp_ok)
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
+    if(resp.nLen) {
+        if(resp.pszResp[0] == char(ATCL_ACK) )
+            m_sLogFile << "["<<getTimeStamp()<<"]"<< " [ATCSSendCommand std::string]  got ATCL_ACK : " << std::uppercase << std::setfill('0') << std::setw(2) << std::hex << (unsigned int)((unsigned char)resp.pszResp[0]) << std::endl;
+        else if(resp.pszResp[0] == char(ATCL_NACK) )
+            m_sLogFile << "["<<getTimeStamp()<<"]"<< " [ATCSSendCommand std::string]  got ATCL_NACK : " << std::uppercase << std::setfill('0') << std::setw(2) << std::hex << (unsigned int)((unsigned char)resp.pszResp[0]) << std::endl;
         else {
+            m_sLogFile << "["<<getTimeStamp()<<"]"<< " [ATCSSendCommand std::string]  got response : " << resp.pszResp << std::endl;
+        }
+        m_sLogFile.flush();
+        m_sLogFile << std::dec;
+    }
+#endif
+
+    return nErr;
+}
+
+
+// Hands out the next reply frame in place, see ATCLResponseView.
+// The frame stays in m_szRxPending (its ';' or trailing '%' replaced by a NUL) until the next call
+// moves whatever was received after it to the front of the buffer.
+int ATCS::ATCSreadResponse(ATCLResponseView &resp, int nTimeout)
+{
+    ATCS_SCOPED_SPAN("ATCS::ATCSreadResponse");
+    int nErr = PLUGIN_OK;
+    unsigned long ulBytesRead = 0;
+    unsigned long ulFrameLen;
+    unsigned long ulRespLen;
+    char *pszEnd;
+
+    resp.pszResp = "";
+    resp.nLen = 0;
+
+    // the previous frame is given up now
+    if(m_ulRxStart) {
+        if(m_ulRxPendingLen)
+            memmove(m_szRxPending, m_szRxPending + m_ulRxStart, m_ulRxPendingLen);
+        m_ulRxStart = 0;
+    }
+
+    // Replies can arrive back to back when several commands are sent in one write,
+    // so we only consume one frame and keep the rest for the next call.
+    while(true) {
+        ulFrameLen = 0;
+        if(m_ulRxPendingLen) {
+            if(m_szRxPending[0] == char(ATCL_ACK) || m_szRxPending[0] == char(ATCL_NACK))
+                ulFrameLen = 1;
+            else {
+                pszEnd = (char *)memchr(m_szRxPending, ';', m_ulRxPendingLen);
+                if(pszEnd)
+                    ulFrameLen = (unsigned long)(pszEnd - m_szRxPending) + 1;
+            }
+        }
+        if(ulFrameLen)
+            break;
+
+        if(m_ulRxPendingLen >= SERIAL_BUFFER_SIZE - 1) {
             nErr = ERR_RXTIMEOUT;
             break; // buffer is full.. there is a problem !!
         }
-        if(nErr) {
-#if defined PLUGIN_DEBUG
-            m_sLogFile << "["<<getTimeStamp()<<"]"<< " [readResponse std::string] readFile error : " << nErr << std::endl;
+
+        {
+            ATCS_SCOPED_SPAN("transport read");
+            nErr = m_pTransport->read(m_szRxPending + m_ulRxPendingLen, SERIAL_BUFFER_SIZE - 1 - m_ulRxPendingLen, ulBytesRead, nTimeout);
+        }
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 3
+        m_sLogFile << "["<<getTimeStamp()<<"]"<< " [readResponse std::string] ulBytesRead : " << ulBytesRead << std::endl;
+        m_sLogFile << "["<<getTimeStamp()<<"]"<< " [readResponse std::string] read nErr  : " << nErr << std::endl;
+        m_sLogFile.flush();
+#endif
+        if(nErr == ERR_RXTIMEOUT) {
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 3
+            m_sLogFile << "["<<getTimeStamp()<<"]"<< " [readResponse std::string] read timeout, no data for " << nTimeout << " ms"<< std::endl;
             m_sLogFile.flush();
 #endif
-            return nErr;
+            nErr = COMMAND_TIMEOUT;
+            break;
         }
-
-        if (ulBytesRead != nBytesWaiting) { // timeout
+        if(nErr) {
 #if defined PLUGIN_DEBUG
-            m_sLogFile << "["<<getTimeStamp()<<"]"<< " [readResponse std::string] readFile Timeout Error." << std::endl;
-            m_sLogFile << "["<<getTimeStamp()<<"]"<< " [readResponse std::string] readFile nBytesWaiting : " << nBytesWaiting << std::endl;
-            m_sLogFile << "["<<getTimeStamp()<<"]"<< " [readResponse std::string] readFile ulBytesRead   : " << ulBytesRead << std::endl;
+            m_sLogFile << "["<<getTimeStamp()<<"]"<< " [readResponse std::string] read error : " << nErr << std::endl;
             m_sLogFile.flush();
 #endif
+            m_ulRxPendingLen = 0;
+            return nErr;
         }
+        m_ulRxPendingLen += ulBytesRead;
+    }
 
-        ulTotalBytesRead += ulBytesRead;
-        pszBufPtr+=ulBytesRead;
-    }  while (ulTotalBytesRead < SERIAL_BUFFER_SIZE  && *(pszBufPtr-1) != ';');
-
+    if(!ulFrameLen) {
+        // timeout or overflow, return whatever partial answer we got (there is always room for the NUL)
+        ulRespLen = m_ulRxPendingLen;
+        while(ulRespLen && m_szRxPending[ulRespLen-1] == '%')
+            ulRespLen--;
+        m_szRxPending[ulRespLen] = 0;
+        resp.pszResp = m_szRxPending;
+        resp.nLen = ulRespLen;
+        if(!m_ulRxPendingLen)
+            nErr = COMMAND_TIMEOUT; // we didn't get an answer.. so timeout
+        m_ulRxPendingLen = 0;
+        return nErr;
+    }
 
+    ATCS_PROBE_FRAME_RECEIVED(m_szRxPending, ulFrameLen);
+    // check for  errors or single ACK
+    if(m_szRxPending[0] == char(ATCL_NACK)) {
 #if defined PLUGIN_DEBUG
-    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [readResponse std::string] ulTotalBytesRead = " << ulTotalBytesRead << std::endl;
-    m_sLogFile.flush();
+        m_sLogFile << "["<<getTimeStamp()<<"]"<< " [readResponse std::string] ATCL_NACK received." << std::endl;
+        m_sLogFile.flush();
 #endif
+        nErr = ATCS_BAD_CMD_RESPONSE;
+        resp.pszResp = s_szNackFrame;
+        resp.nLen = 1;
+    }
+    else if(m_szRxPending[0] == char(ATCL_ACK)) {
+#if defined PLUGIN_DEBUG
+        m_sLogFile << "["<<getTimeStamp()<<"]"<< " [readResponse std::string] ATCL_ACK received." << std::endl;
+        m_sLogFile.flush();
+#endif
+        resp.pszResp = s_szAckFrame;
+        resp.nLen = 1;
+    }
+    else {
+        // remove the ';' and the unit
+        ulRespLen = ulFrameLen - 1;
+        while(ulRespLen && m_szRxPending[ulRespLen-1] == '%')
+            ulRespLen--;
+        m_szRxPending[ulRespLen] = 0;
+        resp.pszResp = m_szRxPending;
+        resp.nLen = ulRespLen;
+    }
 
-    if(!ulTotalBytesRead)
-        nErr = COMMAND_TIMEOUT; // we didn't get an answer.. so timeout
-    else if(*(pszBufPtr-1) == ';')
-        *(pszBufPtr-1) = 0; //remove the ';'
-
-    sResp.assign(pszBuf);
+    m_ulRxPendingLen -= ulFrameLen;
+    m_ulRxStart = ulFrameLen;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 3
-    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [readResponse std::string] sResp : " << sResp << std::endl;
+    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [readResponse std::string] sResp : " << resp.pszResp << std::endl;
     m_sLogFile.flush();
 #endif
 
     return nErr;
 }
 
+int ATCS::purgeRx()
+{
+    m_ulRxPendingLen = 0;
+    m_ulRxStart = 0;
+    m_bRxResyncNeeded = false;
+    m_nRxLateFrames = 0;
+    m_nRxLateDueNs = 0;
+    return m_pTransport->purge();
+}
+
 
 int ATCS::atclEnter()
 {
     int nErr = PLUGIN_OK;
-    std::stringstream ssCmd;
     std::string sResp;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
@@ -394,10 +1477,12 @@ int ATCS::atclEnter()
     m_sLogFile.flush();
 #endif
 
-    ssCmd<<char(ATCL_ENTER);
-    nErr = ATCSSendCommand(ssCmd.str(), sResp);
+    nErr = ATCSSendCommand(ATCL_CMD_ENTER, sResp);
+    // no answer, don't wait a second time before Connect checks for a cancel
+    if(nErr)
+        return nErr;
 
-    nErr |= ATCSSendCommand("!QDcn;", sResp);
+    nErr = ATCSSendCommand(ATCL_CMD_QDCN, sResp);
 
     return nErr;
 }
@@ -413,12 +1498,20 @@ int ATCS::getFirmwareVersion(std::string &sFirmware)
     if(!m_bIsConnected)
         return NOT_CONNECTED;
 
+    // the setup fills m_sFirmwareVersion, a setup error doesn't stop us from asking
+    waitConnectDone();
+    // read once per connection (or taken from the snapshot)
+    if(!m_sFirmwareVersion.empty()) {
+        sFirmware.assign(m_sFirmwareVersion);
+        return nErr;
+    }
+
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [getFirmwareVersion] called." << std::endl;
     m_sLogFile.flush();
 #endif
 
-    nErr = ATCSSendCommand("!HGfv;", sResp);
+    nErr = ATCSSendCommand(ATCL_CMD_HGFV, sResp);
 
     if(nErr)
         return nErr;
@@ -436,12 +1529,19 @@ int ATCS::getModel(std::string &sModel)
     if(!m_bIsConnected)
         return NOT_CONNECTED;
 
+    // same as getFirmwareVersion
+    waitConnectDone();
+    if(!m_sHardwareModel.empty()) {
+        sModel.assign(m_sHardwareModel);
+        return nErr;
+    }
+
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [getModel] called." << std::endl;
     m_sLogFile.flush();
 #endif
 
-    nErr = ATCSSendCommand("!HGsm;", sResp);
+    nErr = ATCSSendCommand(ATCL_CMD_HGSM, sResp);
     if(nErr)
         return nErr;
 
@@ -468,10 +1568,10 @@ MountTypeInterface::Type ATCS::mountType()
 }
 
 
-int ATCS::getRaAndDec(double &dRa, double &dDec)
+int ATCS::getRaAndDec(double &dRa, double &dDec, int nMaxAgeMs)
 {
     int nErr = PLUGIN_OK;
-    std::string sResp;
+    bool bNotAvailable;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [getRaAndDec] called." << std::endl;
@@ -479,18 +1579,13 @@ int ATCS::getRaAndDec(double &dRa, double &dDec)
 #endif
 
     // get RA
-    nErr = ATCSSendCommand("!CGra;", sResp);
+    nErr = pollRead(ATCL_CMD_CGRA, parseSexagesimalInto(dRa, bNotAvailable), nMaxAgeMs);
     if(nErr) {
         return nErr;
     }
 
-#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
-    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [getRaAndDec]  sResp : " << sResp << std::endl;
-    m_sLogFile.flush();
-#endif
-
     // if not aligned we have no coordinates.
-    if(sResp.find("N/A") != -1) {
+    if(bNotAvailable) {
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
         m_sLogFile << "["<<getTimeStamp()<<"]"<< " [getRaAndDec]  Not aligned yet." << std::endl;
         m_sLogFile.flush();
@@ -500,16 +1595,12 @@ int ATCS::getRaAndDec(double &dRa, double &dDec)
         return nErr;
     }
 
-    nErr = convertHHMMSStToRa(sResp, dRa);
-    if(nErr)
-        return nErr;
-
     // get DEC
-    nErr = ATCSSendCommand("!CGde;", sResp);
+    nErr = pollRead(ATCL_CMD_CGDE, parseSexagesimalInto(dDec, bNotAvailable), nMaxAgeMs);
     if(nErr)
         return nErr;
     // even if RA was ok, we need to test Dec as we might have reach park between the 2 calls
-    if(sResp.find("N/A") != -1) {
+    if(bNotAvailable) {
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
         m_sLogFile << "["<<getTimeStamp()<<"]"<< " [getRaAndDec]  Not aligned yet." << std::endl;
         m_sLogFile.flush();
@@ -517,7 +1608,6 @@ int ATCS::getRaAndDec(double &dRa, double &dDec)
         dDec = 0.0f;
         return nErr;
     }
-    nErr = convertDDMMSSToDecDeg(sResp, dDec);
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [getRaAndDec] dRa  : " << dRa << std::endl;
@@ -525,6 +1615,8 @@ int ATCS::getRaAndDec(double &dRa, double &dDec)
     m_sLogFile.flush();
 #endif
 
+    pierSidePositionRead(dRa);
+
     return nErr;
 }
 
@@ -532,8 +1624,6 @@ int ATCS::setTarget(double dRa, double dDec)
 {
     int nErr;
 
-    std::stringstream ssTmp;
-    std::string sCmd;
     std::string sResp;
     std::string sTemp;
     char cSign;
@@ -552,8 +1642,7 @@ int ATCS::setTarget(double dRa, double dDec)
     m_sLogFile.flush();
 #endif
     // set target Ra
-    sCmd = "!CStr" + sTemp + ";";
-    nErr = ATCSSendCommand(sCmd, sResp);
+    nErr = ATCSSendCommand(ATCL_CMD_CSTR, sTemp, sResp);
 
     convertDecDegToDDMMSS(dDec, sTemp, cSign);
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
@@ -562,8 +1651,7 @@ int ATCS::setTarget(double dRa, double dDec)
 #endif
     // set target dec
 
-    ssTmp << "!CStd" << cSign << sTemp << ";";
-    nErr = ATCSSendCommand(ssTmp.str(), sResp);
+    nErr = ATCSSendCommand(ATCL_CMD_CSTD, cSign + sTemp, sResp);
 
     return nErr;
 }
@@ -572,7 +1660,7 @@ int ATCS::setTarget(double dRa, double dDec)
 int ATCS::syncTo(double dRa, double dDec)
 {
     int nErr = PLUGIN_OK;
-    bool bAligned;
+    bool bAligned = false;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [syncTo]  Ra  : " << std::fixed << std::setprecision(12) << dRa << std::endl;
@@ -580,38 +1668,21 @@ int ATCS::syncTo(double dRa, double dDec)
     m_sLogFile.flush();
 #endif
 
-    nErr = isAligned(bAligned);
-    if(nErr) {
-#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
-        m_sLogFile << "["<<getTimeStamp()<<"]"<< " [syncTo] isAligned nErr = " << nErr << std::endl;
-        m_sLogFile.flush();
-#endif
-        return nErr;
-    }
-    // set sync target coordinate
-    nErr = setTarget(dRa, dDec);
-    if(nErr) {
-#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
-        m_sLogFile << "["<<getTimeStamp()<<"]"<< " [syncTo] setTarget nErr = " << nErr << std::endl;
-        m_sLogFile.flush();
-#endif
+    nErr = waitConnectDone();
+    if(nErr)
         return nErr;
-    }
-    // Sync
-    if(!bAligned){
-        nErr = alignFromTargetRA_DecCalcSideEpochNow();
-#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
-        m_sLogFile << "["<<getTimeStamp()<<"]"<< " [syncTo] alignFromTargetRA_DecCalcSideEpochNow nErr = " << nErr << std::endl;
-        m_sLogFile.flush();
-#endif
-    }
-    else {
-        nErr = calFromTargetRA_DecEpochNow();
-#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
-        m_sLogFile << "["<<getTimeStamp()<<"]"<< " [syncTo] calFromTargetRA_DecEpochNow nErr = " << nErr << std::endl;
-        m_sLogFile.flush();
-#endif
-    }
+
+    std::lock_guard<std::mutex> targetLock(m_TargetMutex);
+    std::vector<ATCSStep> steps = {
+        {"isAligned", [&] { return isAligned(bAligned); }},
+        // set sync target coordinate
+        {"setTarget", [&] { return setTarget(dRa, dDec); }},
+        // Sync, first sync aligns the mount, the next ones refine the calibration
+        {"sync", [&] { return bAligned ? calFromTargetRA_DecEpochNow() : alignFromTargetRA_DecCalcSideEpochNow(); }}
+    };
+    nErr = runSteps("syncTo", steps);
+    if(!nErr)
+        pierSideTargetSet(dRa);
     return nErr;
 }
 
@@ -625,7 +1696,7 @@ int ATCS::calFromTargetRA_DecEpochNow()
     m_sLogFile.flush();
 #endif
 
-    nErr = ATCSSendCommand("!ACrn;", sResp);
+    nErr = ATCSSendCommand(ATCL_CMD_ACRN, sResp);
     return nErr;
 }
 
@@ -639,7 +1710,7 @@ int ATCS::calFromTargetRA_Dec()
     m_sLogFile.flush();
 #endif
 
-    nErr = ATCSSendCommand("!ACrd;", sResp);
+    nErr = ATCSSendCommand(ATCL_CMD_ACRD, sResp);
     return nErr;
 }
 
@@ -647,27 +1718,17 @@ int ATCS::calFromTargetRA_Dec()
 int ATCS::isAligned(bool &bAligned)
 {
     int nErr = PLUGIN_OK;
-    std::string sResp;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [isAligned] called." << std::endl;
     m_sLogFile.flush();
 #endif
 
-    nErr = ATCSSendCommand("!AGas;", sResp);
-    if(nErr)
-        return nErr;
-    if(sResp.find("NotAligned") != -1) {
-        bAligned = false;
-    }
-    else if(sResp.find("Preliminary") != -1) {
-        bAligned = false;
-    }
-    else if(sResp.find("Complete") != -1) {
-        bAligned = true;
-    }
-    else
-        bAligned = false;
+    nErr = pollRead(ATCL_CMD_AGAS, [&bAligned](const ATCLResponseView &resp) -> int {
+        // "NotAligned", "Preliminary" or "Complete"
+        bAligned = (strstr(resp.pszResp, "Complete") != NULL);
+        return PLUGIN_OK;
+    });
 
     return nErr;
 }
@@ -676,24 +1737,26 @@ int ATCS::getAlignementType(std::string &sType)
 {
     int nErr = PLUGIN_OK;
     std::string sResp;
+    unsigned int nSeq;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [getAlignementType] called." << std::endl;
     m_sLogFile.flush();
 #endif
 
-    nErr = ATCSSendCommand("!NGat;", sResp);
+    nSeq = setterShadowSeq(ATCL_CMD_NSAT);
+    nErr = ATCSSendCommand(ATCL_CMD_NGAT, sResp);
     if(nErr)
         return nErr;
 
     sType.assign(sResp);
+    updateSetterShadow(ATCL_CMD_NSAT, sResp, nSeq);
     return nErr;
 }
 
 int ATCS::setAlignementType(std::string sType)
 {
     int nErr = PLUGIN_OK;
-    std::string sCmd;
     std::string sResp;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
@@ -701,8 +1764,7 @@ int ATCS::setAlignementType(std::string sType)
     m_sLogFile.flush();
 #endif
 
-    sCmd = "!NSat" + sType + ";";
-    nErr = ATCSSendCommand(sCmd, sResp);
+    nErr = ATCSSendSetter(ATCL_CMD_NSAT, sType, sResp);
     return nErr;
 }
 
@@ -710,7 +1772,6 @@ int ATCS::setAlignementType(std::string sType)
 int ATCS::setMeridianAvoidMethod(std::string sType)
 {
     int nErr = PLUGIN_OK;
-    std::string sCmd;
     std::string sResp;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
@@ -718,8 +1779,11 @@ int ATCS::setMeridianAvoidMethod(std::string sType)
     m_sLogFile.flush();
 #endif
 
-    sCmd = "!NSam" + sType + ";";
-    nErr = ATCSSendCommand(sCmd, sResp);
+    nErr = ATCSSendSetter(ATCL_CMD_NSAM, sType, sResp);
+    if(!nErr) {
+        std::lock_guard<std::mutex> lock(m_PierSideMutex);
+        m_PierSide.setAvoidMethod(sType);
+    }
 
     return nErr;
 }
@@ -728,17 +1792,24 @@ int ATCS::getMeridianAvoidMethod(std::string &sType)
 {
     int nErr = PLUGIN_OK;
     std::string sResp;
+    unsigned int nSeq;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [getMeridianAvoidMethod] called." << std::endl;
     m_sLogFile.flush();
 #endif
 
-    nErr = ATCSSendCommand("!NGam;", sResp);
+    nSeq = setterShadowSeq(ATCL_CMD_NSAM);
+    nErr = ATCSSendCommand(ATCL_CMD_NGAM, sResp);
     if(nErr)
         return nErr;
 
     sType.assign(sResp);
+    updateSetterShadow(ATCL_CMD_NSAM, sResp, nSeq);
+    {
+        std::lock_guard<std::mutex> lock(m_PierSideMutex);
+        m_PierSide.setAvoidMethod(sResp);
+    }
     return nErr;
 }
 
@@ -754,12 +1825,20 @@ int ATCS::setTrackingRates(bool bTrackingOn, bool bIgnoreRates, double dTrackRaA
     m_sLogFile.flush();
 #endif
 
+    nErr = waitConnectDone();
+    if(nErr)
+        return nErr;
+
+    // explicit rates replace whatever the non-sidereal or satellite engine was doing
+    stopNonSiderealTracking();
+    stopSatelliteTracking();
+
     if(!bTrackingOn) { // stop tracking
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
         m_sLogFile << "["<<getTimeStamp()<<"]"<< " [setTrackingRates] setting to Drift." << std::endl;
         m_sLogFile.flush();
 #endif
-        nErr = ATCSSendCommand("!RStrDrift;", sResp);
+        nErr = ATCSSendSetter(ATCL_CMD_RSTR, "Drift", sResp);
 
     }
     else if(bTrackingOn && bIgnoreRates) { // sidereal
@@ -767,7 +1846,7 @@ int ATCS::setTrackingRates(bool bTrackingOn, bool bIgnoreRates, double dTrackRaA
         m_sLogFile << "["<<getTimeStamp()<<"]"<< " [setTrackingRates] setting to Sidereal." << std::endl;
         m_sLogFile.flush();
 #endif
-        nErr = ATCSSendCommand("!RStrSidereal;", sResp);
+        nErr = ATCSSendSetter(ATCL_CMD_RSTR, "Sidereal", sResp);
     }
     else { // custom rate
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
@@ -781,7 +1860,7 @@ int ATCS::setTrackingRates(bool bTrackingOn, bool bIgnoreRates, double dTrackRaA
         if(nErr) {
             return nErr; // if we cant set the rate no need to switch to custom.
         }
-        nErr = ATCSSendCommand("!RStrCustom;", sResp);
+        nErr = ATCSSendSetter(ATCL_CMD_RSTR, "Custom", sResp);
     }
     return nErr;
 }
@@ -790,17 +1869,24 @@ int ATCS::getTrackRates(bool &bTrackingOn, double &dTrackRaArcSecPerHr, double &
 {
     int nErr = PLUGIN_OK;
     std::string sResp;
+    unsigned int nSeq;
+    bool bFromLink;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [getTrackRates] called." << std::endl;
     m_sLogFile.flush();
 #endif
 
-    nErr = ATCSSendCommand("!RGtr;", sResp);
+    nSeq = setterShadowSeq(ATCL_CMD_RSTR);
+    nErr = pollRead(ATCL_CMD_RGTR, sResp, POLL_AGE_DEFAULT, &bFromLink);
     bTrackingOn = true;
     if(sResp.find("Drift") != -1) {
         bTrackingOn = false;
     }
+    // keep the shadow in sync with what the controller really does (hand paddle, park, ...),
+    // a cached reply may predate a change made since
+    if(!nErr && bFromLink)
+        updateSetterShadow(ATCL_CMD_RSTR, sResp, nSeq);
     nErr = getCustomTRateOffsetRA(dTrackRaArcSecPerHr);
     nErr |= getCustomTRateOffsetDec(dTrackDecArcSecPerHr);
 
@@ -811,15 +1897,13 @@ int ATCS::setCustomTRateOffsetRA(double dRa)
 {
     int nErr;
     std::string sResp;
-    std::stringstream ssTmp;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [setCustomTRateOffsetRA] called." << std::endl;
     m_sLogFile.flush();
 #endif
 
-    ssTmp << "!RSor" << std::fixed << std::setprecision(2) << dRa << ";";
-    nErr = ATCSSendCommand(ssTmp.str(), sResp);
+    nErr = ATCSSendSetter(ATCL_CMD_RSOR, atclNumber(dRa, 2), sResp);
     if(nErr) {
 #if defined PLUGIN_DEBUG
         m_sLogFile << "["<<getTimeStamp()<<"]"<< " [setCustomTRateOffsetRA] Error setting Ra tracking rate to " << std::fixed << std::setprecision(12) <<  dRa << std::endl;
@@ -833,15 +1917,13 @@ int ATCS::setCustomTRateOffsetDec(double dDec)
 {
     int nErr;
     std::string sResp;
-    std::stringstream ssTmp;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [setCustomTRateOffsetDec] called." << std::endl;
     m_sLogFile.flush();
 #endif
 
-    ssTmp << "!RSod" << std::fixed << std::setprecision(2) << dDec << ";";
-    nErr = ATCSSendCommand(ssTmp.str(), sResp);
+    nErr = ATCSSendSetter(ATCL_CMD_RSOD, atclNumber(dDec, 2), sResp);
     if(nErr) {
 #if defined PLUGIN_DEBUG
         m_sLogFile << "["<<getTimeStamp()<<"]"<< " [setCustomTRateOffsetDec] Error setting Dec tracking rate to " << std::fixed << std::setprecision(12) <<  dDec << std::endl;
@@ -854,17 +1936,21 @@ int ATCS::setCustomTRateOffsetDec(double dDec)
 int ATCS::getCustomTRateOffsetRA(double &dTrackRaArcSecPerHr)
 {
     int nErr;
-    std::string sResp;
+    unsigned int nSeq;
+    bool bFromLink;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [getCustomTRateOffsetRA] called." << std::endl;
     m_sLogFile.flush();
 #endif
 
-    nErr = ATCSSendCommand("!RGor;", sResp);
+    nSeq = setterShadowSeq(ATCL_CMD_RSOR);
+    nErr = pollRead(ATCL_CMD_RGOR, parseNumberInto(dTrackRaArcSecPerHr), POLL_AGE_DEFAULT, &bFromLink);
     if(nErr)
         return nErr;
-    dTrackRaArcSecPerHr = std::stof(sResp);
+
+    if(bFromLink)
+        updateSetterShadow(ATCL_CMD_RSOR, atclNumber(dTrackRaArcSecPerHr, 2), nSeq);
 
     return nErr;
 }
@@ -872,201 +1958,916 @@ int ATCS::getCustomTRateOffsetRA(double &dTrackRaArcSecPerHr)
 int ATCS::getCustomTRateOffsetDec(double &dTrackDecArcSecPerHr)
 {
     int nErr;
-    std::string sResp;
+    unsigned int nSeq;
+    bool bFromLink;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [getCustomTRateOffsetDec] called." << std::endl;
     m_sLogFile.flush();
 #endif
 
-    nErr = ATCSSendCommand("!RGod;", sResp);
+    nSeq = setterShadowSeq(ATCL_CMD_RSOD);
+    nErr = pollRead(ATCL_CMD_RGOD, parseNumberInto(dTrackDecArcSecPerHr), POLL_AGE_DEFAULT, &bFromLink);
+    if(nErr)
+        return nErr;
+
+    if(bFromLink)
+        updateSetterShadow(ATCL_CMD_RSOD, atclNumber(dTrackDecArcSecPerHr, 2), nSeq);
+
+    return nErr;
+}
+
+#pragma mark - Limis
+int ATCS::getLimits(double &dHoursEast, double &dHoursWest)
+{
+    int nErr = PLUGIN_OK;
+    double dEastAngle;
+    double dWestAngle;
+
+    {
+        std::lock_guard<std::mutex> lock(m_PierSideMutex);
+        if(m_PierSide.limitsKnown()) {
+            m_PierSide.limitHours(dHoursEast, dHoursWest);
+            return nErr;
+        }
+    }
+
+    nErr = getSoftLimitEastAngle(dEastAngle);
+    if(nErr)
+        return nErr;
+
+    nErr = getSoftLimitWestAngle(dWestAngle);
     if(nErr)
         return nErr;
-    dTrackDecArcSecPerHr = std::stof(sResp);
 
+    std::lock_guard<std::mutex> lock(m_PierSideMutex);
+    setLimitAnglesLocked(dEastAngle, dWestAngle);
+    m_PierSide.limitHours(dHoursEast, dHoursWest);
     return nErr;
 }
 
-#pragma mark - Limis
-int ATCS::getLimits(double &dHoursEast, double &dHoursWest)
+// m_PierSideMutex held, the slew checks use the same limits as the pier side model
+void ATCS::setLimitAnglesLocked(double dEastAngle, double dWestAngle)
+{
+    double dHoursEast, dHoursWest;
+
+    m_PierSide.setLimitAngles(dEastAngle, dWestAngle);
+    m_PierSide.limitHours(dHoursEast, dHoursWest);
+    m_SlewLimits.setLimits(dHoursEast, dHoursWest);
+}
+
+// Refuse a target the controller would refuse anyway (or that is below the horizon mask), before anything is sent.
+int ATCS::checkSlewTarget(double dRa, double dDec)
+{
+    SlewCheck nCheck;
+    SlewSide nSide = SLEW_SIDE_ANY;
+    double dHourAngle = localHourAngle(dRa);
+
+    {
+        std::lock_guard<std::mutex> lock(m_PierSideMutex);
+        if(m_PierSide.gemFlip())
+            nSide = m_PierSide.beyondThePoleFor(dHourAngle) ? SLEW_SIDE_BEYOND_POLE : SLEW_SIDE_NORMAL;
+        nCheck = m_SlewLimits.check(dHourAngle, dDec, nSide);
+    }
+    if(nCheck == SLEW_OK)
+        return PLUGIN_OK;
+
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
+    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [checkSlewTarget] target at HA " << dHourAngle << " Dec " << dDec << (nCheck == SLEW_BELOW_HORIZON ? " is below the horizon" : nCheck == SLEW_PAST_EAST_LIMIT ? " is past the east limit" : " is past the west limit") << std::endl;
+    m_sLogFile.flush();
+#endif
+    return ERR_LIMITSEXCEEDED;
+}
+
+int ATCS::loadHorizonMask(const std::string &sPath)
+{
+    std::lock_guard<std::mutex> lock(m_PierSideMutex);
+
+    if(sPath.empty()) {
+        m_SlewLimits.clearHorizon();
+        return PLUGIN_OK;
+    }
+    if(!m_SlewLimits.loadHorizon(sPath)) {
+        m_SlewLimits.clearHorizon();
+        return ATCS_ERROR;
+    }
+    return PLUGIN_OK;
+}
+
+// local model, no serial traffic
+int ATCS::getBeyondThePole(bool &bBeyondThePole)
+{
+    if(!m_bIsConnected)
+        return NOT_CONNECTED;
+
+    std::lock_guard<std::mutex> lock(m_PierSideMutex);
+    bBeyondThePole = m_PierSide.beyondThePole();
+    return PLUGIN_OK;
+}
+
+double ATCS::getFlipHourAngle()
+{
+    std::lock_guard<std::mutex> lock(m_PierSideMutex);
+    return m_PierSide.flipHourAngle();
+}
+
+void ATCS::pierSideTargetSet(double dRa)
+{
+    double dHourAngle = localHourAngle(dRa);
+
+    std::lock_guard<std::mutex> lock(m_PierSideMutex);
+    m_PierSide.targetSet(dHourAngle);
+}
+
+// from every position read : the side if we lost it, and now and then the controller settings the model is built on
+void ATCS::pierSidePositionRead(double dRa)
+{
+    bool bRefresh;
+    double dHourAngle = localHourAngle(dRa);
+
+    {
+        std::lock_guard<std::mutex> lock(m_PierSideMutex);
+        m_PierSide.positionRead(dHourAngle);
+        bRefresh = std::chrono::steady_clock::now() - m_tPierSideRead > std::chrono::milliseconds(PIER_SIDE_REFRESH_MS);
+        if(bRefresh)
+            m_tPierSideRead = std::chrono::steady_clock::now();
+    }
+    if(bRefresh)
+        refreshPierSideModel();
+}
+
+int ATCS::refreshPierSideModel()
+{
+    int nErr;
+    double dEastAngle;
+    double dWestAngle;
+    unsigned int nSeq;
+    static const std::vector<ATCLRequest> vCmds = {
+        {ATCL_CMD_NGAM, ""},
+        {ATCL_CMD_NGLE, ""},
+        {ATCL_CMD_NGLW, ""}
+    };
+    std::vector<std::string> svResp;
+
+    nSeq = setterShadowSeq(ATCL_CMD_NSAM);
+    nErr = ATCSSendCommands(vCmds, svResp);
+    if(nErr || svResp.size() != vCmds.size())
+        return nErr ? nErr : ERR_CMDFAILED;
+    if(!atclParseNumber(svResp[1].c_str(), dEastAngle) || !atclParseNumber(svResp[2].c_str(), dWestAngle))
+        return ERR_PARSE;
+
+    updateSetterShadow(ATCL_CMD_NSAM, svResp[0], nSeq);
+    std::lock_guard<std::mutex> lock(m_PierSideMutex);
+    m_PierSide.setAvoidMethod(svResp[0]);
+    setLimitAnglesLocked(dEastAngle, dWestAngle);
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
+    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [refreshPierSideModel] " << svResp[0] << " limits " << dEastAngle << " / " << dWestAngle << (m_PierSide.beyondThePole() ? ", beyond the pole" : "") << std::endl;
+    m_sLogFile.flush();
+#endif
+    return PLUGIN_OK;
+}
+
+// local sidereal time once we have the site longitude, TheSkyX until then
+double ATCS::localHourAngle(double dRa)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_SiderealMutex);
+        if(m_SiderealClock.hasLongitude())
+            return m_SiderealClock.hourAngle(dRa, unixTimeNow());
+    }
+    if(!m_pTsx)
+        return 0.0;
+    return m_pTsx->hourAngle(dRa);
+}
+
+int ATCS::getLocalSiderealTime(double &dLst)
+{
+    std::lock_guard<std::mutex> lock(m_SiderealMutex);
+    if(!m_SiderealClock.hasLongitude())
+        return ATCS_ERROR;
+    dLst = m_SiderealClock.localSiderealTime(unixTimeNow());
+    return PLUGIN_OK;
+}
+
+int ATCS::getHourAngles(const double *pdRa, double *pdHourAngle, size_t nTargets)
+{
+    std::lock_guard<std::mutex> lock(m_SiderealMutex);
+    if(!m_SiderealClock.hasLongitude())
+        return ATCS_ERROR;
+    m_SiderealClock.hourAngles(pdRa, pdHourAngle, nTargets, unixTimeNow());
+    return PLUGIN_OK;
+}
+
+int ATCS::getSoftLimitEastAngle(double &dAngle)
+{
+    int nErr;
+
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
+    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [getSoftLimitEastAngle] called." << std::endl;
+    m_sLogFile.flush();
+#endif
+
+    nErr = ATCSSendCommand(ATCL_CMD_NGLE, parseNumberInto(dAngle));
+
+    return nErr;
+}
+
+int ATCS::getSoftLimitWestAngle(double &dAngle)
+{
+    int nErr;
+
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
+    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [getSoftLimitWestAngle] called." << std::endl;
+    m_sLogFile.flush();
+#endif
+
+    nErr = ATCSSendCommand(ATCL_CMD_NGLW, parseNumberInto(dAngle));
+
+    return nErr;
+}
+
+#pragma mark - Slew
+
+int ATCS::startSlewTo(double dRa, double dDec)
+{
+    int nErr = PLUGIN_OK;
+
+    nErr = waitConnectDone();
+    if(nErr)
+        return nErr;
+
+    std::lock_guard<std::mutex> targetLock(m_TargetMutex);
+    return slewToLocked(dRa, dDec);
+}
+
+// m_TargetMutex held
+int ATCS::slewToLocked(double dRa, double dDec)
+{
+    int nErr = PLUGIN_OK;
+    bool bAligned;
+
+    nErr = checkSlewTarget(dRa, dDec);
+    if(nErr)
+        return nErr;
+
+    // new target, the rates we were following don't apply to it
+    stopNonSiderealTrackingLocked();
+    stopSatelliteTrackingLocked();
+
+    std::vector<ATCSStep> steps = {
+        {"isAligned", [&] { return isAligned(bAligned); }},
+        {"setTarget", [&] { return setTarget(dRa, dDec); }},
+        {"slew", [&] { return slewTargetRA_DecEpochNow(); }}
+    };
+    nErr = runSteps("startSlewTo", steps);
+    if(!nErr)
+        pierSideTargetSet(dRa);
+    return nErr;
+}
+
+int ATCS::slewTargetRA_DecEpochNow()
+{
+    int nErr;
+    std::string sResp;
+
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
+    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [slewTargetRA_DecEpochNow] called." << std::endl;
+    m_sLogFile.flush();
+#endif
+
+    nErr = ATCSSendCommand(ATCL_CMD_GTRN, sResp);
+    m_nSlewStartNs = CSteadyTimer::NowNs();
+    return nErr;
+
+}
+
+int ATCS::startOpenSlew(const MountDriverInterface::MoveDir Dir, unsigned int nRate)
+{
+    int nErr = PLUGIN_OK;
+    int nAxis;
+    std::vector<ATCLRequest> vCmds;
+    std::vector<std::string> svResp;
+
+    // a timed move still pending must not stop this one
+    cancelTimedMove();
+
+    std::lock_guard<std::mutex> lock(m_OpenLoopMutex);
+
+    nAxis = (Dir == MountDriverInterface::MD_NORTH || Dir == MountDriverInterface::MD_SOUTH) ? OL_AXIS_DEC : OL_AXIS_RA;
+
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
+    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [startOpenSlew] setting Dir to " << Dir << std::endl;
+    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [startOpenSlew] setting rate to " << nRate << " (current rate " << m_nOpenLoopRate << ")" << std::endl;
+    m_sLogFile.flush();
+#endif
+
+    // only select the rate if it changed
+    if((int)nRate != m_nOpenLoopRate) {
+        if(nRate == 4) { // "Slew"
+            vCmds.push_back({ATCL_CMD_KSSL, ""});
+        }
+        else {
+            // clear slew
+            vCmds.push_back({ATCL_CMD_KCSL, ""});
+            // select rate
+            // KScv + 1,2 3 or 4 for ViewVel 1,2,3,4, 'ViewVel 1' is index 0 so nRate+1
+            vCmds.push_back({ATCL_CMD_KSCV, std::to_string(nRate+1)});
+        }
+    }
+    else if(m_nOpenLoopAxisDir[nAxis] == Dir) {
+        return PLUGIN_OK; // already moving that way at that rate
+    }
+
+    // figure out direction
+    switch(Dir){
+        case MountDriverInterface::MD_NORTH:
+            vCmds.push_back({ATCL_CMD_KSPU, "100"});
+            break;
+        case MountDriverInterface::MD_SOUTH:
+            vCmds.push_back({ATCL_CMD_KSPD, "100"});
+            break;
+        case MountDriverInterface::MD_EAST:
+            vCmds.push_back({ATCL_CMD_KSPL, "100"});
+            break;
+        case MountDriverInterface::MD_WEST:
+            vCmds.push_back({ATCL_CMD_KSSR, "100"});
+            break;
+    }
+
+    nErr = ATCSSendCommands(vCmds, svResp);
+    if(nErr) {
+        // we don't know what the controller took, resend everything next time
+        m_nOpenLoopRate = OL_RATE_UNKNOWN;
+    }
+    else
+        m_nOpenLoopRate = (int)nRate;
+    // even on error the axis might be moving, make sure the stop covers it
+    m_nOpenLoopAxisDir[nAxis] = Dir;
+
+    return nErr;
+}
+
+int ATCS::stopOpenLoopMove()
+{
+    cancelTimedMove();
+
+    std::lock_guard<std::mutex> lock(m_OpenLoopMutex);
+
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
+    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [stopOpenLoopMove] RA dir was " << m_nOpenLoopAxisDir[OL_AXIS_RA] << " , Dec dir was " << m_nOpenLoopAxisDir[OL_AXIS_DEC] << std::endl;
+    m_sLogFile.flush();
+#endif
+
+    return sendOpenLoopStop();
+}
+
+// m_OpenLoopMutex must be held
+int ATCS::sendOpenLoopStop()
+{
+    int nErr = PLUGIN_OK;
+    std::vector<ATCLRequest> vCmds;
+    std::vector<std::string> svResp;
+
+    if(m_nOpenLoopAxisDir[OL_AXIS_DEC] != OL_AXIS_IDLE)
+        vCmds.push_back({ATCL_CMD_XXUD, ""});
+    if(m_nOpenLoopAxisDir[OL_AXIS_RA] != OL_AXIS_IDLE)
+        vCmds.push_back({ATCL_CMD_XXLR, ""});
+    if(vCmds.empty()) {
+        // we lost track of what is moving, stop both to be safe
+        vCmds.push_back({ATCL_CMD_XXUD, ""});
+        vCmds.push_back({ATCL_CMD_XXLR, ""});
+    }
+
+    // both axis are stopped with a single write so a diagonal move stops cleanly
+    nErr = ATCSSendCommands(vCmds, svResp);
+    if(!nErr) {
+        m_nOpenLoopAxisDir[OL_AXIS_RA] = OL_AXIS_IDLE;
+        m_nOpenLoopAxisDir[OL_AXIS_DEC] = OL_AXIS_IDLE;
+    }
+
+    return nErr;
+}
+
+void ATCS::resetOpenLoopState()
+{
+    std::lock_guard<std::mutex> lock(m_OpenLoopMutex);
+    m_nOpenLoopAxisDir[OL_AXIS_RA] = OL_AXIS_IDLE;
+    m_nOpenLoopAxisDir[OL_AXIS_DEC] = OL_AXIS_IDLE;
+    m_nOpenLoopRate = OL_RATE_UNKNOWN;
+}
+
+// Start an open loop move and stop it nDurationMs later.
+// The stop is sent by our own thread waiting on a steady_clock deadline so the move length
+// doesn't depend on when TheSkyX gets around to calling endOpenLoopMove.
+int ATCS::startTimedOpenLoopMove(const MountDriverInterface::MoveDir Dir, unsigned int nRate, int nDurationMs)
+{
+    int nErr = PLUGIN_OK;
+    std::chrono::steady_clock::time_point start;
+
+    if(!m_bIsConnected)
+        return NOT_CONNECTED;
+
+    if(nDurationMs <= 0)
+        return PLUGIN_OK;
+
+    nErr = startOpenSlew(Dir, nRate);
+    if(nErr)
+        return nErr;
+    // the mount starts moving when the last start command is acknowledged
+    start = std::chrono::steady_clock::now();
+
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
+    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [startTimedOpenLoopMove] moving for " << nDurationMs << " ms" << std::endl;
+    m_sLogFile.flush();
+#endif
+
+    std::lock_guard<std::mutex> lock(m_TimedMoveMutex);
+    if(!m_bTimedMoveThreadRunning) {
+        m_bTimedMoveThreadRunning = true;
+        m_TimedMoveThread = std::thread(&ATCS::timedMoveThread, this);
+    }
+    m_TimedMoveDeadline = start + std::chrono::milliseconds(nDurationMs);
+    m_bTimedMovePending = true;
+    m_nTimedMoveId++;
+    m_cvTimedMove.notify_one();
+
+    return nErr;
+}
+
+bool ATCS::isTimedMoveActive()
+{
+    std::lock_guard<std::mutex> lock(m_TimedMoveMutex);
+    return m_bTimedMovePending;
+}
+
+void ATCS::getTimedMoveStats(TimedMoveStats &stats)
+{
+    std::lock_guard<std::mutex> lock(m_TimedMoveMutex);
+    stats = m_TimedMoveStats;
+}
+
+void ATCS::cancelTimedMove()
+{
+    std::lock_guard<std::mutex> lock(m_TimedMoveMutex);
+    // bumped even with nothing pending, a stop already past its deadline checks it
+    m_nTimedMoveId++;
+    if(!m_bTimedMovePending)
+        return;
+    m_bTimedMovePending = false;
+    m_cvTimedMove.notify_one();
+}
+
+// Stop sent by timedMoveThread, unless a move was started or stopped since the deadline.
+int ATCS::stopTimedOpenLoopMove(unsigned int nId, bool &bStopped)
+{
+    std::lock_guard<std::mutex> lock(m_OpenLoopMutex);
+
+    bStopped = false;
+    {
+        std::lock_guard<std::mutex> timedLock(m_TimedMoveMutex);
+        if(m_nTimedMoveId != nId)
+            return PLUGIN_OK;
+    }
+    bStopped = true;
+    return sendOpenLoopStop();
+}
+
+void ATCS::stopTimedMoveThread()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_TimedMoveMutex);
+        m_bTimedMoveThreadRunning = false;
+        m_bTimedMovePending = false;
+        m_cvTimedMove.notify_one();
+    }
+    if(m_TimedMoveThread.joinable())
+        m_TimedMoveThread.join();
+}
+
+void ATCS::timedMoveThread()
+{
+    int nErr;
+    unsigned int nId;
+    long long llError;
+    bool bStopped;
+    std::chrono::steady_clock::time_point deadline;
+    std::unique_lock<std::mutex> lock(m_TimedMoveMutex);
+
+    while(m_bTimedMoveThreadRunning) {
+        if(!m_bTimedMovePending) {
+            m_cvTimedMove.wait(lock);
+            continue;
+        }
+        nId = m_nTimedMoveId;
+        deadline = m_TimedMoveDeadline;
+        // woken up early if the move is cancelled, replaced or we're shutting down
+        if(m_cvTimedMove.wait_until(lock, deadline, [this, nId]{ return m_nTimedMoveId != nId || !m_bTimedMoveThreadRunning; }))
+            continue;
+
+        m_bTimedMovePending = false;
+        lock.unlock();
+        llError = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - deadline).count();
+        nErr = stopTimedOpenLoopMove(nId, bStopped);
+        lock.lock();
+        if(!bStopped)
+            continue;
+
+        m_TimedMoveStats.ulMoves++;
+        m_TimedMoveStats.llLastErrorUs = llError;
+        m_TimedMoveStats.llTotalErrorUs += llError;
+        if(llError > m_TimedMoveStats.llMaxErrorUs)
+            m_TimedMoveStats.llMaxErrorUs = llError;
+
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
+        m_sLogFile << "["<<getTimeStamp()<<"]"<< " [timedMoveThread] stop sent " << llError << " us after deadline, nErr = " << nErr << std::endl;
+        m_sLogFile.flush();
+#else
+        (void)nErr;
+#endif
+    }
+}
+
+#pragma mark - non-sidereal tracking
+
+// Follow a moving target by updating the custom tracking rates from a rate model.
+// Every nCheckPeriodMs we integrate the difference between the model and the rates the mount
+// is using. A new rate is only sent when the error predicted for the next check would go over
+// dMaxErrorArcSec. It's the mean model rate over the time the previous rate was held, corrected
+// for the accumulated error, so the error swings around zero instead of building up.
+int ATCS::startNonSiderealTracking(const CRateModel &model, double dMaxErrorArcSec, int nCheckPeriodMs)
+{
+    if(!m_bIsConnected)
+        return NOT_CONNECTED;
+
+    if(!model.isValid() || dMaxErrorArcSec <= 0)
+        return ATCS_ERROR;
+
+    std::lock_guard<std::mutex> targetLock(m_TargetMutex);
+    stopSatelliteTrackingLocked();
+    stopNonSiderealTrackingLocked();
+
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
+    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [startNonSiderealTracking] max error " << dMaxErrorArcSec << " arcsec, check every " << nCheckPeriodMs << " ms" << std::endl;
+    m_sLogFile.flush();
+#endif
+
+    std::lock_guard<std::mutex> lock(m_NonSiderealMutex);
+    m_NonSiderealModel = model;
+    m_dNonSiderealMaxError = dMaxErrorArcSec;
+    m_nNonSiderealPeriodMs = std::max(nCheckPeriodMs, NS_MIN_PERIOD_MS);
+    memset(&m_NonSiderealStats, 0, sizeof(m_NonSiderealStats));
+    m_bNonSiderealRunning = true;
+    m_NonSiderealThread = std::thread(&ATCS::nonSiderealThread, this);
+
+    return PLUGIN_OK;
+}
+
+// stop updating the rates, the mount keeps tracking at the last rates sent
+void ATCS::stopNonSiderealTracking()
+{
+    std::lock_guard<std::mutex> targetLock(m_TargetMutex);
+    stopNonSiderealTrackingLocked();
+}
+
+// m_TargetMutex held, so only one thread joins m_NonSiderealThread or starts a new one
+void ATCS::stopNonSiderealTrackingLocked()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_NonSiderealMutex);
+        m_bNonSiderealRunning = false;
+        m_cvNonSidereal.notify_one();
+    }
+    if(m_NonSiderealThread.joinable())
+        m_NonSiderealThread.join();
+}
+
+bool ATCS::isNonSiderealTrackingActive()
+{
+    std::lock_guard<std::mutex> lock(m_NonSiderealMutex);
+    return m_bNonSiderealRunning;
+}
+
+void ATCS::getNonSiderealStats(NonSiderealStats &stats)
+{
+    std::lock_guard<std::mutex> lock(m_NonSiderealMutex);
+    stats = m_NonSiderealStats;
+}
+
+double ATCS::unixTimeNow()
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count() / 1e6;
+}
+
+int ATCS::sendNonSiderealRates(double dRaRate, double dDecRate)
 {
-    int nErr = PLUGIN_OK;
-    double dEast, dWest;
-
-    if(m_bLimitCached) {
-        dHoursEast = m_dHoursEast;
-        dHoursWest = m_dHoursWest;
-        return nErr;
-    }
+    int nErr;
+    std::string sResp;
 
-    nErr = getSoftLimitEastAngle(dEast);
+    // the setters skip an axis whose rate didn't change
+    nErr = setCustomTRateOffsetRA(dRaRate);
+    nErr |= setCustomTRateOffsetDec(dDecRate);
     if(nErr)
         return nErr;
+    return ATCSSendSetter(ATCL_CMD_RSTR, "Custom", sResp);
+}
 
-    nErr = getSoftLimitWestAngle(dWest);
-    if(nErr)
-        return nErr;
+void ATCS::nonSiderealThread()
+{
+    int nErr;
+    double dNow, dLast, dPeriod;
+    double dLastUpdate, dHorizon;
+    double dRaRate = 0, dDecRate = 0;     // what the mount is tracking at
+    double dRaError = 0, dDecError = 0;   // accumulated model - mount, arcsec
+    double dRaDrift, dDecDrift;
+    double dRaNext, dDecNext;
+    bool bFirst = true;
+    std::unique_lock<std::mutex> lock(m_NonSiderealMutex);
+
+    dPeriod = m_nNonSiderealPeriodMs / 1000.0;
+    dLast = unixTimeNow();
+    dLastUpdate = dLast;
+
+    while(m_bNonSiderealRunning) {
+        if(!bFirst) {
+            if(m_cvNonSidereal.wait_for(lock, std::chrono::milliseconds(m_nNonSiderealPeriodMs), [this]{ return !m_bNonSiderealRunning; }))
+                break;
+        }
+        dNow = unixTimeNow();
+        m_NonSiderealModel.driftOver(dLast, dNow, dRaRate, dDecRate, dRaDrift, dDecDrift);
+        dRaError += dRaDrift;
+        dDecError += dDecDrift;
+        dLast = dNow;
+        m_NonSiderealStats.ulChecks++;
+        m_NonSiderealStats.dMaxErrorArcSec = std::max(m_NonSiderealStats.dMaxErrorArcSec, std::max(std::fabs(dRaError), std::fabs(dDecError)));
+
+        // where will we be at the next check if we keep the current rates
+        m_NonSiderealModel.driftOver(dNow, dNow + dPeriod, dRaRate, dDecRate, dRaDrift, dDecDrift);
+        if(!bFirst && std::fabs(dRaError + dRaDrift) <= m_dNonSiderealMaxError && std::fabs(dDecError + dDecDrift) <= m_dNonSiderealMaxError)
+            continue;
 
-    dHoursEast = m_pTsx->hourAngle(dEast);
-    dHoursWest = m_pTsx->hourAngle(dWest);
+        // expect to hold the new rates about as long as the previous ones, rounded like the controller does
+        dHorizon = std::min(std::max(dNow - dLastUpdate, dPeriod), (double)NS_MAX_HORIZON);
+        m_NonSiderealModel.driftOver(dNow, dNow + dHorizon, 0, 0, dRaDrift, dDecDrift);
+        dRaNext = std::round((dRaDrift + dRaError) * 3600.0 / dHorizon * 100.0) / 100.0;
+        dDecNext = std::round((dDecDrift + dDecError) * 3600.0 / dHorizon * 100.0) / 100.0;
+        bFirst = false;
 
-    m_bLimitCached = true;
-    m_dHoursEast = dHoursEast;
-    m_dHoursWest = dHoursWest;
-    return nErr;
+        lock.unlock();
+        nErr = sendNonSiderealRates(dRaNext, dDecNext);
+        lock.lock();
+
+        if(nErr) {
+            // rates on the controller are unknown, retry at the next check
+            m_NonSiderealStats.ulErrors++;
+#if defined PLUGIN_DEBUG
+            m_sLogFile << "["<<getTimeStamp()<<"]"<< " [nonSiderealThread] Error setting rates, nErr = " << nErr << std::endl;
+            m_sLogFile.flush();
+#endif
+            continue;
+        }
+        dRaRate = dRaNext;
+        dDecRate = dDecNext;
+        dLastUpdate = dNow;
+        m_NonSiderealStats.ulUpdates++;
+        m_NonSiderealStats.dRaRate = dRaRate;
+        m_NonSiderealStats.dDecRate = dDecRate;
+#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
+        m_sLogFile << "["<<getTimeStamp()<<"]"<< " [nonSiderealThread] error " << dRaError << " / " << dDecError << " arcsec, new rates " << dRaRate << " / " << dDecRate << " arcsec/h" << std::endl;
+        m_sLogFile.flush();
+#endif
+    }
 }
 
-int ATCS::getSoftLimitEastAngle(double &dAngle)
+#pragma mark - satellite tracking
+
+// Track a LEO satellite pass.
+// We slew to where the satellite will be at the acquisition time and wait there, sidereal
+// tracking keeps us on that RA/Dec until the satellite gets to it. From then on the custom rates
+// are updated as fast as the link allows, each new rate being the satellite's mean rate over
+// the next update interval shifted by the measured command to effect latency.
+// The acquisition time is dStartTime (unix time) unless the mount can't be there by then, 0 means as soon as possible.
+int ATCS::startSatelliteTracking(const std::string &sTLELine1, const std::string &sTLELine2, double dStartTime)
 {
     int nErr;
+    double dRa, dDec, dAltitude = 0;
+    double dAcquisitionTime;
     std::string sResp;
 
-#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
-    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [getSoftLimitEastAngle] called." << std::endl;
-    m_sLogFile.flush();
-#endif
+    if(!m_bIsConnected)
+        return NOT_CONNECTED;
+
+    if(!m_pTsx)
+        return ATCS_ERROR;
 
-    nErr = ATCSSendCommand("!NGle;", sResp);
+    // the connection's sidereal restart would end the pass
+    nErr = waitConnectDone();
     if(nErr)
         return nErr;
-    dAngle = std::stof(sResp);
 
-    return nErr;
-}
+    std::lock_guard<std::mutex> targetLock(m_TargetMutex);
+    stopSatelliteTrackingLocked();
 
-int ATCS::getSoftLimitWestAngle(double &dAngle)
-{
-    int nErr;
-    std::string sResp;
+    nErr = m_SatellitePredictor.setTLE(sTLELine1, sTLELine2);
+    if(nErr) {
+#if defined PLUGIN_DEBUG
+        m_sLogFile << "["<<getTimeStamp()<<"]"<< " [startSatelliteTracking] Error loading TLE, nErr = " << nErr << std::endl;
+        m_sLogFile.flush();
+#endif
+        return ATCS_ERROR;
+    }
+    // TSX longitude is + going west
+    m_SatellitePredictor.setSite(m_pTsx->latitude(), -m_pTsx->longitude(), m_pTsx->elevation());
+
+    nErr = satelliteAcquisition(dStartTime, dAcquisitionTime, dRa, dDec, dAltitude);
+    if(nErr || dAltitude < SAT_MIN_ALTITUDE) {
+#if defined PLUGIN_DEBUG
+        m_sLogFile << "["<<getTimeStamp()<<"]"<< " [startSatelliteTracking] satellite not visible at acquisition time, altitude " << dAltitude << ", nErr = " << nErr << std::endl;
+        m_sLogFile.flush();
+#endif
+        return ATCS_ERROR;
+    }
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
-    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [getSoftLimitWestAngle] called." << std::endl;
+    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [startSatelliteTracking] acquisition in " << dAcquisitionTime - unixTimeNow() << " s at Ra " << dRa << " Dec " << dDec << " altitude " << dAltitude << std::endl;
     m_sLogFile.flush();
 #endif
 
-    nErr = ATCSSendCommand("!NGlw;", sResp);
+    // stay at sidereal while we wait at the acquisition point
+    stopNonSiderealTrackingLocked();
+    nErr = ATCSSendSetter(ATCL_CMD_RSTR, "Sidereal", sResp);
+    nErr |= slewToLocked(dRa, dDec);
     if(nErr)
         return nErr;
-    dAngle = std::stof(sResp);
 
-    return nErr;
-}
+    std::lock_guard<std::mutex> lock(m_SatelliteMutex);
+    m_dSatelliteStart = dAcquisitionTime;
+    memset(&m_SatelliteStats, 0, sizeof(m_SatelliteStats));
+    m_SatelliteStats.dAcquisitionTime = dAcquisitionTime;
+    m_bSatelliteRunning = true;
+    m_SatelliteThread = std::thread(&ATCS::satelliteThread, this);
 
-#pragma mark - Slew
+    return PLUGIN_OK;
+}
 
-int ATCS::startSlewTo(double dRa, double dDec)
+// The satellite keeps moving while we slew to it, so the acquisition time is pushed back to when the
+// mount can be there (slew from where it is now + settling margin) and the position solved again for it,
+// until the two agree.
+int ATCS::satelliteAcquisition(double dStartTime, double &dAcquisitionTime, double &dRa, double &dDec, double &dAltitude)
 {
-    int nErr = PLUGIN_OK;
-    bool bAligned;
-
-    nErr = isAligned(bAligned);
-    if(nErr)
-        return nErr;
+    int nErr;
+    int i;
+    double dMountRa, dMountDec;
+    double dRaDistance, dDecDistance;
+    double dEarliest;
 
-    // set sync target coordinate
-    nErr = setTarget(dRa, dDec);
+    nErr = getRaAndDec(dMountRa, dMountDec, 0);
     if(nErr)
         return nErr;
 
-    slewTargetRA_DecEpochNow();
-    return nErr;
+    dAcquisitionTime = std::max(dStartTime, unixTimeNow() + SAT_ACQUISITION_MARGIN);
+    for(i = 0; ; i++) {
+        nErr = m_SatellitePredictor.pointingAt(dAcquisitionTime, dRa, dDec, dAltitude);
+        if(nErr)
+            return nErr;
+        // both axes move at once
+        dRaDistance = fabs(remainder((dRa - dMountRa) * 15.0, 360.0));
+        dDecDistance = fabs(dDec - dMountDec);
+        dEarliest = unixTimeNow() + std::max(dRaDistance, dDecDistance) / SAT_SLEW_SPEED + SAT_ACQUISITION_MARGIN;
+        if(dAcquisitionTime >= dEarliest || i == SAT_ACQUISITION_SOLVES)
+            break;
+        dAcquisitionTime = dEarliest;
+    }
+    return PLUGIN_OK;
 }
 
-int ATCS::slewTargetRA_DecEpochNow()
+void ATCS::stopSatelliteTracking()
 {
-    int nErr;
-    std::string sResp;
+    std::lock_guard<std::mutex> targetLock(m_TargetMutex);
+    stopSatelliteTrackingLocked();
+}
 
-#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
-    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [slewTargetRA_DecEpochNow] called." << std::endl;
-    m_sLogFile.flush();
-#endif
+// m_TargetMutex held, same as stopNonSiderealTrackingLocked
+void ATCS::stopSatelliteTrackingLocked()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_SatelliteMutex);
+        m_bSatelliteRunning = false;
+        m_cvSatellite.notify_one();
+    }
+    if(m_SatelliteThread.joinable())
+        m_SatelliteThread.join();
+}
 
-    nErr = ATCSSendCommand("!GTrn;", sResp);
-    timer.Reset();
-    return nErr;
+bool ATCS::isSatelliteTrackingActive()
+{
+    std::lock_guard<std::mutex> lock(m_SatelliteMutex);
+    return m_bSatelliteRunning;
+}
 
+void ATCS::getSatelliteStats(SatelliteStats &stats)
+{
+    std::lock_guard<std::mutex> lock(m_SatelliteMutex);
+    stats = m_SatelliteStats;
 }
 
-int ATCS::startOpenSlew(const MountDriverInterface::MoveDir Dir, unsigned int nRate)
+void ATCS::satelliteThread()
 {
-    int nErr = PLUGIN_OK;
+    int nErr;
+    bool bComplete = false;
+    double dNow, dPassStart = 0;
+    double dLead, dInterval;
+    double dRaRate, dDecRate;
+    double dRa, dDec, dAltitude;
+    double dLatencyMs;
     std::string sResp;
-    std::stringstream ssTmp;
-
-
-    m_nOpenLoopDir = Dir;
-
-#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
-    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [startOpenSlew] setting Dir to " << Dir << std::endl;
-    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [startOpenSlew] setting rate to " << nRate << std::endl;
-    m_sLogFile.flush();
-#endif
-
-    // select rate
-    if(nRate == 4) { // "Slew"
-        nErr = ATCSSendCommand("!KSsl;", sResp);
-    }
-    else {
-        // clear slew
-        nErr = ATCSSendCommand("!KCsl;", sResp);
-        // select rate
-        // KScv + 1,2 3 or 4 for ViewVel 1,2,3,4, 'ViewVel 1' is index 0 so nRate+1
-        ssTmp << "!KScv" << (nRate+1) << ";";
-        nErr = ATCSSendCommand(ssTmp.str(), sResp);
+    int64_t nSlewStartNs = CSteadyTimer::NowNs();
+    CSteadyTimer sendTimer;
+    CSteadyTimer loopTimer;
+    std::unique_lock<std::mutex> lock(m_SatelliteMutex);
+
+    // wait for the pre-slew to end, the thread starts right after the slew so its start stands for the slew's
+    while(m_bSatelliteRunning && !bComplete) {
+        lock.unlock();
+        nErr = isSlewToComplete(bComplete, nSlewStartNs);
+        lock.lock();
+        if(nErr || !bComplete)
+            m_cvSatellite.wait_for(lock, std::chrono::milliseconds(SAT_SLEW_POLL_MS), [this]{ return !m_bSatelliteRunning; });
     }
-    // figure out direction
-    switch(Dir){
-        case MountDriverInterface::MD_NORTH:
-            nErr = ATCSSendCommand("!KSpu100;", sResp);
-            break;
-        case MountDriverInterface::MD_SOUTH:
-            nErr = ATCSSendCommand("!KSpd100;", sResp);
-            break;
-        case MountDriverInterface::MD_EAST:
-            nErr = ATCSSendCommand("!KSpl100;", sResp);
+
+    // then for the satellite to get to us
+    dNow = unixTimeNow();
+    if(m_bSatelliteRunning && dNow < m_dSatelliteStart)
+        m_cvSatellite.wait_for(lock, std::chrono::microseconds((long long)ceil((m_dSatelliteStart - dNow) * 1e6)), [this]{ return !m_bSatelliteRunning; });
+
+    dInterval = SAT_MIN_PERIOD_MS / 1000.0;
+    loopTimer.Reset();
+    while(m_bSatelliteRunning) {
+        dNow = unixTimeNow();
+        if(dPassStart == 0)
+            dPassStart = dNow;
+        dLead = m_SatelliteStats.dLatencyMs / 1000.0;
+
+        nErr = m_SatellitePredictor.pointingAt(dNow + dLead, dRa, dDec, dAltitude);
+        if(nErr || dAltitude < SAT_MIN_ALTITUDE)
             break;
-        case MountDriverInterface::MD_WEST:
-            nErr = ATCSSendCommand("!KSsr100;", sResp);
+        // the new rates only apply once the controller has them, aim at where the satellite will be then
+        nErr = m_SatellitePredictor.ratesOver(dNow + dLead, dNow + dLead + dInterval, dRaRate, dDecRate);
+        if(nErr)
             break;
-    }
 
-    return nErr;
-}
+        lock.unlock();
+        sendTimer.Reset();
+        nErr = sendNonSiderealRates(dRaRate, dDecRate);
+        dLatencyMs = sendTimer.GetElapsedMs();
+        lock.lock();
 
-int ATCS::stopOpenLoopMove()
-{
-    int nErr = PLUGIN_OK;
-    std::string sResp;
+        if(nErr) {
+            m_SatelliteStats.ulErrors++;
+        }
+        else {
+            m_SatelliteStats.ulUpdates++;
+            if(m_SatelliteStats.ulUpdates == 1)
+                m_SatelliteStats.dLatencyMs = dLatencyMs;
+            else
+                m_SatelliteStats.dLatencyMs += SAT_LATENCY_EWMA * (dLatencyMs - m_SatelliteStats.dLatencyMs);
+            m_SatelliteStats.dMaxLatencyMs = std::max(m_SatelliteStats.dMaxLatencyMs, dLatencyMs);
+        }
+
+        // leave the link to the other commands for a moment
+        m_cvSatellite.wait_for(lock, std::chrono::milliseconds(SAT_MIN_PERIOD_MS), [this]{ return !m_bSatelliteRunning; });
+        dInterval = loopTimer.GetElapsedSeconds();
+        loopTimer.Reset();
+        if(dNow > dPassStart)
+            m_SatelliteStats.dUpdateHz = m_SatelliteStats.ulUpdates / (unixTimeNow() - dPassStart);
+    }
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
-    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [stopOpenLoopMove] dir was " << m_nOpenLoopDir << std::endl;
+    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [satelliteThread] pass done, " << m_SatelliteStats.ulUpdates << " updates at " << m_SatelliteStats.dUpdateHz << " Hz, latency " << m_SatelliteStats.dLatencyMs << " ms (max " << m_SatelliteStats.dMaxLatencyMs << " ms)" << std::endl;
     m_sLogFile.flush();
 #endif
 
-    switch(m_nOpenLoopDir){
-        case MountDriverInterface::MD_NORTH:
-        case MountDriverInterface::MD_SOUTH:
-            nErr = ATCSSendCommand("!XXud;", sResp);
-            break;
-        case MountDriverInterface::MD_EAST:
-        case MountDriverInterface::MD_WEST:
-            nErr = ATCSSendCommand("!XXlr;", sResp);
-            break;
+    // the satellite set, go back to sidereal unless we were stopped by something that will set its own mode
+    if(m_bSatelliteRunning) {
+        m_bSatelliteRunning = false;
+        lock.unlock();
+        ATCSSendSetter(ATCL_CMD_RSTR, "Sidereal", sResp);
     }
-
-    return nErr;
 }
 
 int ATCS::isSlewToComplete(bool &bComplete)
+{
+    return isSlewToComplete(bComplete, m_nSlewStartNs.load());
+}
+
+// nSlewStartNs is when the caller started its slew, the satellite thread keeps its own
+int ATCS::isSlewToComplete(bool &bComplete, int64_t nSlewStartNs)
 {
     int nErr = PLUGIN_OK;
-    std::string sResp;
     int nPrecentRemaining;
 
     bComplete = false;
 
-    if(timer.GetElapsedSeconds()<2) {
+    if(CSteadyTimer::NowNs() - nSlewStartNs < 2000000000LL) {
         // we're checking for comletion to quickly, assume it's moving for now
         return nErr;
     }
@@ -1076,23 +2877,15 @@ int ATCS::isSlewToComplete(bool &bComplete)
     m_sLogFile.flush();
 #endif
 
-    nErr = ATCSSendCommand("!GGgr;", sResp);
+    // "nn%"
+    nErr = pollRead(ATCL_CMD_GGGR, parseIntegerInto(nPrecentRemaining));
     if(nErr)
         return nErr;
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
-    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [isSlewToComplete] szResp : " << sResp << std::endl;
-    m_sLogFile.flush();
-#endif
-
-    // remove the %
-    sResp = rtrim(sResp, "%");
-
-#if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
-    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [isSlewToComplete] szResp : " << sResp << std::endl;
+    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [isSlewToComplete] remaining : " << nPrecentRemaining << "%" << std::endl;
     m_sLogFile.flush();
 #endif
 
-    nPrecentRemaining = std::stoi(sResp);
     if(nPrecentRemaining == 0)
         bComplete = true;
 
@@ -1114,8 +2907,19 @@ int ATCS::gotoPark(double dRa, double dDec)
     m_sLogFile.flush();
 #endif
 
-    // goto park
-    nErr = ATCSSendCommand("!GTop;", sResp);
+    nErr = waitConnectDone();
+    if(nErr)
+        return nErr;
+
+    // goto park, the controller stops tracking once parked
+    stopNonSiderealTracking();
+    stopSatelliteTracking();
+    invalidateSetterShadow(ATCL_CMD_RSTR);
+    nErr = ATCSSendCommand(ATCL_CMD_GTOP, sResp);
+    if(!nErr) {
+        std::lock_guard<std::mutex> lock(m_PierSideMutex);
+        m_PierSide.sideLost();
+    }
 
     return nErr;
 }
@@ -1130,7 +2934,11 @@ int ATCS::markParkPosition()
     m_sLogFile.flush();
 #endif
 
-    nErr = ATCSSendCommand("!AMpp;", sResp);
+    nErr = waitConnectDone();
+    if(nErr)
+        return nErr;
+
+    nErr = ATCSSendCommand(ATCL_CMD_AMPP, sResp);
 
     return nErr;
 
@@ -1139,7 +2947,6 @@ int ATCS::markParkPosition()
 int ATCS::getAtPark(bool &bParked)
 {
     int nErr = PLUGIN_OK;
-    std::string sResp;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [getAtPark] called." << std::endl;
@@ -1147,52 +2954,51 @@ int ATCS::getAtPark(bool &bParked)
 #endif
 
     bParked = false;
-    nErr = ATCSSendCommand("!AGak;", sResp);
-    if(sResp.find("Yes") != -1) {
-        bParked = true;
-    }
+    nErr = pollRead(ATCL_CMD_AGAK, parseYesNoInto(bParked));
     return nErr;
 }
 
 int ATCS::unPark()
 {
     int nErr = PLUGIN_OK;
-    bool bAligned;
+    bool bAligned = false;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [unPark] called." << std::endl;
     m_sLogFile.flush();
 #endif
 
-    // are we aligned ?
-    nErr = isAligned(bAligned);
-    if(nErr) {
-#ifdef PLUGIN_DEBUG
-        m_sLogFile << "["<<getTimeStamp()<<"]"<< " [unPark] Error getting alignement status." << std::endl;
-        m_sLogFile.flush();
-#endif
+    nErr = waitConnectDone();
+    if(nErr)
         return nErr;
-    }
 
+    std::vector<ATCSStep> steps = {
+        // are we aligned ?
+        {"isAligned", [&] { return isAligned(bAligned); }},
+        {"alignFromLastPosition", [&]() -> int {
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
-    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [unPark] bAligned = " << (bAligned?"true":"false") << std::endl;
-    m_sLogFile.flush();
+            m_sLogFile << "["<<getTimeStamp()<<"]"<< " [unPark] bAligned = " << (bAligned?"true":"false") << std::endl;
+            m_sLogFile.flush();
 #endif
-
-    // if not
-    if(!bAligned) {
-        nErr = alignFromLastPosition();
-        if(nErr) {
+            // if not
+            if(!bAligned && alignFromLastPosition()) {
 #ifdef PLUGIN_DEBUG
-            m_sLogFile << "["<<getTimeStamp()<<"]"<< " [unPark] error aligning to last position." << std::endl;
-            m_sLogFile.flush();
+                m_sLogFile << "["<<getTimeStamp()<<"]"<< " [unPark] error aligning to last position." << std::endl;
+                m_sLogFile.flush();
 #endif
-        }
-    }
-    nErr = setTrackingRates(true, true, 0, 0);
+            }
+            return PLUGIN_OK;
+        }},
+        {"setTrackingRates", [&]() -> int {
+            // aligning from the park position may have changed the tracking mode, always resend it
+            invalidateSetterShadow(ATCL_CMD_RSTR);
+            return setTrackingRates(true, true, 0, 0);
+        }}
+    };
+    nErr = runSteps("unPark", steps);
     if(nErr) {
 #ifdef PLUGIN_DEBUG
-        m_sLogFile << "["<<getTimeStamp()<<"]"<< " [unPark] Error setting track rate to Sidereal." << std::endl;
+        m_sLogFile << "["<<getTimeStamp()<<"]"<< " [unPark] Error " << nErr << " unparking." << std::endl;
         m_sLogFile.flush();
 #endif
     }
@@ -1203,8 +3009,6 @@ int ATCS::unPark()
 int ATCS::getRefractionCorrEnabled(bool &bEnabled)
 {
     int nErr = PLUGIN_OK;
-    char szResp[SERIAL_BUFFER_SIZE];
-    std::string sResp;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [getRefractionCorrEnabled] called." << std::endl;
@@ -1212,17 +3016,13 @@ int ATCS::getRefractionCorrEnabled(bool &bEnabled)
 #endif
 
     bEnabled = false;
-    nErr = ATCSSendCommand("!PGre;", sResp);
-    if(strncmp(szResp,"Yes",SERIAL_BUFFER_SIZE) == 0) {
-        bEnabled = true;
-    }
+    nErr = ATCSSendCommand(ATCL_CMD_PGRE, parseYesNoInto(bEnabled));
     return nErr;
 }
 
 int ATCS::setRefractionCorrEnabled(bool bEnable)
 {
     int nErr = PLUGIN_OK;
-    std::string sCmd;
     std::string sResp;
 
     if(!m_bIsConnected)
@@ -1233,13 +3033,7 @@ int ATCS::setRefractionCorrEnabled(bool bEnable)
     m_sLogFile.flush();
 #endif
 
-    if(bEnable) {
-        sCmd = "!PSreYes;";
-    }
-    else  {
-        sCmd = "!PSreNo;";
-    }
-    nErr = ATCSSendCommand(sCmd, sResp);
+    nErr = ATCSSendCommand(ATCL_CMD_PSRE, bEnable ? "Yes" : "No", sResp);
 
     return nErr;
 }
@@ -1255,7 +3049,18 @@ int ATCS::Abort()
     m_sLogFile.flush();
 #endif
 
-    nErr = ATCSSendCommand("!XXxx;", sResp);
+    requestAbort();
+    cancelTimedMove();
+    stopNonSiderealTracking();
+    stopSatelliteTracking();
+    invalidateSetterShadow(ATCL_CMD_RSTR);
+
+    nErr = ATCSSendCommand(ATCL_CMD_XXXX, sResp);
+    if(!nErr) {
+        std::lock_guard<std::mutex> lock(m_OpenLoopMutex);
+        m_nOpenLoopAxisDir[OL_AXIS_RA] = OL_AXIS_IDLE;
+        m_nOpenLoopAxisDir[OL_AXIS_DEC] = OL_AXIS_IDLE;
+    }
     return nErr;
 }
 
@@ -1267,7 +3072,6 @@ int ATCS::syncTime()
     double sec;
     int n12h_time;
 
-    std::string sCmd;
     std::string sResp;
     std::stringstream ssTmp;
     std::string sAmPm;
@@ -1277,6 +3081,11 @@ int ATCS::syncTime()
     m_sLogFile.flush();
 #endif
 
+    // m_b24h is read by the setup
+    nErr = waitConnectDone();
+    if(nErr)
+        return nErr;
+
     m_pTsx->localDateTime(yy, mm, dd, h, min, sec, dst);
     if(!m_b24h) {
         n12h_time = h%12;
@@ -1291,14 +3100,13 @@ int ATCS::syncTime()
         ssTmp << std::setfill('0') << std::setw(2) << h << ":" << std::setfill('0') << std::setw(2) << min << ":" << std::setfill('0') << std::setw(5) << std::fixed << std::setprecision(2) << sec;
     }
 
-    sCmd = "!TSst" + ssTmp.str() + ";";
 #ifdef PLUGIN_DEBUG
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [syncTime] setting time to : " << ssTmp.str() << std::endl;
-    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [syncTime] Command is  : " << sCmd << std::endl;
+    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [syncTime] Command is  : " << atclFormat(ATCL_CMD_TSST, ssTmp.str()) << std::endl;
     m_sLogFile.flush();
 #endif
 
-    nErr = ATCSSendCommand(sCmd, sResp);
+    nErr = ATCSSendCommand(ATCL_CMD_TSST, ssTmp.str(), sResp);
     getStandardTime(m_sTime);
 
     return nErr;
@@ -1311,7 +3119,6 @@ int ATCS::syncDate()
     int yy, mm, dd, h, min, dst;
     double sec;
 
-    std::string sCmd;
     std::string sResp;
     std::stringstream ssTmp;
 
@@ -1320,6 +3127,11 @@ int ATCS::syncDate()
     m_sLogFile.flush();
 #endif
 
+    // m_bDdMmYy is read by the setup
+    nErr = waitConnectDone();
+    if(nErr)
+        return nErr;
+
     m_pTsx->localDateTime(yy, mm, dd, h, min, sec, dst);
     // yy is actually yyyy, need conversion to yy, 2017 -> 17
     yy = yy - (int(yy / 1000) * 1000);
@@ -1331,15 +3143,14 @@ int ATCS::syncDate()
         ssTmp << std::setfill('0') << std::setw(2) << dd << "/" << std::setfill('0') << std::setw(2) << mm << "/" << std::setfill('0') << std::setw(2) << yy;
     }
 
-    sCmd = "!TSsd" + ssTmp.str() + ";";
 
 #ifdef PLUGIN_DEBUG
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [syncDate] setting time to : " << ssTmp.str() << std::endl;
-    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [syncDate] Command is  : " << sCmd << std::endl;
+    m_sLogFile << "["<<getTimeStamp()<<"]"<< " [syncDate] Command is  : " << atclFormat(ATCL_CMD_TSSD, ssTmp.str()) << std::endl;
     m_sLogFile.flush();
 #endif
 
-    nErr = ATCSSendCommand(sCmd, sResp);
+    nErr = ATCSSendCommand(ATCL_CMD_TSSD, ssTmp.str(), sResp);
 
     getStandardDate(m_sDate);
     return nErr;
@@ -1378,6 +3189,10 @@ int ATCS::setSiteData(double dLongitude, double dLatitute, double dTimeZone)
     m_sLogFile.flush();
 #endif
 
+    nErr = waitConnectDone();
+    if(nErr)
+        return nErr;
+
     convertDecDegToDDMMSS(dLongitude, sLong, cSignLong);
     convertDecDegToDDMMSS(dLatitute, sLat, cSignLat);
     ssTmp<< std::setfill('0') << std::setw(2) << int(fabs(dTimeZone));
@@ -1418,9 +3233,20 @@ int ATCS::setSiteData(double dLongitude, double dLatitute, double dTimeZone)
     m_sLogFile.flush();
 #endif
 
-    nErr = setSiteLongitude(m_nSiteNumber, sLong);
-    nErr |= setSiteLatitude(m_nSiteNumber, sLat);
-    nErr |= setSiteTimezone(m_nSiteNumber, sTimeZone);
+    std::vector<ATCSStep> steps = {
+        {"setSiteLongitude", [&] { return setSiteLongitude(m_nSiteNumber, sLong); }},
+        {"setSiteLatitude", [&] { return setSiteLatitude(m_nSiteNumber, sLat); }},
+        {"setSiteTimezone", [&] { return setSiteTimezone(m_nSiteNumber, sTimeZone); }}
+    };
+    nErr = runSteps("setSiteData", steps);
+    if(!nErr) {
+        {
+            std::lock_guard<std::mutex> lock(m_SiderealMutex);
+            m_SiderealClock.setLongitude(dLongitude);
+        }
+        std::lock_guard<std::mutex> lock(m_PierSideMutex);
+        m_SlewLimits.setLatitude(dLatitute);
+    }
 
     return nErr;
 }
@@ -1433,6 +3259,11 @@ int ATCS::getSiteData(std::string &sLongitude, std::string &sLatitude, std::stri
     m_sLogFile.flush();
 #endif
 
+    // m_nSiteNumber is read by the setup
+    nErr = waitConnectDone();
+    if(nErr)
+        return nErr;
+
     nErr = getSiteLongitude(m_nSiteNumber, sLongitude);
     nErr |= getSiteLatitude(m_nSiteNumber, sLatitude);
     nErr |= getSiteTZ(m_nSiteNumber, sTimeZone);
@@ -1451,7 +3282,7 @@ int ATCS::getTopActiveFault(std::string &sFault)
     m_sLogFile.flush();
 #endif
 
-    nErr = ATCSSendCommand("!HGtf;", sResp);
+    nErr = pollRead(ATCL_CMD_HGTF, sResp);
     if(nErr)
         return nErr;
     sFault.assign(sResp);
@@ -1468,7 +3299,7 @@ int ATCS::disablePacketSeqChecking()
     m_sLogFile.flush();
 #endif
 
-    nErr = ATCSSendCommand("!QDps;", sResp);
+    nErr = ATCSSendCommand(ATCL_CMD_QDPS, sResp);
 
     return nErr;
 }
@@ -1483,7 +3314,7 @@ int ATCS::disableStaticStatusChangeNotification()
     m_sLogFile.flush();
 #endif
 
-    nErr = ATCSSendCommand("!QDcn;", sResp);
+    nErr = ATCSSendCommand(ATCL_CMD_QDCN, sResp);
     return nErr;
 }
 
@@ -1491,7 +3322,6 @@ int ATCS::disableStaticStatusChangeNotification()
 int ATCS::checkSiteTimeDateSetOnce(bool &bSet)
 {
     int nErr = PLUGIN_OK;
-    std::string sResp;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [checkSiteTimeDateSetOnce] called." << std::endl;
@@ -1499,28 +3329,23 @@ int ATCS::checkSiteTimeDateSetOnce(bool &bSet)
 #endif
 
     bSet = false;
-    nErr = ATCSSendCommand("!ACst;", sResp);
-    if(sResp.find("Yes") != -1) {
-        bSet = true;
-    }
+    nErr = ATCSSendCommand(ATCL_CMD_ACST, parseYesNoInto(bSet));
     return nErr;
 }
 
 int ATCS::getUsingSiteNumber(int &nSiteNb)
 {
     int nErr = PLUGIN_OK;
-    std::string sResp;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [getUsingSiteNumber] called." << std::endl;
     m_sLogFile.flush();
 #endif
 
-    nErr = ATCSSendCommand("!SGuu;", sResp);
+    nErr = ATCSSendCommand(ATCL_CMD_SGUU, parseIntegerInto(nSiteNb));
     if(nErr)
         return nErr;
 
-    nSiteNb = std::stoi(sResp);
     m_nSiteNumber = nSiteNb;
     return nErr;
 
@@ -1530,15 +3355,13 @@ int ATCS::getUsingSiteName(int nSiteNb, std::string &sSiteName)
 {
     int nErr = PLUGIN_OK;
     std::string sResp;
-    std::stringstream ssTmp;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [getUsingSiteName] called." << std::endl;
     m_sLogFile.flush();
 #endif
 
-    ssTmp << "!SGun" << nSiteNb <<";";
-    nErr = ATCSSendCommand(ssTmp.str(), sResp);
+    nErr = ATCSSendCommand(ATCL_CMD_SGUN, atclSite(nSiteNb), sResp);
     if(nErr)
         return nErr;
     sSiteName.assign(sResp);
@@ -1549,15 +3372,13 @@ int ATCS::setSiteLongitude(int nSiteNb, const std::string sLongitude)
 {
     int nErr = PLUGIN_OK;
     std::string sResp;
-    std::stringstream ssTmp;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [setSiteLongitude] called." << std::endl;
     m_sLogFile.flush();
 #endif
 
-    ssTmp << "!SSo" << nSiteNb << sLongitude <<";";
-    nErr = ATCSSendCommand(ssTmp.str(), sResp);
+    nErr = ATCSSendCommand(ATCL_CMD_SSO, atclSite(nSiteNb, sLongitude), sResp);
 
     return nErr;
 }
@@ -1566,15 +3387,13 @@ int ATCS::setSiteLatitude(int nSiteNb, const std::string sLatitude)
 {
     int nErr = PLUGIN_OK;
     std::string sResp;
-    std::stringstream ssTmp;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [setSiteLatitude] called." << std::endl;
     m_sLogFile.flush();
 #endif
 
-    ssTmp << "!SSa" << nSiteNb << sLatitude <<";";
-    nErr = ATCSSendCommand(ssTmp.str(), sResp);
+    nErr = ATCSSendCommand(ATCL_CMD_SSA, atclSite(nSiteNb, sLatitude), sResp);
 
     return nErr;
 }
@@ -1583,15 +3402,13 @@ int ATCS::setSiteTimezone(int nSiteNb, const std::string sTimezone)
 {
     int nErr = PLUGIN_OK;
     std::string sResp;
-    std::stringstream ssTmp;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [setSiteTimezone] called." << std::endl;
     m_sLogFile.flush();
 #endif
 
-    ssTmp << "!SSz" << nSiteNb << sTimezone <<";";
-    nErr = ATCSSendCommand(ssTmp.str(), sResp);
+    nErr = ATCSSendCommand(ATCL_CMD_SSZ, atclSite(nSiteNb, sTimezone), sResp);
 
     return nErr;
 }
@@ -1600,36 +3417,56 @@ int ATCS::getSiteLongitude(int nSiteNb, std::string &sLongitude)
 {
     int nErr = PLUGIN_OK;
     std::string sResp;
-    std::stringstream ssTmp;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [getSiteLongitude] called." << std::endl;
     m_sLogFile.flush();
 #endif
 
-    ssTmp << "!SGo" << nSiteNb <<";";
-    nErr = ATCSSendCommand(ssTmp.str(), sResp);
+    nErr = ATCSSendCommand(ATCL_CMD_SGO, atclSite(nSiteNb), sResp);
     if(!nErr) {
         sLongitude.assign(sResp);
+        if(nSiteNb == m_nSiteNumber)
+            cacheSiteLongitude(sResp);
     }
     return nErr;
 }
 
+void ATCS::cacheSiteLatitude(const std::string &sLatitude)
+{
+    double dLatitude;
+
+    if(!atclParseSiteAngle(sLatitude.c_str(), dLatitude))
+        return;
+    std::lock_guard<std::mutex> lock(m_PierSideMutex);
+    m_SlewLimits.setLatitude(dLatitude);
+}
+
+void ATCS::cacheSiteLongitude(const std::string &sLongitude)
+{
+    double dLongitude;
+
+    if(!atclParseSiteAngle(sLongitude.c_str(), dLongitude))
+        return;
+    std::lock_guard<std::mutex> lock(m_SiderealMutex);
+    m_SiderealClock.setLongitude(dLongitude);
+}
+
 int ATCS::getSiteLatitude(int nSiteNb, std::string &sLatitude)
 {
     int nErr = PLUGIN_OK;
     std::string sResp;
-    std::stringstream ssTmp;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [getSiteLatitude] called." << std::endl;
     m_sLogFile.flush();
 #endif
 
-    ssTmp << "!SGa" << nSiteNb <<";";
-    nErr = ATCSSendCommand(ssTmp.str(), sResp);
+    nErr = ATCSSendCommand(ATCL_CMD_SGA, atclSite(nSiteNb), sResp);
     if(!nErr) {
         sLatitude.assign(sResp);
+        if(nSiteNb == m_nSiteNumber)
+            cacheSiteLatitude(sResp);
     }
 
     return nErr;
@@ -1639,15 +3476,13 @@ int ATCS::getSiteTZ(int nSiteNb, std::string &sTimeZone)
 {
     int nErr = PLUGIN_OK;
     std::string sResp;
-    std::stringstream ssTmp;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [getSiteTZ] called." << std::endl;
     m_sLogFile.flush();
 #endif
 
-    ssTmp << "!SGz" << nSiteNb <<";";
-    nErr = ATCSSendCommand(ssTmp.str(), sResp);
+    nErr = ATCSSendCommand(ATCL_CMD_SGZ, atclSite(nSiteNb), sResp);
     if(!nErr) {
         sTimeZone.assign(sResp);
     }
@@ -1668,7 +3503,7 @@ int ATCS::getLocalTimeFormat(bool &b24h)
     m_sLogFile.flush();
 #endif
 
-    nErr = ATCSSendCommand("!TGlf;", sResp);
+    nErr = ATCSSendCommand(ATCL_CMD_TGLF, sResp);
 
     if(nErr)
         return nErr;
@@ -1690,7 +3525,7 @@ int ATCS::getDateFormat(bool &bDdMmYy )
     m_sLogFile.flush();
 #endif
 
-    nErr = ATCSSendCommand("!TGdf;", sResp);
+    nErr = ATCSSendCommand(ATCL_CMD_TGDF, sResp);
     if(nErr)
         return nErr;
     bDdMmYy = false;
@@ -1710,7 +3545,7 @@ int ATCS::getStandardTime(std::string &sTime)
     m_sLogFile.flush();
 #endif
 
-    nErr = ATCSSendCommand("!TGst;", sResp);
+    nErr = pollRead(ATCL_CMD_TGST, sResp);
     if(nErr)
         return nErr;
     sTime.assign(sResp);
@@ -1727,7 +3562,7 @@ int ATCS::getStandardDate(std::string &sDate)
     m_sLogFile.flush();
 #endif
 
-    nErr = ATCSSendCommand("!TGsd;", sResp);
+    nErr = pollRead(ATCL_CMD_TGSD, sResp);
     if(nErr)
         return nErr;
 
@@ -1739,7 +3574,6 @@ int ATCS::getStandardDate(std::string &sDate)
 int ATCS::setAsyncUpdateEnabled(bool bEnable)
 {
     int nErr = PLUGIN_OK;
-    std::string sCmd;
     std::string sResp;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
@@ -1747,13 +3581,7 @@ int ATCS::setAsyncUpdateEnabled(bool bEnable)
     m_sLogFile.flush();
 #endif
 
-    if(bEnable) {
-        sCmd = "!QSauYes;";
-    }
-    else  {
-        sCmd = "!QSauNo;";
-    }
-    nErr = ATCSSendCommand(sCmd, sResp);
+    nErr = ATCSSendCommand(ATCL_CMD_QSAU, bEnable ? "Yes" : "No", sResp);
 
     return nErr;
 }
@@ -1762,15 +3590,13 @@ int ATCS::setEpochOfEntry(const char *szEpoch)
 {
     int nErr;
     std::string sResp;
-    std::stringstream ssTmp;
 
 #if defined PLUGIN_DEBUG && PLUGIN_DEBUG >= 2
     m_sLogFile << "["<<getTimeStamp()<<"]"<< " [setEpochOfEntry] called." << std::endl;
     m_sLogFile.flush();
 #endif
 
-    ssTmp << "!PSep" << szEpoch <<";";
-    nErr = ATCSSendCommand(ssTmp.str(), sResp);
+    nErr = ATCSSendSetter(ATCL_CMD_PSEP, szEpoch, sResp);
     return nErr;
 }
 
@@ -1784,7 +3610,7 @@ int ATCS::alignFromTargetRA_DecCalcSide()
     m_sLogFile.flush();
 #endif
 
-    nErr = ATCSSendCommand("!AFcs;", sResp);
+    nErr = ATCSSendCommand(ATCL_CMD_AFCS, sResp);
 
     return nErr;
 }
@@ -1799,7 +3625,7 @@ int ATCS::alignFromTargetRA_DecCalcSideEpochNow()
     m_sLogFile.flush();
 #endif
 
-    nErr = ATCSSendCommand("!AFcn;", sResp);
+    nErr = ATCSSendCommand(ATCL_CMD_AFCN, sResp);
 
     return nErr;
 }
@@ -1814,7 +3640,7 @@ int ATCS::alignFromLastPosition()
     m_sLogFile.flush();
 #endif
 
-    nErr = ATCSSendCommand("!AFlp;", sResp);
+    nErr = ATCSSendCommand(ATCL_CMD_AFLP, sResp);
 
     return nErr;
 }
@@ -1822,6 +3648,7 @@ int ATCS::alignFromLastPosition()
 
 void ATCS::convertDecDegToDDMMSS(double dDeg, std::string  &sResult, char &cSign)
 {
+    ATCS_SCOPED_SPAN("ATCS::convertDecDegToDDMMSS");
     int DD, MM, SS;
     double mm, ss;
     std::stringstream ssTmp;
@@ -1841,35 +3668,9 @@ void ATCS::convertDecDegToDDMMSS(double dDeg, std::string  &sResult, char &cSign
 }
 
 
-int ATCS::convertDDMMSSToDecDeg(const std::string StrDeg, double &dDecDeg)
-{
-    int nErr = PLUGIN_OK;
-    std::vector<std::string> vFieldsData;
-
-    dDecDeg = 0;
-
-    nErr = parseFields(StrDeg, vFieldsData, ':');
-    if(nErr)
-        return nErr;
-
-    if(vFieldsData.size() >= 3) {
-        dDecDeg = std::stod(vFieldsData[0]);
-        if(dDecDeg <0) {
-            dDecDeg = dDecDeg - std::stod(vFieldsData[1])/60.0 - std::stod(vFieldsData[2])/3600.0;
-        }
-        else {
-            dDecDeg = dDecDeg + std::stod(vFieldsData[1])/60.0 + std::stod(vFieldsData[2])/3600.0;
-        }
-    }
-    else
-        nErr = ERR_PARSE;
-
-    return nErr;
-}
-
-
 void ATCS::convertRaToHHMMSSt(double dRa, std::string &sResult)
 {
+    ATCS_SCOPED_SPAN("ATCS::convertRaToHHMMSSt");
     int HH, MM;
     double hh, mm, SSt;
     std::stringstream ssTmp;
@@ -1888,45 +3689,6 @@ void ATCS::convertRaToHHMMSSt(double dRa, std::string &sResult)
 }
 
 
-int ATCS::convertHHMMSStToRa(const std::string StrRa, double &dRa)
-{
-    int nErr = PLUGIN_OK;
-    std::vector<std::string> vFieldsData;
-
-    dRa = 0;
-
-    nErr = parseFields(StrRa, vFieldsData, ':');
-    if(nErr)
-        return nErr;
-
-    if(vFieldsData.size() >= 3) {
-        dRa = atof(vFieldsData[0].c_str()) + atof(vFieldsData[1].c_str())/60.0 + atof(vFieldsData[2].c_str())/3600.0;
-    }
-    else
-        nErr = ERR_PARSE;
-
-    return nErr;
-}
-
-int ATCS::parseFields(const std::string szIn, std::vector<std::string> &svFields, char cSeparator)
-{
-    int nErr = PLUGIN_OK;
-    std::string sSegment;
-    std::stringstream ssTmp(szIn);
-
-    svFields.clear();
-    // split the string into vector elements
-    while(std::getline(ssTmp, sSegment, cSeparator))
-    {
-        svFields.push_back(sSegment);
-    }
-
-    if(svFields.size()==0) {
-        nErr = ERR_PARSE;
-    }
-    return nErr;
-}
-
 std::string& ATCS::trim(std::string &str, const std::string& filter )
 {
     return ltrim(rtrim(str, filter), filter);
@@ -21,35 +21,56 @@
 #include <fstream>
 #include <chrono>
 #include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <ctime>
 #include <cmath>
 #include <iomanip>
 #include <algorithm>
+#include <map>
+#include <atomic>
+#include <functional>
 
 #include "../../licensedinterfaces/sberrorx.h"
 #include "../../licensedinterfaces/theskyxfacadefordriversinterface.h"
 #include "../../licensedinterfaces/sleeperinterface.h"
+#include "../../licensedinterfaces/basiciniutilinterface.h"
 #include "../../licensedinterfaces/serxinterface.h"
 #include "../../licensedinterfaces/loggerinterface.h"
 #include "../../licensedinterfaces/mountdriverinterface.h"
 #include "../../licensedinterfaces/mount/asymmetricalequatorialinterface.h"
 
-#include "StopWatch.h"
+#include "ATCSTiming.h"
+#include "ATCSProbes.h"
+#include "ATCSCommands.h"
+#include "ATCSCommandTimeouts.h"
+#include "ATCSRateModel.h"
+#include "ATCSSatellite.h"
+#include "ATCSTransport.h"
+#include "LinuxSerialTransport.h"
+#include "TCPTransport.h"
+#include "ATCSReactor.h"
+#include "ATCSSnapshot.h"
+#include "ATCSPierSide.h"
+#include "ATCSSidereal.h"
+#include "ATCSSlewLimits.h"
 
 // #define PLUGIN_DEBUG 2   // define this to have log files, 1 = bad stuff only, 2 and up.. full debug
 #define PLUGIN_VERSION 1.6
 
-enum ATCSErrors {PLUGIN_OK=0, NOT_CONNECTED, ATCS_CANT_CONNECT, ATCS_BAD_CMD_RESPONSE, COMMAND_FAILED, COMMAND_TIMEOUT, ATCS_ERROR};
+enum ATCSErrors {PLUGIN_OK=0, NOT_CONNECTED, ATCS_CANT_CONNECT, ATCS_BAD_CMD_RESPONSE, COMMAND_FAILED, COMMAND_TIMEOUT, ATCS_ERROR, ATCS_ABORTED};
 
 #define SERIAL_BUFFER_SIZE 1024
 #define MAX_TIMEOUT 1000
+#define ADAPTIVE_TIMEOUT 0     // use the timeout learned for that command
+#define CMD_MAX_RETRY   1       // retries for a query that timed out
+#define RX_RESYNC_QUIET_MS  10  // after a timeout the line must stay quiet that long before the next command
 #define ERR_PARSE   1
 
 #define MAX_READ_WAIT_TIMEOUT 25
 #define NB_RX_WAIT 10
 
 /// ATCL response code
-#define ATCL_ENTER  0xB1
 #define ATCL_ACK    0x8F
 #define ATCL_NACK   0xA5
 
@@ -61,10 +82,125 @@ enum ATCSErrors {PLUGIN_OK=0, NOT_CONNECTED, ATCS_CANT_CONNECT, ATCS_BAD_CMD_RES
 #define ATCL_IDC_ASYNCH     0x9F
 
 #define ATCS_NB_SLEW_SPEEDS 5
+
+enum OpenLoopAxis {OL_AXIS_RA=0, OL_AXIS_DEC, OL_NB_AXIS};
+#define OL_AXIS_IDLE        -1
+#define OL_RATE_UNKNOWN     -1
+
+// how late the stop of a timed move was sent, in microseconds
+typedef struct {
+    unsigned long   ulMoves;
+    long long       llLastErrorUs;
+    long long       llMaxErrorUs;
+    long long       llTotalErrorUs;
+} TimedMoveStats;
+
+#define NS_DEFAULT_MAX_ERROR    0.5     // arcsec, predicted error that triggers a rate update
+#define NS_DEFAULT_PERIOD_MS    1000    // how often the predicted error is checked
+#define NS_MIN_PERIOD_MS        100
+#define NS_MAX_HORIZON          600     // seconds, longest window a new rate is computed over
+
+// non-sidereal tracking engine
+typedef struct {
+    unsigned long   ulChecks;
+    unsigned long   ulUpdates;          // new rates sent
+    unsigned long   ulErrors;           // failed rate updates
+    double          dMaxErrorArcSec;    // worst open loop error seen at a check
+    double          dRaRate;            // rates currently sent, arcsec/hour
+    double          dDecRate;
+} NonSiderealStats;
+
+#define SAT_MIN_PERIOD_MS       20      // gap left between rate updates for the other commands
+#define SAT_SLEW_POLL_MS        500
+#define SAT_MIN_ALTITUDE        0.0     // degrees, the pass ends below this
+#define SAT_LATENCY_EWMA        0.2
+#define SAT_SLEW_SPEED          2.0     // degrees per second on each axis, to estimate when we can be at the acquisition point
+#define SAT_ACQUISITION_MARGIN  5.0     // seconds for the slew to settle, on top of the estimate
+#define SAT_ACQUISITION_SOLVES  5       // acquisition time / position iterations
+
+// satellite tracking
+typedef struct {
+    unsigned long   ulUpdates;
+    unsigned long   ulErrors;
+    double          dLatencyMs;         // smoothed command to effect latency, used as lead time
+    double          dMaxLatencyMs;
+    double          dUpdateHz;          // average rate update frequency during the pass
+    double          dAcquisitionTime;   // unix time we pick the pass up at
+} SatelliteStats;
+
+// status polls, the freshness of each field (POLL_AGE_xxx) is in its command descriptor
+#define POLL_TICK_MS            100     // fields expiring within this are read along with the one being refreshed
+#define POLL_REG_EXPIRE_MS      5000    // a field nobody asked for in that long is dropped from the batches
+#define POLL_MAX_BATCH          6
+
+typedef struct {
+    unsigned long   ulRequests;
+    unsigned long   ulCacheHits;
+    unsigned long   ulBatches;
+    unsigned long   ulCommands;
+    unsigned long   ulFailedBatches;    // batches where at least one field had to be read again on its own
+} PollStats;
+
+// a command and its arguments, for the batched sends
+typedef struct {
+    ATCLCommandId   nCmd;
+    std::string     sArgs;
+} ATCLRequest;
+
+// one step of a multi-step operation (sync, slew, unpark, ..), run by ATCS::runSteps
+typedef struct {
+    const char              *pszName;
+    std::function<int()>    fnStep;
+} ATCSStep;
+
+// background part of Connect, everything after the ATCL handshake
+typedef struct {
+    size_t      nStep;      // steps done
+    size_t      nSteps;
+    const char  *pszStep;   // step running, or the one that failed
+    int         nErr;
+    bool        bRunning;
+} ConnectProgress;
+
 #define ATCS_SLEW_NAME_LENGHT 12
 #define ATCS_NB_ALIGNEMENT_TYPE 4
 #define ATCS_ALIGNEMENT_NAME_LENGHT 12
 
+#ifdef PLUGIN_DEBUG
+// The log is written from the X2 thread and from the connect, tracking and timed move threads.
+// Each thread formats its lines in its own buffer, flush() appends them to the file under the lock.
+class CLogFile
+{
+public:
+    void    open(const std::string &sPath, std::ios_base::openmode nMode) { std::lock_guard<std::mutex> lock(m_Mutex); m_File.open(sPath, nMode); }
+    bool    is_open() { std::lock_guard<std::mutex> lock(m_Mutex); return m_File.is_open(); }
+    void    close() { std::lock_guard<std::mutex> lock(m_Mutex); m_File.close(); }
+
+    template <typename T>
+    std::ostream&   operator<<(const T &value) { return buffer() << value; }
+    // for the report functions that take a stream
+    std::ostream&   stream() { return buffer(); }
+
+    void    flush()
+    {
+        std::ostringstream &ssLines = buffer();
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_File << ssLines.str();
+        m_File.flush();
+        ssLines.str("");
+    }
+
+private:
+    std::mutex      m_Mutex;
+    std::ofstream   m_File;
+
+    std::ostringstream& buffer()
+    {
+        thread_local std::map<const CLogFile*, std::ostringstream> mBuffers;
+        return mBuffers[this];
+    }
+};
+#endif
 
 // Define Class for Astrometric Instruments ATCS controller.
 class ATCS
@@ -75,11 +211,26 @@ public:
 	
 	int Connect(char *pszPort);
 	int Disconnect();
+    // any thread, doesn't wait for the command mutex : stops Connect in its handshake or the setup at its next step
+    void cancelConnect() { m_nConnectGeneration++; }
+    void getConnectProgress(ConnectProgress &progress);
+    int  waitConnectDone();
+    // X2 thread, writes the snapshot the setup took (or its invalidation) to the ini file
+    void savePendingSnapshot();
 	bool isConnected() const { return m_bIsConnected; }
 
-    void setSerxPointer(SerXInterface *p) { m_pSerx = p; }
+    void setSerxPointer(SerXInterface *p) { m_pSerx = p; m_SerXTransport.setSerxPointer(p); }
     void setTSX(TheSkyXFacadeForDriversInterface *pTSX) { m_pTsx = pTSX;};
     void setSleeper(SleeperInterface *pSleeper) { m_pSleeper = pSleeper;};
+    void setIniUtil(BasicIniUtilInterface *pIniUtil, int nInstanceIndex = 0) { m_pIniUtil = pIniUtil; m_nInstanceIndex = nInstanceIndex; }
+    int  setTransportType(ATCSTransportType nType);
+    ATCSTransportType getTransportType() const { return m_nTransportType; }
+    int  setSharedReactor(bool bEnable);
+    int  setTraceEnabled(bool bEnable);
+    int  flushTrace();
+#ifndef SB_WIN_BUILD
+    int  getTransportLatencyStats(TransportLatencyStats &stats);
+#endif
 
     int getNbSlewRates();
     int getRateName(int nZeroBasedIndex, std::string &sOut);
@@ -90,7 +241,7 @@ public:
     void    setMountMode(MountTypeInterface::Type mountType);
     MountTypeInterface::Type mountType();
 
-    int getRaAndDec(double &dRa, double &dDec);
+    int getRaAndDec(double &dRa, double &dDec, int nMaxAgeMs = POLL_AGE_POSITION);
     int syncTo(double dRa, double dDec);
     int isAligned(bool &bAligned);
     int getAlignementType(std::string &sType);
@@ -107,6 +258,21 @@ public:
 
     int startOpenSlew(const MountDriverInterface::MoveDir Dir, unsigned int nRate);
     int stopOpenLoopMove();
+    int startTimedOpenLoopMove(const MountDriverInterface::MoveDir Dir, unsigned int nRate, int nDurationMs);
+    bool isTimedMoveActive();
+    void getTimedMoveStats(TimedMoveStats &stats);
+
+    int startNonSiderealTracking(const CRateModel &model, double dMaxErrorArcSec = NS_DEFAULT_MAX_ERROR, int nCheckPeriodMs = NS_DEFAULT_PERIOD_MS);
+    void stopNonSiderealTracking();
+    bool isNonSiderealTrackingActive();
+    void getNonSiderealStats(NonSiderealStats &stats);
+
+    int startSatelliteTracking(const std::string &sTLELine1, const std::string &sTLELine2, double dStartTime);
+    void stopSatelliteTracking();
+    bool isSatelliteTrackingActive();
+    void getSatelliteStats(SatelliteStats &stats);
+
+    void getPollStats(PollStats &stats);
 
     int gotoPark(double dRa, double dDEc);
     int markParkPosition();
@@ -117,8 +283,17 @@ public:
     int setRefractionCorrEnabled(bool bEnable);
 
     int getLimits(double &dHoursEast, double &dHoursWest);
+    int getBeyondThePole(bool &bBeyondThePole);
+    double getFlipHourAngle();
+    // local sidereal time engine, ATCS_ERROR until the site longitude is known
+    int getLocalSiderealTime(double &dLst);
+    int getHourAngles(const double *pdRa, double *pdHourAngle, size_t nTargets);
+    // altitude the slew targets must be above, empty path to stop checking
+    int loadHorizonMask(const std::string &sPath);
 
     int Abort();
+    // any thread, doesn't wait for the command mutex : the multi-step operation in progress stops at its next step
+    void requestAbort() { m_nAbortGeneration++; }
 
     int getLocalTimeFormat(bool &b24h);
     int getDateFormat(bool &bDdMmYy);
@@ -140,6 +315,15 @@ private:
     SerXInterface                       *m_pSerx;
     TheSkyXFacadeForDriversInterface    *m_pTsx;
     SleeperInterface                    *m_pSleeper;
+    BasicIniUtilInterface               *m_pIniUtil;
+    int                                 m_nInstanceIndex;   // the snapshot key of this instance
+
+    ATCSTransport                       *m_pTransport;         // what we send/read through
+    ATCSTransport                       *m_pLinkTransport;     // the actual link (SerX, native, ..)
+    SerXTransport                       m_SerXTransport;
+    ATCSTransport                       *m_pNativeTransport;
+    ATCSReactorChannel                  *m_pReactorChannel;
+    ATCSTransportType                   m_nTransportType;
 
     bool    m_bDebugLog;
 	bool    m_bIsConnected;                               // Connected to the mount?
@@ -159,21 +343,171 @@ private:
     bool    m_b24h;
     bool    m_bDdMmYy;
     bool    m_bTimeSetOnce;
-    MountDriverInterface::MoveDir      m_nOpenLoopDir;
-
-    // limits don't change mid-course so we cache them
-    bool    m_bLimitCached;
-    double  m_dHoursEast;
-    double  m_dHoursWest;
+    // open loop moves, each axis is tracked separately so a diagonal move can be stopped
+    std::mutex  m_OpenLoopMutex;
+    int         m_nOpenLoopAxisDir[OL_NB_AXIS];     // MoveDir or OL_AXIS_IDLE
+    int         m_nOpenLoopRate;                    // rate currently selected on the controller
+
+    // one command/response exchange at a time, the connect and tracking threads also send commands.
+    // Locked at the priority of the command (ATCLCommandDesc::nPriority)
+    CATCLCommandLock    m_CommandMutex;
+    // bytes received after the end of the last reply (pipelined replies)
+    char            m_szRxPending[SERIAL_BUFFER_SIZE];
+    unsigned long   m_ulRxPendingLen;
+    unsigned long   m_ulRxStart;        // pending bytes start here, the last frame handed out is in front of them
+    bool            m_bRxResyncNeeded;  // a reply timed out, drop stale bytes before the next command
+    int             m_nRxLateFrames;    // replies that timed out and may still arrive
+    int64_t         m_nRxLateDueNs;     // when the last of them is due under its default timeout
+    CCommandTimeouts    m_CommandTimeouts;
+    // per-connection scratch, cleared but never released between transactions so the
+    // steady-state status reads don't go to the heap
+    std::string                 m_sTxBuffer;    // command or batch being written, under m_CommandMutex
+    std::vector<ATCLRequest>    m_vPollCmds;    // pollRead batch, under m_PollMutex
+    std::vector<std::string>    m_svPollResp;
+    std::vector<int>            m_nvPollErr;
+    // arguments of the last setter the controller accepted, so repeated identical sets are skipped
+    std::map<ATCLCommandId, std::string>    m_mSetterShadow;
+    std::mutex                          m_SetterShadowMutex;   // the non-sidereal thread also sends setters
+    // setters on the way, for each command. Two sends of the same setter overlapping leave its shadow unknown
+    int                                 m_nSetterInFlight[ATCL_NB_COMMANDS];
+    bool                                m_bSetterConflict[ATCL_NB_COMMANDS];
+    // bumped by every send or invalidation of a setter, a value read back from before that is not recorded
+    unsigned int                        m_nSetterSeq[ATCL_NB_COMMANDS];
+    // sync and slew set the controller's target then act on it, one of them at a time.
+    // The X2 mutex isn't held across them so the status polls go on while they run.
+    // Also held to start or stop the non-sidereal and satellite threads, they never take it themselves
+    std::mutex                          m_TargetMutex;
+    std::atomic<int64_t>                m_nSlewStartNs;     // CSteadyTimer::NowNs() of the last GTRN
+
+    // timed open loop moves, the stop is sent by m_TimedMoveThread at m_TimedMoveDeadline
+    std::thread                 m_TimedMoveThread;
+    std::mutex                  m_TimedMoveMutex;
+    std::condition_variable     m_cvTimedMove;
+    bool                        m_bTimedMoveThreadRunning;
+    bool                        m_bTimedMovePending;
+    unsigned int                m_nTimedMoveId;
+    std::chrono::steady_clock::time_point   m_TimedMoveDeadline;
+    TimedMoveStats              m_TimedMoveStats;
+
+    // non-sidereal tracking, m_NonSiderealThread updates the custom rates from m_NonSiderealModel
+    std::thread                 m_NonSiderealThread;
+    std::mutex                  m_NonSiderealMutex;
+    std::condition_variable     m_cvNonSidereal;
+    bool                        m_bNonSiderealRunning;
+    CRateModel                  m_NonSiderealModel;
+    double                      m_dNonSiderealMaxError;
+    int                         m_nNonSiderealPeriodMs;
+    NonSiderealStats            m_NonSiderealStats;
+
+    // satellite tracking, m_SatelliteThread streams the rates computed by m_SatellitePredictor
+    std::thread                 m_SatelliteThread;
+    std::mutex                  m_SatelliteMutex;
+    std::condition_variable     m_cvSatellite;
+    bool                        m_bSatelliteRunning;
+    CSatellitePredictor         m_SatellitePredictor;
+    double                      m_dSatelliteStart;
+    SatelliteStats              m_SatelliteStats;
+
+    // every periodic status read goes through pollRead, stale fields are refreshed together in one batch
+    typedef struct {
+        std::string     sResp;
+        bool            bValid;
+        unsigned int    nGeneration;    // m_nPollGeneration when read
+        int             nMaxAgeMs;      // tightest freshness asked for since the registration was renewed
+        std::chrono::steady_clock::time_point   tRead;
+        std::chrono::steady_clock::time_point   tLastRequest;
+    } PollField;
+    std::map<ATCLCommandId, PollField>  m_mPollFields;
+    std::mutex                          m_PollMutex;
+    std::atomic<unsigned int>           m_nPollGeneration;     // bumped by every command that can change the mount state
+    PollStats                           m_PollStats;
+
+    // bumped by requestAbort(), a sequence started under another value stops before its next step
+    std::atomic<unsigned int>           m_nAbortGeneration;
+
+    // Connect returns once the controller answers, m_ConnectThread runs the rest of the setup
+    std::thread                 m_ConnectThread;
+    std::mutex                  m_ConnectMutex;
+    std::condition_variable     m_cvConnect;
+    ConnectProgress             m_ConnectProgress;
+    std::string                 m_sConnectPort;
+    std::atomic<unsigned int>   m_nConnectGeneration;  // bumped by cancelConnect()
+
+    // limits and pier side, read once per connection (or taken from the snapshot) and refreshed from the position reads
+    CPierSideModel                          m_PierSide;
+    CSlewLimits                             m_SlewLimits;       // same limits, the site latitude and the horizon mask
+    std::mutex                              m_PierSideMutex;
+    std::chrono::steady_clock::time_point   m_tPierSideRead;
+    // site longitude, read at connect or set by setSiteData
+    CSiderealClock                          m_SiderealClock;
+    std::mutex                              m_SiderealMutex;
+
+    // controller state from the last session, a warm connect uses it when the fingerprint still matches
+    ControllerSnapshot  m_Snapshot;
+    // taken by m_ConnectThread, saved by savePendingSnapshot() as the ini file belongs to the X2 thread. Under m_ConnectMutex
+    ControllerSnapshot  m_PendingSnapshot;
+    std::atomic<bool>   m_bSnapshotPending;
     
-    int     ATCSSendCommand(const std::string sCmd, std::string &sResp, int nTimeout = MAX_TIMEOUT);
-    int     ATCSreadResponse(std::string &sResult, int nTimeout = MAX_TIMEOUT);
+    int     ATCSSendCommand(ATCLCommandId nCmd, std::string &sResp, int nTimeout = ADAPTIVE_TIMEOUT);
+    int     ATCSSendCommand(ATCLCommandId nCmd, const std::string &sArgs, std::string &sResp, int nTimeout = ADAPTIVE_TIMEOUT);
+    int     ATCSSendCommand(ATCLCommandId nCmd, const ATCLResponseParser &fnParse, int nTimeout = ADAPTIVE_TIMEOUT);
+    int     ATCSSendCommand(ATCLCommandId nCmd, const std::string &sArgs, const ATCLResponseParser &fnParse, int nTimeout = ADAPTIVE_TIMEOUT);
+    int     sendCommandLocked(ATCLCommandId nCmd, const std::string &sArgs, ATCLResponseView &resp, int nTimeout);
+    int     ATCSSendCommands(const std::vector<ATCLRequest> &vCmds, std::vector<std::string> &svResp, int nTimeout = ADAPTIVE_TIMEOUT, std::vector<int> *pnvErr = NULL);
+    int     pollRead(ATCLCommandId nCmd, std::string &sResp, int nMaxAgeMs = POLL_AGE_DEFAULT, bool *pbFromLink = NULL);
+    int     pollRead(ATCLCommandId nCmd, const ATCLResponseParser &fnParse, int nMaxAgeMs = POLL_AGE_DEFAULT, bool *pbFromLink = NULL);
+    int     ATCSSendSetter(ATCLCommandId nCmd, const std::string &sArgs, std::string &sResp);
+    unsigned int    setterShadowSeq(ATCLCommandId nCmd);
+    void    updateSetterShadow(ATCLCommandId nCmd, const std::string &sArgs, unsigned int nSeq);
+    void    invalidateSetterShadow();
+    void    invalidateSetterShadow(ATCLCommandId nCmd);
+    int     ATCSwaitCommandResponse(ATCLResponseView &resp, int nTimeout = MAX_TIMEOUT);
+    int     ATCSreadResponse(ATCLResponseView &resp, int nTimeout = MAX_TIMEOUT);
+    int     purgeRx();
+    void    resyncRxIfNeeded(bool bWaitLateReplies = true, bool bPartialFrame = false);
+    void    expectLateReply(ATCLCommandId nCmd, int64_t nSendNs);
+    int     runSteps(const char *pszOperation, const std::vector<ATCSStep> &steps);
+    int     runSteps(const char *pszOperation, const std::vector<ATCSStep> &steps, const std::atomic<unsigned int> &nCancelGeneration, unsigned int nGeneration, const std::function<void(size_t)> &fnProgress);
+#ifdef ATCS_PROBES_ENABLED
+    void    probeCommandDone(ATCLCommandId nCmd, int64_t nSendNs, int nErr);
+#endif
 
     int     atclEnter();
+    void    connectThread(unsigned int nGeneration);
+    void    stopConnectThread();
+    int     readConnectState(const char *pszPort, bool &bWarm, bool &bIsParked, bool &bIsAligned);
+    int     takeSnapshot(const char *pszPort);
+    void    queueSnapshot(const ControllerSnapshot &snapshot);
     int     disablePacketSeqChecking();
     int     disableStaticStatusChangeNotification();
     int     checkSiteTimeDateSetOnce(bool &bSet);
 
+    void    resetOpenLoopState();
+    int     sendOpenLoopStop();
+
+    void    timedMoveThread();
+    void    cancelTimedMove();
+    int     stopTimedOpenLoopMove(unsigned int nId, bool &bStopped);
+    void    stopTimedMoveThread();
+
+    void    nonSiderealThread();
+    int     sendNonSiderealRates(double dRaRate, double dDecRate);
+    static double unixTimeNow();
+
+    void    satelliteThread();
+    int     satelliteAcquisition(double dStartTime, double &dAcquisitionTime, double &dRa, double &dDec, double &dAltitude);
+    int     isSlewToComplete(bool &bComplete, int64_t nSlewStartNs);
+
+    void    setLimitAnglesLocked(double dEastAngle, double dWestAngle);
+    int     checkSlewTarget(double dRa, double dDec);
+    int     slewToLocked(double dRa, double dDec);
+    void    stopNonSiderealTrackingLocked();
+    void    stopSatelliteTrackingLocked();
+    void    pierSideTargetSet(double dRa);
+    void    pierSidePositionRead(double dRa);
+    int     refreshPierSideModel();
+    double  localHourAngle(double dRa);
+
     int     getUsingSiteNumber(int &nSiteNb);
     int     getUsingSiteName(int nSiteNb, std::string &sSiteName);
     int     setSiteLongitude(int nSiteNb, const std::string sLongitude);
@@ -181,6 +515,8 @@ private:
     int     setSiteTimezone(int nSiteNb, const std::string sTimezone);
 
     int     getSiteLongitude(int nSiteNb, std::string &sLongitude);
+    void    cacheSiteLongitude(const std::string &sLongitude);
+    void    cacheSiteLatitude(const std::string &sLatitude);
     int     getSiteLatitude(int nSiteNb, std::string &sLatitude);
     int     getSiteTZ(int nSiteNb, std::string &sTimeZone);
 
@@ -205,15 +541,10 @@ private:
 
     void    convertDecDegToDDMMSS(double dDeg, std::string  &sResult, char &cSign);
 
-    int     convertDDMMSSToDecDeg(const std::string StrDeg, double &dDecDeg);
-
     void    convertRaToHHMMSSt(double dRa, std::string &sResult);
 
-    int     convertHHMMSStToRa(const std::string StrRa, double &dRa);
-    int     parseFields(const std::string szIn, std::vector<std::string> &svFields, char cSeparator);
-
     std::vector<std::string>    m_svSlewRateNames = { "ViewVel 1", "ViewVel 2", "ViewVel 3", "ViewVel 4",  "Slew"};
-    CStopWatch      timer;
+    CSteadyTimer    timer;
 
 
     std::string&    trim(std::string &str, const std::string &filter );
@@ -223,7 +554,7 @@ private:
 
 #ifdef PLUGIN_DEBUG
     const std::string getTimeStamp();
-    std::ofstream m_sLogFile;
+    CLogFile m_sLogFile;
     std::string m_sLogfilePath;
 #endif
 	
@@ -0,0 +1,83 @@
+#include "ATCSCommandTimeouts.h"
+
+#include <string.h>
+
+// C++ includes
+#include <algorithm>
+
+CCommandTimeouts::CCommandTimeouts()
+{
+    reset();
+}
+
+void CCommandTimeouts::reset()
+{
+    int i;
+
+    memset(m_Commands, 0, sizeof(m_Commands));
+    for(i = 0; i < ATCL_NB_COMMANDS; i++)
+        m_Commands[i].nTimeoutMs = atclCommand((ATCLCommandId)i).nTimeoutMs;
+}
+
+void CCommandTimeouts::recordLatency(ATCLCommandId nCmd, int64_t nLatencyNs)
+{
+    CommandLatency &cmd = m_Commands[nCmd];
+
+    if(!atclIsQuery(nCmd))
+        return;
+    cmd.nLatencyUs[cmd.nNext] = (int)std::min<int64_t>(nLatencyNs / 1000, CMD_TIMEOUT_CEILING * 1000);
+    cmd.nNext = (cmd.nNext + 1) % CMD_LATENCY_WINDOW;
+    if(cmd.nNbSamples < CMD_LATENCY_WINDOW)
+        cmd.nNbSamples++;
+
+    cmd.nSinceRecompute++;
+    if(cmd.nNbSamples >= CMD_LATENCY_MIN_SAMPLES && (cmd.nSinceRecompute >= CMD_LATENCY_RECOMPUTE || !cmd.nLearnedMs))
+        recompute(cmd);
+}
+
+// a timeout means our estimate might be too tight, back off until the next recompute
+void CCommandTimeouts::recordTimeout(ATCLCommandId nCmd)
+{
+    CommandLatency &cmd = m_Commands[nCmd];
+
+    if(!atclIsQuery(nCmd))
+        return;
+    cmd.nTimeoutMs = std::min(cmd.nTimeoutMs * 2, CMD_TIMEOUT_CEILING);
+    cmd.nSinceRecompute = 0;
+}
+
+// A retry follows a reply that was lost or cut short, the controller itself is as fast as usual.
+// So it only waits a few times the median latency, never longer than the first attempt did.
+int CCommandTimeouts::retryTimeoutFor(ATCLCommandId nCmd, int nTimeout) const
+{
+    const CommandLatency &cmd = m_Commands[nCmd];
+    int nRetryMs;
+
+    if(cmd.nP50Us)
+        nRetryMs = std::max(CMD_TIMEOUT_FLOOR, (cmd.nP50Us * CMD_RETRY_P50_FACTOR) / 1000);
+    else
+        nRetryMs = CMD_RETRY_TIMEOUT_UNLEARNED;
+    return std::min(nRetryMs, nTimeout);
+}
+
+void CCommandTimeouts::recompute(CommandLatency &cmd)
+{
+    size_t nSamples = (size_t)cmd.nNbSamples;
+    size_t nP99;
+    size_t nP50;
+
+    memcpy(m_nSortScratch, cmd.nLatencyUs, nSamples * sizeof(int));
+    nP99 = (nSamples * 99) / 100;
+    if(nP99 >= nSamples)
+        nP99 = nSamples - 1;
+    std::nth_element(m_nSortScratch, m_nSortScratch + nP99, m_nSortScratch + nSamples);
+    // everything below p99 is already on its left
+    nP50 = nSamples / 2;
+    std::nth_element(m_nSortScratch, m_nSortScratch + nP50, m_nSortScratch + nP99);
+    cmd.nP50Us = std::max(m_nSortScratch[nP50], 1);
+
+    cmd.nLearnedMs = (m_nSortScratch[nP99] * CMD_TIMEOUT_P99_FACTOR) / 1000;
+    cmd.nLearnedMs = std::max(CMD_TIMEOUT_FLOOR, std::min(cmd.nLearnedMs, CMD_TIMEOUT_CEILING));
+    cmd.nTimeoutMs = cmd.nLearnedMs;
+    cmd.nSinceRecompute = 0;
+}
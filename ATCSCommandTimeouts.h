@@ -0,0 +1,46 @@
+#pragma once
+#include <stdint.h>
+
+#include "ATCSCommands.h"
+
+#define CMD_TIMEOUT_FLOOR           50      // ms
+#define CMD_TIMEOUT_CEILING         1000    // ms
+#define CMD_TIMEOUT_P99_FACTOR      3       // timeout = factor * p99
+#define CMD_LATENCY_WINDOW          128     // samples kept per command
+#define CMD_LATENCY_MIN_SAMPLES     16      // before we trust the measured p99
+#define CMD_LATENCY_RECOMPUTE       16      // recompute p99 every n samples
+#define CMD_RETRY_P50_FACTOR        4       // retry timeout = factor * p50
+#define CMD_RETRY_TIMEOUT_UNLEARNED 100     // ms, retry timeout until we have measured the command
+
+// Per command read timeout learned from the observed reply latency.
+// One slot per ATCLCommandId, starting from the descriptor's default timeout.
+// Only queries learn, a setter or a motion that times out on a late ACK would be reported as failed
+// while the controller did execute it, so they keep their default timeout.
+// Not thread safe, used under the ATCS command mutex.
+class CCommandTimeouts
+{
+public:
+    CCommandTimeouts();
+
+    int     timeoutFor(ATCLCommandId nCmd) const { return m_Commands[nCmd].nTimeoutMs; }
+    int     retryTimeoutFor(ATCLCommandId nCmd, int nTimeout) const;
+    void    recordLatency(ATCLCommandId nCmd, int64_t nLatencyNs);
+    void    recordTimeout(ATCLCommandId nCmd);
+    void    reset();
+
+private:
+    typedef struct {
+        int         nLatencyUs[CMD_LATENCY_WINDOW];
+        int         nNbSamples;
+        int         nNext;
+        int         nSinceRecompute;
+        int         nTimeoutMs;     // current timeout
+        int         nLearnedMs;     // from p99, 0 until we have enough samples
+        int         nP50Us;         // median latency, 0 until we have enough samples
+    } CommandLatency;
+
+    CommandLatency  m_Commands[ATCL_NB_COMMANDS];
+    int             m_nSortScratch[CMD_LATENCY_WINDOW];    // p50 and p99 are selected in here, the window keeps its order
+
+    void            recompute(CommandLatency &cmd);
+};
@@ -0,0 +1,180 @@
+#include "ATCSCommands.h"
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <math.h>
+
+std::string atclFormat(ATCLCommandId nCmd, const std::string &sArgs)
+{
+    std::string sCmd;
+
+    sCmd.reserve(atclMnemonicLength(nCmd) + sArgs.size() + 2);
+    atclAppend(sCmd, nCmd, sArgs);
+    return sCmd;
+}
+
+void atclAppend(std::string &sOut, ATCLCommandId nCmd, const std::string &sArgs)
+{
+    if(nCmd == ATCL_CMD_ENTER) {
+        sOut += (char)ATCL_ENTER;
+        return;
+    }
+    sOut += '!';
+    sOut.append(atclMnemonic(nCmd), atclMnemonicLength(nCmd));
+    sOut += sArgs;
+    sOut += ';';
+}
+
+std::string atclNumber(double dValue, int nDecimals)
+{
+    char szValue[64];
+
+    snprintf(szValue, sizeof(szValue), "%.*f", nDecimals, dValue);
+    return std::string(szValue);
+}
+
+std::string atclSite(int nSiteNb, const std::string &sValue)
+{
+    return std::to_string(nSiteNb) + sValue;
+}
+
+bool atclParseNumber(const char *pszResp, double &dValue)
+{
+    char *pszEnd;
+
+    dValue = strtod(pszResp, &pszEnd);
+    return pszEnd != pszResp;
+}
+
+bool atclParseInteger(const char *pszResp, int &nValue)
+{
+    char *pszEnd;
+
+    nValue = (int)strtol(pszResp, &pszEnd, 10);
+    return pszEnd != pszResp;
+}
+
+bool atclParseYesNo(const char *pszResp, bool &bYes)
+{
+    if(strncmp(pszResp, "Yes", 3) == 0) {
+        bYes = true;
+        return true;
+    }
+    bYes = false;
+    return strncmp(pszResp, "No", 2) == 0;
+}
+
+bool atclIsNotAvailable(const char *pszResp)
+{
+    return strstr(pszResp, "N/A") != NULL;
+}
+
+// parsed in place, the sign applies to the whole value ("-00:30:00" is -0.5)
+bool atclParseSexagesimal(const char *pszResp, double &dValue)
+{
+    const char *pszField = pszResp;
+    char *pszEnd;
+    double dFields[3];
+    bool bNegative;
+
+    dValue = 0;
+    while(*pszField == ' ')
+        pszField++;
+    bNegative = (*pszField == '-');
+    if(*pszField == '-' || *pszField == '+')
+        pszField++;
+
+    for(int i = 0; i < 3; i++) {
+        dFields[i] = strtod(pszField, &pszEnd);
+        if(pszEnd == pszField)
+            return false;
+        if(i < 2) {
+            if(*pszEnd != ':')
+                return false;
+            pszField = pszEnd + 1;
+        }
+    }
+
+    dValue = dFields[0] + dFields[1]/60.0 + dFields[2]/3600.0;
+    if(bNegative)
+        dValue = -dValue;
+    return true;
+}
+
+bool atclParseSiteAngle(const char *pszResp, double &dValue)
+{
+    size_t nLen;
+
+    if(!atclParseSexagesimal(pszResp, dValue))
+        return false;
+    nLen = strlen(pszResp);
+    while(nLen && pszResp[nLen-1] == ' ')
+        nLen--;
+    if(nLen && strchr("SsWw", pszResp[nLen-1]))
+        dValue = -fabs(dValue);
+    return true;
+}
+
+bool atclResponseValid(ATCLCommandId nCmd, const char *pszResp)
+{
+    double dValue;
+    int nValue;
+    bool bYes;
+
+    switch(atclCommand(nCmd).nResponse) {
+        case ATCL_RESP_NUMBER:
+            return atclParseNumber(pszResp, dValue) || atclIsNotAvailable(pszResp);
+        case ATCL_RESP_INTEGER:
+            return atclParseInteger(pszResp, nValue);
+        case ATCL_RESP_YESNO:
+            return atclParseYesNo(pszResp, bYes);
+        case ATCL_RESP_SEXAGESIMAL:
+            return atclParseSexagesimal(pszResp, dValue) || atclIsNotAvailable(pszResp);
+        case ATCL_RESP_SITE_ANGLE:
+            return atclParseSiteAngle(pszResp, dValue);
+        default:
+            // ACK/NACK is sorted out by the reply reader, text is taken as is
+            return true;
+    }
+}
+
+#pragma mark - CATCLCommandLock
+
+CATCLCommandLock::CATCLCommandLock()
+{
+    m_bBusy = false;
+    for(int i = 0; i < ATCL_NB_PRIORITIES; i++) {
+        m_nWaiting[i] = 0;
+        m_Levels[i].m_pOwner = this;
+        m_Levels[i].m_nPriority = (ATCLPriority)i;
+    }
+}
+
+void CATCLCommandLock::lock(ATCLPriority nPriority)
+{
+    std::unique_lock<std::mutex> lock(m_Mutex);
+
+    m_nWaiting[nPriority]++;
+    m_cvFree.wait(lock, [this, nPriority] {
+        if(m_bBusy)
+            return false;
+        for(int i = nPriority + 1; i < ATCL_NB_PRIORITIES; i++) {
+            if(m_nWaiting[i])
+                return false;
+        }
+        return true;
+    });
+    m_nWaiting[nPriority]--;
+    m_bBusy = true;
+}
+
+void CATCLCommandLock::unlock()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_Mutex);
+        m_bBusy = false;
+    }
+    // every waiter checks, only the highest priority one goes
+    m_cvFree.notify_all();
+}
@@ -0,0 +1,248 @@
+#pragma once
+#include <stddef.h>
+
+// C++ includes
+#include <string>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+
+#define ATCL_ENTER  0xB1
+
+#define CMD_TIMEOUT_QUERY_DEFAULT   250     // ms, queries until we have measured them
+#define CMD_TIMEOUT_DEFAULT         1000    // ms, everything else (setters, motion, ATCL enter)
+
+// status polls, how old a cached reply may be for each kind of field (ms)
+#define POLL_AGE_DEFAULT        0       // whatever the command descriptor says
+#define POLL_AGE_POSITION       250
+#define POLL_AGE_CACHED         1000    // TheSkyX said a cached position is fine
+#define POLL_AGE_SLEW           250
+#define POLL_AGE_PARK           1000
+#define POLL_AGE_ALIGNMENT      2000
+#define POLL_AGE_TRACKING       2000
+#define POLL_AGE_UI             1000
+
+// every ATCL command the driver sends, in g_ATCLCommands order
+enum ATCLCommandId {
+    ATCL_CMD_ENTER = 0,
+    // session
+    ATCL_CMD_QDCN, ATCL_CMD_QDPS, ATCL_CMD_QSAU,
+    // hardware
+    ATCL_CMD_HGFV, ATCL_CMD_HGSM, ATCL_CMD_HGTF,
+    // coordinates
+    ATCL_CMD_CGRA, ATCL_CMD_CGDE, ATCL_CMD_CSTR, ATCL_CMD_CSTD,
+    // alignment, sync and park position
+    ATCL_CMD_AGAS, ATCL_CMD_AGAK, ATCL_CMD_ACRN, ATCL_CMD_ACRD, ATCL_CMD_ACST,
+    ATCL_CMD_AFCS, ATCL_CMD_AFCN, ATCL_CMD_AFLP, ATCL_CMD_AMPP,
+    // mount configuration and limits
+    ATCL_CMD_NGAT, ATCL_CMD_NSAT, ATCL_CMD_NGAM, ATCL_CMD_NSAM, ATCL_CMD_NGLE, ATCL_CMD_NGLW,
+    // tracking
+    ATCL_CMD_RGTR, ATCL_CMD_RSTR, ATCL_CMD_RGOR, ATCL_CMD_RSOR, ATCL_CMD_RGOD, ATCL_CMD_RSOD,
+    // goto and park
+    ATCL_CMD_GTRN, ATCL_CMD_GGGR, ATCL_CMD_GTOP,
+    // open loop moves
+    ATCL_CMD_KSSL, ATCL_CMD_KCSL, ATCL_CMD_KSCV, ATCL_CMD_KSPU, ATCL_CMD_KSPD, ATCL_CMD_KSPL, ATCL_CMD_KSSR,
+    // stops
+    ATCL_CMD_XXUD, ATCL_CMD_XXLR, ATCL_CMD_XXXX,
+    // pointing corrections
+    ATCL_CMD_PGRE, ATCL_CMD_PSRE, ATCL_CMD_PSEP,
+    // site
+    ATCL_CMD_SGUU, ATCL_CMD_SGUN, ATCL_CMD_SSO, ATCL_CMD_SSA, ATCL_CMD_SSZ, ATCL_CMD_SGO, ATCL_CMD_SGA, ATCL_CMD_SGZ,
+    // time and date
+    ATCL_CMD_TGLF, ATCL_CMD_TGDF, ATCL_CMD_TGST, ATCL_CMD_TGSD, ATCL_CMD_TSST, ATCL_CMD_TSSD,
+    ATCL_NB_COMMANDS
+};
+
+// what a command does to the controller, this decides retries, caching and the status poll invalidation
+enum ATCLCommandClass {
+    ATCL_CLASS_QUERY = 0,   // read only, safe to resend and to cache
+    ATCL_CLASS_SETTER,      // changes a setting, identical sets can be skipped
+    ATCL_CLASS_ACTION,      // sync, align, clock set.. never resent
+    ATCL_CLASS_MOTION,      // starts or stops the mount moving
+    ATCL_CLASS_SESSION      // link and protocol setup
+};
+
+// what the reply holds, a status poll reply that doesn't parse as its type is not cached
+enum ATCLResponseType {
+    ATCL_RESP_ACK = 0,          // the ACK/NACK byte
+    ATCL_RESP_TEXT,             // free text, anything goes
+    ATCL_RESP_NUMBER,
+    ATCL_RESP_INTEGER,          // trailing unit allowed ("nn%")
+    ATCL_RESP_YESNO,
+    ATCL_RESP_SEXAGESIMAL,      // or "N/A" before alignment
+    ATCL_RESP_SITE_ANGLE
+};
+
+// who goes first when several threads wait for the link, highest first
+enum ATCLPriority {
+    ATCL_PRIO_POLL = 0,         // status reads
+    ATCL_PRIO_CONTROL,          // setters, actions, motion, rate updates
+    ATCL_PRIO_STOP,             // stops, ahead of anything queued
+    ATCL_NB_PRIORITIES
+};
+
+typedef struct {
+    ATCLCommandId       nId;
+    const char          *pszMnemonic;   // what goes between the '!' and the arguments
+    ATCLCommandClass    nClass;
+    ATCLResponseType    nResponse;
+    ATCLPriority        nPriority;
+    int                 nTimeoutMs;     // until the adaptive timeout has enough samples
+    int                 nPollAgeMs;     // freshness of the cached reply for status polls, 0 if not polled
+} ATCLCommandDesc;
+
+static constexpr ATCLCommandDesc g_ATCLCommands[ATCL_NB_COMMANDS] = {
+    {ATCL_CMD_ENTER,    "",     ATCL_CLASS_SESSION, ATCL_RESP_TEXT,        ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_QDCN,     "QDcn", ATCL_CLASS_SESSION, ATCL_RESP_TEXT,        ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_QDPS,     "QDps", ATCL_CLASS_SESSION, ATCL_RESP_TEXT,        ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_QSAU,     "QSau", ATCL_CLASS_SESSION, ATCL_RESP_TEXT,        ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+
+    {ATCL_CMD_HGFV,     "HGfv", ATCL_CLASS_QUERY,   ATCL_RESP_TEXT,        ATCL_PRIO_POLL,    CMD_TIMEOUT_QUERY_DEFAULT,  0},
+    {ATCL_CMD_HGSM,     "HGsm", ATCL_CLASS_QUERY,   ATCL_RESP_TEXT,        ATCL_PRIO_POLL,    CMD_TIMEOUT_QUERY_DEFAULT,  0},
+    {ATCL_CMD_HGTF,     "HGtf", ATCL_CLASS_QUERY,   ATCL_RESP_TEXT,        ATCL_PRIO_POLL,    CMD_TIMEOUT_QUERY_DEFAULT,  POLL_AGE_UI},
+
+    {ATCL_CMD_CGRA,     "CGra", ATCL_CLASS_QUERY,   ATCL_RESP_SEXAGESIMAL, ATCL_PRIO_POLL,    CMD_TIMEOUT_QUERY_DEFAULT,  POLL_AGE_POSITION},
+    {ATCL_CMD_CGDE,     "CGde", ATCL_CLASS_QUERY,   ATCL_RESP_SEXAGESIMAL, ATCL_PRIO_POLL,    CMD_TIMEOUT_QUERY_DEFAULT,  POLL_AGE_POSITION},
+    {ATCL_CMD_CSTR,     "CStr", ATCL_CLASS_SETTER,  ATCL_RESP_ACK,         ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_CSTD,     "CStd", ATCL_CLASS_SETTER,  ATCL_RESP_ACK,         ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+
+    {ATCL_CMD_AGAS,     "AGas", ATCL_CLASS_QUERY,   ATCL_RESP_TEXT,        ATCL_PRIO_POLL,    CMD_TIMEOUT_QUERY_DEFAULT,  POLL_AGE_ALIGNMENT},
+    {ATCL_CMD_AGAK,     "AGak", ATCL_CLASS_QUERY,   ATCL_RESP_YESNO,       ATCL_PRIO_POLL,    CMD_TIMEOUT_QUERY_DEFAULT,  POLL_AGE_PARK},
+    {ATCL_CMD_ACRN,     "ACrn", ATCL_CLASS_ACTION,  ATCL_RESP_TEXT,        ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_ACRD,     "ACrd", ATCL_CLASS_ACTION,  ATCL_RESP_TEXT,        ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_ACST,     "ACst", ATCL_CLASS_ACTION,  ATCL_RESP_YESNO,       ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_AFCS,     "AFcs", ATCL_CLASS_ACTION,  ATCL_RESP_TEXT,        ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_AFCN,     "AFcn", ATCL_CLASS_ACTION,  ATCL_RESP_TEXT,        ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_AFLP,     "AFlp", ATCL_CLASS_ACTION,  ATCL_RESP_TEXT,        ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_AMPP,     "AMpp", ATCL_CLASS_ACTION,  ATCL_RESP_TEXT,        ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+
+    {ATCL_CMD_NGAT,     "NGat", ATCL_CLASS_QUERY,   ATCL_RESP_TEXT,        ATCL_PRIO_POLL,    CMD_TIMEOUT_QUERY_DEFAULT,  0},
+    {ATCL_CMD_NSAT,     "NSat", ATCL_CLASS_SETTER,  ATCL_RESP_ACK,         ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_NGAM,     "NGam", ATCL_CLASS_QUERY,   ATCL_RESP_TEXT,        ATCL_PRIO_POLL,    CMD_TIMEOUT_QUERY_DEFAULT,  0},
+    {ATCL_CMD_NSAM,     "NSam", ATCL_CLASS_SETTER,  ATCL_RESP_ACK,         ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_NGLE,     "NGle", ATCL_CLASS_QUERY,   ATCL_RESP_NUMBER,      ATCL_PRIO_POLL,    CMD_TIMEOUT_QUERY_DEFAULT,  0},
+    {ATCL_CMD_NGLW,     "NGlw", ATCL_CLASS_QUERY,   ATCL_RESP_NUMBER,      ATCL_PRIO_POLL,    CMD_TIMEOUT_QUERY_DEFAULT,  0},
+
+    {ATCL_CMD_RGTR,     "RGtr", ATCL_CLASS_QUERY,   ATCL_RESP_TEXT,        ATCL_PRIO_POLL,    CMD_TIMEOUT_QUERY_DEFAULT,  POLL_AGE_TRACKING},
+    {ATCL_CMD_RSTR,     "RStr", ATCL_CLASS_SETTER,  ATCL_RESP_ACK,         ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_RGOR,     "RGor", ATCL_CLASS_QUERY,   ATCL_RESP_NUMBER,      ATCL_PRIO_POLL,    CMD_TIMEOUT_QUERY_DEFAULT,  POLL_AGE_TRACKING},
+    {ATCL_CMD_RSOR,     "RSor", ATCL_CLASS_SETTER,  ATCL_RESP_ACK,         ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_RGOD,     "RGod", ATCL_CLASS_QUERY,   ATCL_RESP_NUMBER,      ATCL_PRIO_POLL,    CMD_TIMEOUT_QUERY_DEFAULT,  POLL_AGE_TRACKING},
+    {ATCL_CMD_RSOD,     "RSod", ATCL_CLASS_SETTER,  ATCL_RESP_ACK,         ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+
+    {ATCL_CMD_GTRN,     "GTrn", ATCL_CLASS_MOTION,  ATCL_RESP_TEXT,        ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_GGGR,     "GGgr", ATCL_CLASS_QUERY,   ATCL_RESP_INTEGER,     ATCL_PRIO_POLL,    CMD_TIMEOUT_QUERY_DEFAULT,  POLL_AGE_SLEW},
+    {ATCL_CMD_GTOP,     "GTop", ATCL_CLASS_MOTION,  ATCL_RESP_TEXT,        ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+
+    {ATCL_CMD_KSSL,     "KSsl", ATCL_CLASS_SETTER,  ATCL_RESP_ACK,         ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_KCSL,     "KCsl", ATCL_CLASS_SETTER,  ATCL_RESP_ACK,         ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_KSCV,     "KScv", ATCL_CLASS_SETTER,  ATCL_RESP_ACK,         ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_KSPU,     "KSpu", ATCL_CLASS_MOTION,  ATCL_RESP_ACK,         ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_KSPD,     "KSpd", ATCL_CLASS_MOTION,  ATCL_RESP_ACK,         ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_KSPL,     "KSpl", ATCL_CLASS_MOTION,  ATCL_RESP_ACK,         ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_KSSR,     "KSsr", ATCL_CLASS_MOTION,  ATCL_RESP_ACK,         ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+
+    {ATCL_CMD_XXUD,     "XXud", ATCL_CLASS_MOTION,  ATCL_RESP_ACK,         ATCL_PRIO_STOP,    CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_XXLR,     "XXlr", ATCL_CLASS_MOTION,  ATCL_RESP_ACK,         ATCL_PRIO_STOP,    CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_XXXX,     "XXxx", ATCL_CLASS_MOTION,  ATCL_RESP_ACK,         ATCL_PRIO_STOP,    CMD_TIMEOUT_DEFAULT,        0},
+
+    {ATCL_CMD_PGRE,     "PGre", ATCL_CLASS_QUERY,   ATCL_RESP_YESNO,       ATCL_PRIO_POLL,    CMD_TIMEOUT_QUERY_DEFAULT,  0},
+    {ATCL_CMD_PSRE,     "PSre", ATCL_CLASS_SETTER,  ATCL_RESP_ACK,         ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_PSEP,     "PSep", ATCL_CLASS_SETTER,  ATCL_RESP_ACK,         ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+
+    {ATCL_CMD_SGUU,     "SGuu", ATCL_CLASS_QUERY,   ATCL_RESP_INTEGER,     ATCL_PRIO_POLL,    CMD_TIMEOUT_QUERY_DEFAULT,  0},
+    {ATCL_CMD_SGUN,     "SGun", ATCL_CLASS_QUERY,   ATCL_RESP_TEXT,        ATCL_PRIO_POLL,    CMD_TIMEOUT_QUERY_DEFAULT,  0},
+    {ATCL_CMD_SSO,      "SSo",  ATCL_CLASS_SETTER,  ATCL_RESP_ACK,         ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_SSA,      "SSa",  ATCL_CLASS_SETTER,  ATCL_RESP_ACK,         ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_SSZ,      "SSz",  ATCL_CLASS_SETTER,  ATCL_RESP_ACK,         ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_SGO,      "SGo",  ATCL_CLASS_QUERY,   ATCL_RESP_SITE_ANGLE,  ATCL_PRIO_POLL,    CMD_TIMEOUT_QUERY_DEFAULT,  0},
+    {ATCL_CMD_SGA,      "SGa",  ATCL_CLASS_QUERY,   ATCL_RESP_SITE_ANGLE,  ATCL_PRIO_POLL,    CMD_TIMEOUT_QUERY_DEFAULT,  0},
+    {ATCL_CMD_SGZ,      "SGz",  ATCL_CLASS_QUERY,   ATCL_RESP_NUMBER,      ATCL_PRIO_POLL,    CMD_TIMEOUT_QUERY_DEFAULT,  0},
+
+    {ATCL_CMD_TGLF,     "TGlf", ATCL_CLASS_QUERY,   ATCL_RESP_TEXT,        ATCL_PRIO_POLL,    CMD_TIMEOUT_QUERY_DEFAULT,  0},
+    {ATCL_CMD_TGDF,     "TGdf", ATCL_CLASS_QUERY,   ATCL_RESP_TEXT,        ATCL_PRIO_POLL,    CMD_TIMEOUT_QUERY_DEFAULT,  0},
+    {ATCL_CMD_TGST,     "TGst", ATCL_CLASS_QUERY,   ATCL_RESP_SEXAGESIMAL, ATCL_PRIO_POLL,    CMD_TIMEOUT_QUERY_DEFAULT,  POLL_AGE_UI},
+    {ATCL_CMD_TGSD,     "TGsd", ATCL_CLASS_QUERY,   ATCL_RESP_TEXT,        ATCL_PRIO_POLL,    CMD_TIMEOUT_QUERY_DEFAULT,  POLL_AGE_UI},
+    {ATCL_CMD_TSST,     "TSst", ATCL_CLASS_ACTION,  ATCL_RESP_ACK,         ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0},
+    {ATCL_CMD_TSSD,     "TSsd", ATCL_CLASS_ACTION,  ATCL_RESP_ACK,         ATCL_PRIO_CONTROL, CMD_TIMEOUT_DEFAULT,        0}
+};
+
+// the table is indexed by ATCLCommandId, catch an entry added out of order at compile time
+constexpr bool atclTableInOrder(int i)
+{
+    return i >= ATCL_NB_COMMANDS || (g_ATCLCommands[i].nId == i && atclTableInOrder(i + 1));
+}
+static_assert(atclTableInOrder(0), "g_ATCLCommands must follow the ATCLCommandId order");
+
+constexpr size_t atclLength(const char *psz)
+{
+    return *psz ? 1 + atclLength(psz + 1) : 0;
+}
+
+constexpr const ATCLCommandDesc &atclCommand(ATCLCommandId nCmd) { return g_ATCLCommands[nCmd]; }
+constexpr const char *atclMnemonic(ATCLCommandId nCmd) { return g_ATCLCommands[nCmd].pszMnemonic; }
+constexpr size_t atclMnemonicLength(ATCLCommandId nCmd) { return atclLength(g_ATCLCommands[nCmd].pszMnemonic); }
+// only queries are resent after a timeout, a motion or a setter might have been executed
+constexpr bool atclIsQuery(ATCLCommandId nCmd) { return g_ATCLCommands[nCmd].nClass == ATCL_CLASS_QUERY; }
+constexpr bool atclIsPolled(ATCLCommandId nCmd) { return g_ATCLCommands[nCmd].nPollAgeMs > 0; }
+constexpr ATCLPriority atclPriority(ATCLCommandId nCmd) { return g_ATCLCommands[nCmd].nPriority; }
+
+// "!" mnemonic arguments ";" (ATCL enter is the single 0xB1 byte)
+std::string atclFormat(ATCLCommandId nCmd, const std::string &sArgs = "");
+// same, appended to sOut so a reused buffer keeps its capacity
+void atclAppend(std::string &sOut, ATCLCommandId nCmd, const std::string &sArgs = "");
+std::string atclNumber(double dValue, int nDecimals);
+std::string atclSite(int nSiteNb, const std::string &sValue = "");
+
+// A reply frame as it sits in the receive buffer, without the ';' and the trailing '%', NUL terminated in place.
+// Only valid until the next read on the link, so it's handed to an ATCLResponseParser under the command
+// mutex and never kept. Copy it into a std::string when it has to outlive the exchange.
+typedef struct {
+    const char  *pszResp;
+    size_t      nLen;
+} ATCLResponseView;
+
+// parses a reply in place, returns PLUGIN_OK or an error that becomes the command's result.
+// Keep the captures to a couple of references so std::function doesn't allocate.
+typedef std::function<int(const ATCLResponseView &resp)> ATCLResponseParser;
+
+// typed response parsers, false if the reply doesn't hold that type
+bool atclParseNumber(const char *pszResp, double &dValue);
+bool atclParseInteger(const char *pszResp, int &nValue);    // trailing unit ('%') ignored
+bool atclParseYesNo(const char *pszResp, bool &bYes);
+bool atclParseSexagesimal(const char *pszResp, double &dValue);   // [+-]DD:MM:SS[.s] to decimal
+bool atclParseSiteAngle(const char *pszResp, double &dValue);     // DDD:MM:SS followed by N/S/E/W, south and west negative
+bool atclIsNotAvailable(const char *pszResp);    // "N/A", the controller has no value yet (not aligned)
+// the reply parses as the command's response type
+bool atclResponseValid(ATCLCommandId nCmd, const char *pszResp);
+
+// The link, shared by the X2 thread, the connect thread and the tracking threads.
+// When it's released a waiter with the highest priority waiting gets it, so a stop doesn't queue
+// behind status polls. Locked through level(), which CTimedMutexLocker takes.
+class CATCLCommandLock
+{
+public:
+    class CLevel
+    {
+    public:
+        void    lock() { m_pOwner->lock(m_nPriority); }
+        void    unlock() { m_pOwner->unlock(); }
+    private:
+        friend class CATCLCommandLock;
+        CATCLCommandLock    *m_pOwner;
+        ATCLPriority        m_nPriority;
+    };
+
+    CATCLCommandLock();
+    CLevel  &level(ATCLPriority nPriority) { return m_Levels[nPriority]; }
+
+    void    lock(ATCLPriority nPriority);
+    void    unlock();
+
+private:
+    std::mutex              m_Mutex;
+    std::condition_variable m_cvFree;
+    bool                    m_bBusy;
+    int                     m_nWaiting[ATCL_NB_PRIORITIES];
+    CLevel                  m_Levels[ATCL_NB_PRIORITIES];
+};
@@ -0,0 +1,198 @@
+#include "ATCSEpoch.h"
+
+// C++ includes
+#include <cmath>
+
+#if defined(EPOCH_SIMD_AVX2)
+#include <immintrin.h>
+#elif defined(EPOCH_SIMD_SSE2)
+#include <emmintrin.h>
+#endif
+
+#define EPOCH_PI            3.14159265358979323846
+#define DEG_TO_RAD          (EPOCH_PI / 180.0)
+#define ARCSEC_TO_RAD       (EPOCH_PI / 648000.0)
+#define HOURS_TO_RAD        (EPOCH_PI / 12.0)
+#define ABERRATION_CONSTANT 20.49552    // arcsec
+
+CEpochConverter::CEpochConverter()
+{
+    setEpoch(946728000.0, false);   // J2000.0, identity
+}
+
+void CEpochConverter::setEpoch(double dTime, bool bAberration)
+{
+    double dT;
+    double dZeta, dZ, dTheta;
+    double dP[3][3];
+    double dOmega, dL, dLm;
+    double dDeltaPsi, dEps0, dEps;
+    double dN[3][3];
+    double dSunL0, dSunM, dSunC, dSun, dE, dPerihelion;
+    double dKappa;
+
+    // julian centuries from J2000.0, UTC is close enough to TT for this
+    dT = (dTime / 86400.0 + 2440587.5 - 2451545.0) / 36525.0;
+
+    // precession, Lieske 1977
+    dZeta = (2306.2181 + (0.30188 + 0.017998 * dT) * dT) * dT * ARCSEC_TO_RAD;
+    dZ = (2306.2181 + (1.09468 + 0.018203 * dT) * dT) * dT * ARCSEC_TO_RAD;
+    dTheta = (2004.3109 - (0.42665 + 0.041833 * dT) * dT) * dT * ARCSEC_TO_RAD;
+    dP[0][0] = cos(dZeta) * cos(dTheta) * cos(dZ) - sin(dZeta) * sin(dZ);
+    dP[0][1] = -sin(dZeta) * cos(dTheta) * cos(dZ) - cos(dZeta) * sin(dZ);
+    dP[0][2] = -sin(dTheta) * cos(dZ);
+    dP[1][0] = cos(dZeta) * cos(dTheta) * sin(dZ) + sin(dZeta) * cos(dZ);
+    dP[1][1] = -sin(dZeta) * cos(dTheta) * sin(dZ) + cos(dZeta) * cos(dZ);
+    dP[1][2] = -sin(dTheta) * sin(dZ);
+    dP[2][0] = cos(dZeta) * sin(dTheta);
+    dP[2][1] = -sin(dZeta) * sin(dTheta);
+    dP[2][2] = cos(dTheta);
+
+    // nutation, main terms
+    dOmega = (125.04452 - 1934.136261 * dT) * DEG_TO_RAD;
+    dL = (280.4665 + 36000.7698 * dT) * DEG_TO_RAD;
+    dLm = (218.3165 + 481267.8813 * dT) * DEG_TO_RAD;
+    dDeltaPsi = (-17.20 * sin(dOmega) - 1.32 * sin(2 * dL) - 0.23 * sin(2 * dLm) + 0.21 * sin(2 * dOmega)) * ARCSEC_TO_RAD;
+    dEps0 = (84381.448 - (46.8150 + (0.00059 - 0.001813 * dT) * dT) * dT) * ARCSEC_TO_RAD;
+    dEps = dEps0 + (9.20 * cos(dOmega) + 0.57 * cos(2 * dL) + 0.10 * cos(2 * dLm) - 0.09 * cos(2 * dOmega)) * ARCSEC_TO_RAD;
+    dN[0][0] = cos(dDeltaPsi);
+    dN[0][1] = -sin(dDeltaPsi) * cos(dEps0);
+    dN[0][2] = -sin(dDeltaPsi) * sin(dEps0);
+    dN[1][0] = sin(dDeltaPsi) * cos(dEps);
+    dN[1][1] = cos(dDeltaPsi) * cos(dEps) * cos(dEps0) + sin(dEps) * sin(dEps0);
+    dN[1][2] = cos(dDeltaPsi) * cos(dEps) * sin(dEps0) - sin(dEps) * cos(dEps0);
+    dN[2][0] = sin(dDeltaPsi) * sin(dEps);
+    dN[2][1] = cos(dDeltaPsi) * sin(dEps) * cos(dEps0) - cos(dEps) * sin(dEps0);
+    dN[2][2] = cos(dDeltaPsi) * sin(dEps) * sin(dEps0) + cos(dEps) * cos(dEps0);
+
+    for(int i = 0; i < 3; i++) {
+        for(int j = 0; j < 3; j++)
+            m_dMatrix[i][j] = dN[i][0] * dP[0][j] + dN[i][1] * dP[1][j] + dN[i][2] * dP[2][j];
+    }
+
+    // annual aberration, earth velocity from the sun's true longitude (Meeus ch. 23)
+    m_bAberration = bAberration;
+    dSunL0 = 280.46646 + (36000.76983 + 0.0003032 * dT) * dT;
+    dSunM = (357.52911 + (35999.05029 - 0.0001537 * dT) * dT) * DEG_TO_RAD;
+    dSunC = (1.914602 - (0.004817 + 0.000014 * dT) * dT) * sin(dSunM) + (0.019993 - 0.000101 * dT) * sin(2 * dSunM) + 0.000289 * sin(3 * dSunM);
+    dSun = (dSunL0 + dSunC) * DEG_TO_RAD;
+    dE = 0.016708634 - (0.000042037 + 0.0000001267 * dT) * dT;
+    dPerihelion = (102.93735 + (1.71946 + 0.00046 * dT) * dT) * DEG_TO_RAD;
+    dKappa = bAberration ? ABERRATION_CONSTANT * ARCSEC_TO_RAD : 0.0;
+    m_dVelocity[0] = dKappa * (sin(dSun) - dE * sin(dPerihelion));
+    m_dVelocity[1] = -dKappa * (cos(dSun) - dE * cos(dPerihelion)) * cos(dEps);
+    m_dVelocity[2] = -dKappa * (cos(dSun) - dE * cos(dPerihelion)) * sin(dEps);
+}
+
+void CEpochConverter::convert(double dRa, double dDec, double &dRaOut, double &dDecOut) const
+{
+    convert(&dRa, &dDec, &dRaOut, &dDecOut, 1);
+}
+
+void CEpochConverter::convert(const double *pdRa, const double *pdDec, double *pdRaOut, double *pdDecOut, size_t nTargets) const
+{
+    double dX[EPOCH_BATCH], dY[EPOCH_BATCH], dZ[EPOCH_BATCH];
+    double dRa, dDec, dCosDec;
+    size_t nPass;
+
+    for(size_t nStart = 0; nStart < nTargets; nStart += nPass) {
+        nPass = nTargets - nStart < EPOCH_BATCH ? nTargets - nStart : EPOCH_BATCH;
+
+        for(size_t i = 0; i < nPass; i++) {
+            dRa = pdRa[nStart + i] * HOURS_TO_RAD;
+            dDec = pdDec[nStart + i] * DEG_TO_RAD;
+            dCosDec = cos(dDec);
+            dX[i] = dCosDec * cos(dRa);
+            dY[i] = dCosDec * sin(dRa);
+            dZ[i] = sin(dDec);
+        }
+
+        transform(dX, dY, dZ, nPass);
+
+        // the aberration shift leaves the vectors a hair off unit length, atan2 doesn't mind
+        for(size_t i = 0; i < nPass; i++) {
+            dRa = atan2(dY[i], dX[i]) / HOURS_TO_RAD;
+            pdRaOut[nStart + i] = dRa < 0 ? dRa + 24.0 : dRa;
+            pdDecOut[nStart + i] = atan2(dZ[i], sqrt(dX[i] * dX[i] + dY[i] * dY[i])) / DEG_TO_RAD;
+        }
+    }
+}
+
+// u' = M.u, then u'' = u' + v - u'(u'.v)
+void CEpochConverter::transformScalar(double *pdX, double *pdY, double *pdZ, size_t nStart, size_t nTargets) const
+{
+    double dX, dY, dZ, dDot;
+
+    for(size_t i = nStart; i < nTargets; i++) {
+        dX = m_dMatrix[0][0] * pdX[i] + m_dMatrix[0][1] * pdY[i] + m_dMatrix[0][2] * pdZ[i];
+        dY = m_dMatrix[1][0] * pdX[i] + m_dMatrix[1][1] * pdY[i] + m_dMatrix[1][2] * pdZ[i];
+        dZ = m_dMatrix[2][0] * pdX[i] + m_dMatrix[2][1] * pdY[i] + m_dMatrix[2][2] * pdZ[i];
+        dDot = dX * m_dVelocity[0] + dY * m_dVelocity[1] + dZ * m_dVelocity[2];
+        pdX[i] = dX + m_dVelocity[0] - dX * dDot;
+        pdY[i] = dY + m_dVelocity[1] - dY * dDot;
+        pdZ[i] = dZ + m_dVelocity[2] - dZ * dDot;
+    }
+}
+
+#if defined(EPOCH_SIMD_AVX2)
+
+void CEpochConverter::transform(double *pdX, double *pdY, double *pdZ, size_t nTargets) const
+{
+    size_t i;
+    __m256d vX, vY, vZ, vRx, vRy, vRz, vDot;
+    const __m256d vM00 = _mm256_set1_pd(m_dMatrix[0][0]), vM01 = _mm256_set1_pd(m_dMatrix[0][1]), vM02 = _mm256_set1_pd(m_dMatrix[0][2]);
+    const __m256d vM10 = _mm256_set1_pd(m_dMatrix[1][0]), vM11 = _mm256_set1_pd(m_dMatrix[1][1]), vM12 = _mm256_set1_pd(m_dMatrix[1][2]);
+    const __m256d vM20 = _mm256_set1_pd(m_dMatrix[2][0]), vM21 = _mm256_set1_pd(m_dMatrix[2][1]), vM22 = _mm256_set1_pd(m_dMatrix[2][2]);
+    const __m256d vVx = _mm256_set1_pd(m_dVelocity[0]), vVy = _mm256_set1_pd(m_dVelocity[1]), vVz = _mm256_set1_pd(m_dVelocity[2]);
+
+    for(i = 0; i + 4 <= nTargets; i += 4) {
+        vX = _mm256_loadu_pd(pdX + i);
+        vY = _mm256_loadu_pd(pdY + i);
+        vZ = _mm256_loadu_pd(pdZ + i);
+        vRx = _mm256_fmadd_pd(vM02, vZ, _mm256_fmadd_pd(vM01, vY, _mm256_mul_pd(vM00, vX)));
+        vRy = _mm256_fmadd_pd(vM12, vZ, _mm256_fmadd_pd(vM11, vY, _mm256_mul_pd(vM10, vX)));
+        vRz = _mm256_fmadd_pd(vM22, vZ, _mm256_fmadd_pd(vM21, vY, _mm256_mul_pd(vM20, vX)));
+        vDot = _mm256_fmadd_pd(vRz, vVz, _mm256_fmadd_pd(vRy, vVy, _mm256_mul_pd(vRx, vVx)));
+        _mm256_storeu_pd(pdX + i, _mm256_fnmadd_pd(vRx, vDot, _mm256_add_pd(vRx, vVx)));
+        _mm256_storeu_pd(pdY + i, _mm256_fnmadd_pd(vRy, vDot, _mm256_add_pd(vRy, vVy)));
+        _mm256_storeu_pd(pdZ + i, _mm256_fnmadd_pd(vRz, vDot, _mm256_add_pd(vRz, vVz)));
+    }
+    // the tail call below skips the compiler's vzeroupper, the libm calls that follow are SSE code
+    _mm256_zeroupper();
+    transformScalar(pdX, pdY, pdZ, i, nTargets);
+}
+
+#elif defined(EPOCH_SIMD_SSE2)
+
+void CEpochConverter::transform(double *pdX, double *pdY, double *pdZ, size_t nTargets) const
+{
+    size_t i;
+    __m128d vX, vY, vZ, vRx, vRy, vRz, vDot;
+    const __m128d vM00 = _mm_set1_pd(m_dMatrix[0][0]), vM01 = _mm_set1_pd(m_dMatrix[0][1]), vM02 = _mm_set1_pd(m_dMatrix[0][2]);
+    const __m128d vM10 = _mm_set1_pd(m_dMatrix[1][0]), vM11 = _mm_set1_pd(m_dMatrix[1][1]), vM12 = _mm_set1_pd(m_dMatrix[1][2]);
+    const __m128d vM20 = _mm_set1_pd(m_dMatrix[2][0]), vM21 = _mm_set1_pd(m_dMatrix[2][1]), vM22 = _mm_set1_pd(m_dMatrix[2][2]);
+    const __m128d vVx = _mm_set1_pd(m_dVelocity[0]), vVy = _mm_set1_pd(m_dVelocity[1]), vVz = _mm_set1_pd(m_dVelocity[2]);
+
+    for(i = 0; i + 2 <= nTargets; i += 2) {
+        vX = _mm_loadu_pd(pdX + i);
+        vY = _mm_loadu_pd(pdY + i);
+        vZ = _mm_loadu_pd(pdZ + i);
+        vRx = _mm_add_pd(_mm_add_pd(_mm_mul_pd(vM00, vX), _mm_mul_pd(vM01, vY)), _mm_mul_pd(vM02, vZ));
+        vRy = _mm_add_pd(_mm_add_pd(_mm_mul_pd(vM10, vX), _mm_mul_pd(vM11, vY)), _mm_mul_pd(vM12, vZ));
+        vRz = _mm_add_pd(_mm_add_pd(_mm_mul_pd(vM20, vX), _mm_mul_pd(vM21, vY)), _mm_mul_pd(vM22, vZ));
+        vDot = _mm_add_pd(_mm_add_pd(_mm_mul_pd(vRx, vVx), _mm_mul_pd(vRy, vVy)), _mm_mul_pd(vRz, vVz));
+        _mm_storeu_pd(pdX + i, _mm_sub_pd(_mm_add_pd(vRx, vVx), _mm_mul_pd(vRx, vDot)));
+        _mm_storeu_pd(pdY + i, _mm_sub_pd(_mm_add_pd(vRy, vVy), _mm_mul_pd(vRy, vDot)));
+        _mm_storeu_pd(pdZ + i, _mm_sub_pd(_mm_add_pd(vRz, vVz), _mm_mul_pd(vRz, vDot)));
+    }
+    transformScalar(pdX, pdY, pdZ, i, nTargets);
+}
+
+#else
+
+void CEpochConverter::transform(double *pdX, double *pdY, double *pdZ, size_t nTargets) const
+{
+    transformScalar(pdX, pdY, pdZ, 0, nTargets);
+}
+
+#endif
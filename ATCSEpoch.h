@@ -0,0 +1,39 @@
+#pragma once
+
+#include <stddef.h>
+
+// Vector paths of the batch kernel, picked at compile time.
+// SSE2 is always there on x86_64, AVX2 only with -mavx2 (make AVX2=1), anything else uses the scalar loop.
+#if defined(__AVX2__)
+#define EPOCH_SIMD_AVX2 1
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define EPOCH_SIMD_SSE2 1
+#endif
+
+#define EPOCH_BATCH     64      // targets per pass, the unit vectors of a pass stay on the stack
+
+// J2000 mean place to apparent place of date (what the controller calls JNow).
+// Precession IAU 1976, nutation from the main terms of IAU 1980 (about 0.5"), annual aberration with the
+// eccentricity terms (about 0.1"). Proper motion, parallax and diurnal aberration are not included.
+// Everything that depends on the date is computed once by setEpoch, converting a target is then a rotation
+// and a first order aberration shift of its unit vector.
+// RA in hours, Dec in degrees, times are unix time.
+class CEpochConverter
+{
+public:
+    CEpochConverter();
+
+    void    setEpoch(double dTime, bool bAberration = true);
+
+    void    convert(double dRa, double dDec, double &dRaOut, double &dDecOut) const;
+    // the output arrays can be the input ones
+    void    convert(const double *pdRa, const double *pdDec, double *pdRaOut, double *pdDecOut, size_t nTargets) const;
+
+private:
+    double  m_dMatrix[3][3];    // nutation x precession
+    double  m_dVelocity[3];     // earth velocity / c, equator and equinox of date
+    bool    m_bAberration;
+
+    void    transform(double *pdX, double *pdY, double *pdZ, size_t nTargets) const;
+    void    transformScalar(double *pdX, double *pdY, double *pdZ, size_t nStart, size_t nTargets) const;
+};
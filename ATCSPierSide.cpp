@@ -0,0 +1,91 @@
+#include "ATCSPierSide.h"
+
+// C++ includes
+#include <cmath>
+
+CPierSideModel::CPierSideModel()
+{
+    reset();
+}
+
+void CPierSideModel::reset()
+{
+    m_bGemFlip = false;
+    m_bLimitsKnown = false;
+    m_dEastAngle = 0;
+    m_dWestAngle = 0;
+    m_bSideKnown = false;
+    m_bBeyondThePole = false;
+}
+
+void CPierSideModel::setAvoidMethod(const std::string &sMethod)
+{
+    bool bGemFlip = (sMethod.find("GEM") != std::string::npos);
+
+    if(bGemFlip != m_bGemFlip)
+        m_bSideKnown = false;
+    m_bGemFlip = bGemFlip;
+}
+
+void CPierSideModel::setLimitAngles(double dEastAngle, double dWestAngle)
+{
+    m_dEastAngle = dEastAngle;
+    m_dWestAngle = dWestAngle;
+    m_bLimitsKnown = true;
+}
+
+void CPierSideModel::limitAngles(double &dEastAngle, double &dWestAngle) const
+{
+    dEastAngle = m_dEastAngle;
+    dWestAngle = m_dWestAngle;
+}
+
+// the controller gives the limits as signed angles, TheSkyX wants hours on each side of the meridian
+void CPierSideModel::limitHours(double &dHoursEast, double &dHoursWest) const
+{
+    dHoursEast = fabs(m_dEastAngle) / 15.0;
+    dHoursWest = fabs(m_dWestAngle) / 15.0;
+}
+
+void CPierSideModel::targetSet(double dHourAngle)
+{
+    m_bBeyondThePole = sideFor(dHourAngle);
+    m_bSideKnown = true;
+}
+
+// tracking doesn't change the side, so a position only tells us something when we have no idea
+void CPierSideModel::positionRead(double dHourAngle)
+{
+    if(m_bSideKnown)
+        return;
+    targetSet(dHourAngle);
+}
+
+// Under Full(GEM) the limits are how far past the meridian each side can track : beyond the pole up to
+// the west limit, on the normal side from the east limit. A target both sides can reach goes to the one
+// that leaves it the most room, so the flip is half way between the limits (the meridian when they're equal).
+double CPierSideModel::flipHourAngle() const
+{
+    double dHoursEast, dHoursWest;
+
+    if(!m_bGemFlip || !m_bLimitsKnown)
+        return 0.0;
+    limitHours(dHoursEast, dHoursWest);
+    return (dHoursWest - dHoursEast) / 2.0;
+}
+
+bool CPierSideModel::sideFor(double dHourAngle) const
+{
+    if(!m_bGemFlip)
+        return false;
+    return normalizeHourAngle(dHourAngle) < flipHourAngle();
+}
+
+// [-12, 12)
+double CPierSideModel::normalizeHourAngle(double dHourAngle)
+{
+    dHourAngle = fmod(dHourAngle + 12.0, 24.0);
+    if(dHourAngle < 0)
+        dHourAngle += 24.0;
+    return dHourAngle - 12.0;
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+// C++ includes
+#include <string>
+
+#define PIER_SIDE_REFRESH_MS    60000   // the limits and avoidance method can be changed from the hand paddle, read them again this often
+
+// Side of the pier the OTA is on, worked out locally from what the controller told us so the
+// AsymmetricalEquatorialInterface calls don't need any serial traffic.
+// Beyond the pole means the OTA is on the west side of the pier, looking east.
+// Hour angles are in hours, positive west of the meridian. Limit angles are the !NGle/!NGlw degrees.
+class CPierSideModel
+{
+public:
+    CPierSideModel();
+
+    // new connection, nothing known
+    void    reset();
+
+    // !NGam reply, "Full(GEM)" makes the controller pick the side from the target hour angle,
+    // the other methods (forks, alt-az) never go beyond the pole
+    void    setAvoidMethod(const std::string &sMethod);
+    void    setLimitAngles(double dEastAngle, double dWestAngle);
+    bool    limitsKnown() const { return m_bLimitsKnown; }
+    void    limitAngles(double &dEastAngle, double &dWestAngle) const;
+    void    limitHours(double &dHoursEast, double &dHoursWest) const;
+
+    // slew or sync to a target at that hour angle
+    void    targetSet(double dHourAngle);
+    // current position, only used while the side is unknown (after a connect or a park)
+    void    positionRead(double dHourAngle);
+    // parked, or anything else that can leave the side ambiguous
+    void    sideLost() { m_bSideKnown = false; }
+    bool    sideKnown() const { return m_bSideKnown; }
+
+    bool    beyondThePole() const { return m_bSideKnown && m_bBeyondThePole; }
+    // Full(GEM), the controller picks the side from the target
+    bool    gemFlip() const { return m_bGemFlip; }
+    // side a goto to that hour angle will land on
+    bool    beyondThePoleFor(double dHourAngle) const { return sideFor(dHourAngle); }
+    // a goto to a target east of this lands beyond the pole, 0 unless the method is Full(GEM)
+    double  flipHourAngle() const;
+
+    static double  normalizeHourAngle(double dHourAngle);
+
+private:
+    bool    m_bGemFlip;
+    bool    m_bLimitsKnown;
+    double  m_dEastAngle;
+    double  m_dWestAngle;
+    bool    m_bSideKnown;
+    bool    m_bBeyondThePole;
+
+    bool    sideFor(double dHourAngle) const;
+};
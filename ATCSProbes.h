@@ -0,0 +1,40 @@
+#pragma once
+
+// USDT static probes (systemtap sdt.h, usable from bpftrace / perf).
+// Only compiled in with -DATCS_USDT on Linux (make USDT=1, needs the systemtap sdt headers),
+// otherwise the macros expand to nothing and their arguments are not evaluated.
+//
+// provider "atcs", mnemonic is the ATCL command mnemonic from g_ATCLCommands (use str(arg0, arg1)) :
+//  cmd_send(mnemonic, len)
+//  frame_received(frame, len)
+//  cmd_done(mnemonic, len, latency_ns, err)
+//  timeout(mnemonic, len, latency_ns)
+//  nack(mnemonic, len, latency_ns)
+//  async_dropped(type, frame, len)
+//
+// ex: bpftrace -e 'usdt:/path/libATCS.so:atcs:cmd_done { @[str(arg0, arg1)] = hist(arg2 / 1000); }'
+
+#define ATCS_CMD_MNEMONIC(nCmd)         atclMnemonic(nCmd)
+#define ATCS_CMD_MNEMONIC_LEN(nCmd)     atclMnemonicLength(nCmd)
+
+#if defined(ATCS_USDT) && defined(SB_LINUX_BUILD)
+#include <sys/sdt.h>
+
+#define ATCS_PROBES_ENABLED 1
+#define ATCS_PROBE_CMD_SEND(pszMnemonic, nLen)                       DTRACE_PROBE2(atcs, cmd_send, pszMnemonic, nLen)
+#define ATCS_PROBE_FRAME_RECEIVED(pFrame, nLen)                      DTRACE_PROBE2(atcs, frame_received, pFrame, nLen)
+#define ATCS_PROBE_CMD_DONE(pszMnemonic, nLen, nLatencyNs, nErr)     DTRACE_PROBE4(atcs, cmd_done, pszMnemonic, nLen, nLatencyNs, nErr)
+#define ATCS_PROBE_TIMEOUT(pszMnemonic, nLen, nLatencyNs)            DTRACE_PROBE3(atcs, timeout, pszMnemonic, nLen, nLatencyNs)
+#define ATCS_PROBE_NACK(pszMnemonic, nLen, nLatencyNs)               DTRACE_PROBE3(atcs, nack, pszMnemonic, nLen, nLatencyNs)
+#define ATCS_PROBE_ASYNC_DROPPED(nType, pFrame, nLen)                DTRACE_PROBE3(atcs, async_dropped, nType, pFrame, nLen)
+
+#else
+
+#define ATCS_PROBE_CMD_SEND(pszMnemonic, nLen)
+#define ATCS_PROBE_FRAME_RECEIVED(pFrame, nLen)
+#define ATCS_PROBE_CMD_DONE(pszMnemonic, nLen, nLatencyNs, nErr)
+#define ATCS_PROBE_TIMEOUT(pszMnemonic, nLen, nLatencyNs)
+#define ATCS_PROBE_NACK(pszMnemonic, nLen, nLatencyNs)
+#define ATCS_PROBE_ASYNC_DROPPED(nType, pFrame, nLen)
+
+#endif
@@ -0,0 +1,158 @@
+#include "ATCSRateModel.h"
+
+// C++ includes
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+CRateModel::CRateModel()
+{
+    clear();
+}
+
+void CRateModel::clear()
+{
+    m_Samples.clear();
+    m_bPolynomial = false;
+    m_dEpoch = 0;
+    m_dRaCoefs.clear();
+    m_dDecCoefs.clear();
+}
+
+bool CRateModel::isValid() const
+{
+    if(m_bPolynomial)
+        return !m_dRaCoefs.empty() || !m_dDecCoefs.empty();
+    return !m_Samples.empty();
+}
+
+bool CRateModel::covers(double dTime) const
+{
+    if(m_bPolynomial)
+        return true;
+    if(m_Samples.empty())
+        return false;
+    return dTime >= m_Samples.front().dTime && dTime <= m_Samples.back().dTime;
+}
+
+void CRateModel::addSample(double dTime, double dRaRate, double dDecRate)
+{
+    RateSample sample;
+
+    if(m_bPolynomial)
+        clear();
+
+    sample.dTime = dTime;
+    sample.dRaRate = dRaRate;
+    sample.dDecRate = dDecRate;
+    m_Samples.insert(std::upper_bound(m_Samples.begin(), m_Samples.end(), sample, sampleBefore), sample);
+}
+
+bool CRateModel::loadTable(const std::string &sPath)
+{
+    std::ifstream fTable(sPath.c_str());
+    std::string sLine;
+    double dTime, dRaRate, dDecRate;
+
+    if(!fTable.is_open())
+        return false;
+
+    clear();
+    while(std::getline(fTable, sLine)) {
+        sLine = sLine.substr(0, sLine.find('#'));
+        if(sLine.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+        std::istringstream ssLine(sLine);
+        if(!(ssLine >> dTime >> dRaRate >> dDecRate)) {
+            clear();
+            return false;
+        }
+        addSample(dTime, dRaRate, dDecRate);
+    }
+    return isValid();
+}
+
+void CRateModel::setPolynomial(double dEpoch, const std::vector<double> &dRaCoefs, const std::vector<double> &dDecCoefs)
+{
+    clear();
+    m_bPolynomial = true;
+    m_dEpoch = dEpoch;
+    m_dRaCoefs = dRaCoefs;
+    m_dDecCoefs = dDecCoefs;
+}
+
+double CRateModel::evalPolynomial(const std::vector<double> &dCoefs, double dHours)
+{
+    double dValue = 0;
+    std::vector<double>::const_reverse_iterator it;
+
+    for(it = dCoefs.rbegin(); it != dCoefs.rend(); ++it)
+        dValue = dValue * dHours + *it;
+    return dValue;
+}
+
+void CRateModel::rateAt(double dTime, double &dRaRate, double &dDecRate) const
+{
+    RateSample sample;
+    std::vector<RateSample>::const_iterator next;
+    double dFrac;
+
+    dRaRate = 0;
+    dDecRate = 0;
+
+    if(m_bPolynomial) {
+        dRaRate = evalPolynomial(m_dRaCoefs, (dTime - m_dEpoch) / 3600.0);
+        dDecRate = evalPolynomial(m_dDecCoefs, (dTime - m_dEpoch) / 3600.0);
+        return;
+    }
+
+    if(m_Samples.empty())
+        return;
+
+    sample.dTime = dTime;
+    next = std::upper_bound(m_Samples.begin(), m_Samples.end(), sample, sampleBefore);
+    if(next == m_Samples.begin()) {
+        dRaRate = next->dRaRate;
+        dDecRate = next->dDecRate;
+        return;
+    }
+    if(next == m_Samples.end()) {
+        dRaRate = m_Samples.back().dRaRate;
+        dDecRate = m_Samples.back().dDecRate;
+        return;
+    }
+
+    const RateSample &prev = *(next - 1);
+    dFrac = (dTime - prev.dTime) / (next->dTime - prev.dTime);
+    dRaRate = prev.dRaRate + dFrac * (next->dRaRate - prev.dRaRate);
+    dDecRate = prev.dDecRate + dFrac * (next->dDecRate - prev.dDecRate);
+}
+
+void CRateModel::driftOver(double dStart, double dEnd, double dRaRate, double dDecRate, double &dRaDrift, double &dDecDrift) const
+{
+    int i;
+    double dStep;
+    double dWeight;
+    double dRa, dDec;
+    double dRaSum = 0;
+    double dDecSum = 0;
+
+    dRaDrift = 0;
+    dDecDrift = 0;
+    if(dEnd <= dStart)
+        return;
+
+    // Simpson's rule on the rate difference, rates are per hour and times in seconds
+    dStep = (dEnd - dStart) / RATE_MODEL_INTEGRATION_STEPS;
+    for(i = 0; i <= RATE_MODEL_INTEGRATION_STEPS; i++) {
+        rateAt(dStart + i * dStep, dRa, dDec);
+        if(i == 0 || i == RATE_MODEL_INTEGRATION_STEPS)
+            dWeight = 1;
+        else
+            dWeight = (i % 2) ? 4 : 2;
+        dRaSum += dWeight * (dRa - dRaRate);
+        dDecSum += dWeight * (dDec - dDecRate);
+    }
+    dRaDrift = dRaSum * dStep / 3.0 / 3600.0;
+    dDecDrift = dDecSum * dStep / 3.0 / 3600.0;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+// C++ includes
+#include <string>
+#include <vector>
+
+#define RATE_MODEL_INTEGRATION_STEPS    8   // Simpson sub-intervals used by driftOver
+
+// Tracking rate of a moving target (comet, asteroid, Moon) as a function of time.
+// Rates are offsets from sidereal in arcsec/hour, the unit used by !RSor/!RSod.
+// Times are unix time in seconds.
+// The model is either an ephemeris table (linear interpolation between samples,
+// end values held outside the table) or a polynomial in hours from an epoch.
+class CRateModel
+{
+public:
+    CRateModel();
+
+    void    clear();
+    bool    isValid() const;
+    // true if dTime is inside the table or the model is a polynomial
+    bool    covers(double dTime) const;
+
+    // ephemeris table, samples can be added in any order
+    void    addSample(double dTime, double dRaRate, double dDecRate);
+    // text file with one "unix_time ra_rate dec_rate" sample per line, '#' starts a comment
+    bool    loadTable(const std::string &sPath);
+
+    // rate = c[0] + c[1]*t + c[2]*t^2 ..., t in hours since dEpoch
+    void    setPolynomial(double dEpoch, const std::vector<double> &dRaCoefs, const std::vector<double> &dDecCoefs);
+
+    void    rateAt(double dTime, double &dRaRate, double &dDecRate) const;
+    // position error (arcsec) accumulated over [dStart, dEnd] while tracking at dRaRate/dDecRate
+    void    driftOver(double dStart, double dEnd, double dRaRate, double dDecRate, double &dRaDrift, double &dDecDrift) const;
+
+private:
+    typedef struct {
+        double  dTime;
+        double  dRaRate;
+        double  dDecRate;
+    } RateSample;
+
+    std::vector<RateSample> m_Samples;     // sorted by time
+
+    bool                    m_bPolynomial;
+    double                  m_dEpoch;
+    std::vector<double>     m_dRaCoefs;
+    std::vector<double>     m_dDecCoefs;
+
+    static bool    sampleBefore(const RateSample &a, const RateSample &b) { return a.dTime < b.dTime; }
+    static double  evalPolynomial(const std::vector<double> &dCoefs, double dHours);
+};
@@ -0,0 +1,403 @@
+#include "ATCSReactor.h"
+
+#ifndef SB_WIN_BUILD
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#endif
+
+std::mutex      ATCSReactor::m_InstanceMutex;
+ATCSReactor     *ATCSReactor::m_pInstance = NULL;
+int             ATCSReactor::m_nRefCount = 0;
+
+#pragma mark - ATCSReactorChannel
+
+ATCSReactorChannel::ATCSReactorChannel(ATCSTransport *pTransport)
+{
+    m_pTransport = pTransport;
+    m_pReactor = NULL;
+    m_ulRxOffset = 0;
+    m_nLastErr = SB_OK;
+    m_nReaders = 0;
+    m_bFailed = false;
+}
+
+ATCSReactorChannel::~ATCSReactorChannel()
+{
+    if(m_pReactor)
+        close();
+}
+
+int ATCSReactorChannel::open(const char *pszPort)
+{
+    int nErr;
+
+    nErr = m_pTransport->open(pszPort);
+    if(nErr)
+        return nErr;
+
+    // not registered with the reactor yet, nobody else touches the rings
+    m_RxRing.clear();
+    m_TxRing.clear();
+    m_ulRxOffset = 0;
+    m_nLastErr = SB_OK;
+    m_bFailed = false;
+    m_pReactor = ATCSReactor::acquire();
+    m_pReactor->addChannel(this);
+    return SB_OK;
+}
+
+int ATCSReactorChannel::close()
+{
+    if(m_pReactor) {
+        m_pReactor->removeChannel(this);
+        ATCSReactor::release();
+        m_pReactor = NULL;
+    }
+    return m_pTransport->close();
+}
+
+int ATCSReactorChannel::write(const char *pBuf, unsigned long ulSize)
+{
+    int nWaitMs;
+    uint32_t nSeq;
+    unsigned long ulLen;
+    ReactorChunk *pChunk;
+    std::chrono::steady_clock::time_point deadline;
+
+    if(!m_pReactor)
+        return ERR_NOLINK;
+    if(m_bFailed)
+        return m_nLastErr ? (int)m_nLastErr : ERR_COMMNOLINK;
+
+    deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(REACTOR_TX_WAIT_TIMEOUT);
+    while(ulSize) {
+        pChunk = m_TxRing.writeSlot();
+        while(!pChunk) {
+            // the reactor has a backlog, make sure it is awake and wait for it to make room
+            m_pReactor->wakeup();
+            nSeq = m_TxEvent.prepare();
+            pChunk = m_TxRing.writeSlot();
+            if(pChunk)
+                break;
+            nWaitMs = (int)std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+            if(nWaitMs <= 0)
+                return ERR_TXTIMEOUT;
+            m_TxEvent.wait(nSeq, nWaitMs);
+            pChunk = m_TxRing.writeSlot();
+        }
+        ulLen = std::min(ulSize, (unsigned long)REACTOR_MAX_CHUNK);
+        memcpy(pChunk->data, pBuf, ulLen);
+        pChunk->ulLen = ulLen;
+        m_TxRing.publish();
+        pBuf += ulLen;
+        ulSize -= ulLen;
+    }
+    m_pReactor->wakeup();
+    return SB_OK;
+}
+
+int ATCSReactorChannel::read(char *pBuf, unsigned long ulMaxSize, unsigned long &ulBytesRead, int nTimeoutMs)
+{
+    int nErr;
+    int nWaitMs;
+    uint32_t nSeq;
+    bool bWasFull;
+    ReactorChunk *pChunk;
+    std::chrono::steady_clock::time_point deadline;
+
+    ulBytesRead = 0;
+    if(!m_pReactor)
+        return ERR_NOLINK;
+
+    pChunk = m_RxRing.readSlot();
+    if(!pChunk && !m_nLastErr) {
+        deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(nTimeoutMs);
+        m_nReaders++;
+        // channels without a file descriptor are only read while someone waits, the reactor might be sleeping
+        if(m_pTransport->pollFd() < 0)
+            m_pReactor->wakeup();
+        while(true) {
+            nSeq = m_RxEvent.prepare();
+            pChunk = m_RxRing.readSlot();
+            if(pChunk || m_nLastErr)
+                break;
+            nWaitMs = (int)std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+            if(nWaitMs <= 0)
+                break;
+            m_RxEvent.wait(nSeq, nWaitMs);
+        }
+        m_nReaders--;
+    }
+
+    if(pChunk) {
+        ulBytesRead = std::min(ulMaxSize, pChunk->ulLen - m_ulRxOffset);
+        memcpy(pBuf, pChunk->data + m_ulRxOffset, ulBytesRead);
+        m_ulRxOffset += ulBytesRead;
+        if(m_ulRxOffset >= pChunk->ulLen) {
+            bWasFull = m_RxRing.full();
+            m_RxRing.release();
+            m_ulRxOffset = 0;
+            // the reactor stopped polling this channel, there is room again
+            if(bWasFull)
+                m_pReactor->wakeup();
+        }
+        return SB_OK;
+    }
+
+    nErr = m_nLastErr.exchange(SB_OK);
+    if(nErr)
+        return nErr;
+    return ERR_RXTIMEOUT;
+}
+
+int ATCSReactorChannel::purge()
+{
+    std::lock_guard<std::mutex> lock(m_TransportMutex);
+    // the reactor only consumes the submission ring under m_TransportMutex, so we can drop what it hasn't written yet
+    m_TxRing.clear();
+    m_TxEvent.notify();
+    m_RxRing.clear();
+    m_ulRxOffset = 0;
+    m_nLastErr = SB_OK;
+    m_bFailed = false;
+    return m_pTransport->purge();
+}
+
+void ATCSReactorChannel::service()
+{
+    int nErr;
+    unsigned long ulBytesRead = 0;
+    ReactorChunk *pChunk;
+    std::lock_guard<std::mutex> lock(m_TransportMutex);
+
+    pChunk = m_RxRing.writeSlot();
+    if(!pChunk)
+        return; // nobody is reading, keep the rest in the OS buffer
+
+    nErr = m_pTransport->read(pChunk->data, REACTOR_MAX_CHUNK, ulBytesRead, 0);
+    if(!nErr && ulBytesRead) {
+        pChunk->ulLen = ulBytesRead;
+        m_RxRing.publish();
+        m_RxEvent.notify();
+    }
+    else if(nErr && nErr != ERR_RXTIMEOUT) {
+        m_nLastErr = nErr;
+        m_bFailed = true;
+        m_RxEvent.notify();
+    }
+}
+
+// called by the reactor thread, write what the caller queued
+void ATCSReactorChannel::flushTx()
+{
+    int nErr;
+    ReactorChunk *pChunk;
+    std::lock_guard<std::mutex> lock(m_TransportMutex);
+
+    pChunk = m_TxRing.readSlot();
+    if(!pChunk)
+        return;
+    while(pChunk) {
+        nErr = m_bFailed ? SB_OK : m_pTransport->write(pChunk->data, pChunk->ulLen);
+        m_TxRing.release();
+        if(nErr) {
+            // the caller is about to read the reply, that's where it gets the error
+            m_nLastErr = nErr;
+            m_bFailed = true;
+            m_RxEvent.notify();
+        }
+        pChunk = m_TxRing.readSlot();
+    }
+    m_TxEvent.notify();
+}
+
+bool ATCSReactorChannel::isFull()
+{
+    return m_RxRing.full();
+}
+
+void ATCSReactorChannel::setFailed(int nErr)
+{
+    m_nLastErr = nErr;
+    m_bFailed = true;
+    m_RxEvent.notify();
+}
+
+#pragma mark - ATCSReactor
+
+ATCSReactor *ATCSReactor::acquire()
+{
+    std::lock_guard<std::mutex> lock(m_InstanceMutex);
+
+    if(!m_pInstance)
+        m_pInstance = new ATCSReactor();
+    m_nRefCount++;
+    return m_pInstance;
+}
+
+void ATCSReactor::release()
+{
+    std::lock_guard<std::mutex> lock(m_InstanceMutex);
+
+    if(!m_pInstance)
+        return;
+    m_nRefCount--;
+    if(m_nRefCount <= 0) {
+        delete m_pInstance;
+        m_pInstance = NULL;
+        m_nRefCount = 0;
+    }
+}
+
+ATCSReactor::ATCSReactor()
+{
+    m_nNextChannel = 0;
+    m_bRunning = true;
+    m_bWakeup = false;
+#ifndef SB_WIN_BUILD
+    if(pipe(m_nWakeupPipe) == 0) {
+        fcntl(m_nWakeupPipe[0], F_SETFL, O_NONBLOCK);
+        fcntl(m_nWakeupPipe[1], F_SETFL, O_NONBLOCK);
+    }
+    else {
+        m_nWakeupPipe[0] = -1;
+        m_nWakeupPipe[1] = -1;
+    }
+#endif
+    m_thread = std::thread(&ATCSReactor::run, this);
+}
+
+ATCSReactor::~ATCSReactor()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_bRunning = false;
+    }
+    wakeup();
+    if(m_thread.joinable())
+        m_thread.join();
+#ifndef SB_WIN_BUILD
+    if(m_nWakeupPipe[0] >= 0)
+        ::close(m_nWakeupPipe[0]);
+    if(m_nWakeupPipe[1] >= 0)
+        ::close(m_nWakeupPipe[1]);
+#endif
+}
+
+void ATCSReactor::addChannel(ATCSReactorChannel *pChannel)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_vChannels.push_back(pChannel);
+    }
+    wakeup();
+}
+
+void ATCSReactor::removeChannel(ATCSReactorChannel *pChannel)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_vChannels.erase(std::remove(m_vChannels.begin(), m_vChannels.end(), pChannel), m_vChannels.end());
+    if(m_nNextChannel >= m_vChannels.size())
+        m_nNextChannel = 0;
+}
+
+void ATCSReactor::wakeup()
+{
+    m_bWakeup = true;
+#ifndef SB_WIN_BUILD
+    char c = 0;
+    if(m_nWakeupPipe[1] >= 0 && ::write(m_nWakeupPipe[1], &c, 1) < 0) {
+        // pipe full, the reactor has pending wakeups anyway
+    }
+#endif
+    m_cv.notify_one();
+}
+
+void ATCSReactor::run()
+{
+    size_t i;
+    size_t nChannels;
+    bool bNeedPolling;
+    ATCSReactorChannel *pChannel;
+#ifndef SB_WIN_BUILD
+    std::vector<struct pollfd> vFds;
+    struct pollfd pfd;
+    char szDrain[64];
+    int nFd;
+    short nEvents;
+#endif
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    while(m_bRunning) {
+        // channels that can't be waited on (SerX) are polled while someone waits for their data
+        bNeedPolling = false;
+#ifndef SB_WIN_BUILD
+        vFds.clear();
+        pfd.fd = m_nWakeupPipe[0];
+        pfd.events = POLLIN;
+        pfd.revents = 0;
+        vFds.push_back(pfd);
+#endif
+        for(i = 0; i < m_vChannels.size(); i++) {
+#ifndef SB_WIN_BUILD
+            if(m_vChannels[i]->pollFd() >= 0) {
+                // a full buffer would make poll return right away, wait for the reader to drain it
+                if(!m_vChannels[i]->m_bFailed && !m_vChannels[i]->isFull()) {
+                    pfd.fd = m_vChannels[i]->pollFd();
+                    vFds.push_back(pfd);
+                }
+                continue;
+            }
+#endif
+            if(m_vChannels[i]->hasReader())
+                bNeedPolling = true;
+        }
+
+        m_bWakeup = false;
+#ifndef SB_WIN_BUILD
+        lock.unlock();
+        poll(&vFds[0], vFds.size(), bNeedPolling ? TRANSPORT_READ_WAIT_TIMEOUT : -1);
+        if(vFds[0].revents & POLLIN) {
+            while(::read(m_nWakeupPipe[0], szDrain, sizeof(szDrain)) > 0)
+                ;
+        }
+        lock.lock();
+#else
+        if(bNeedPolling)
+            m_cv.wait_for(lock, std::chrono::milliseconds(TRANSPORT_READ_WAIT_TIMEOUT), [this]{ return m_bWakeup || !m_bRunning; });
+        else
+            m_cv.wait(lock, [this]{ return m_bWakeup || !m_bRunning; });
+#endif
+        if(!m_bRunning)
+            break;
+
+        // serve the channels round-robin, starting one further each pass, queued writes go out first
+        nChannels = m_vChannels.size();
+        for(i = 0; i < nChannels; i++) {
+            pChannel = m_vChannels[(m_nNextChannel + i) % nChannels];
+            pChannel->flushTx();
+#ifndef SB_WIN_BUILD
+            nFd = pChannel->pollFd();
+            if(nFd >= 0) {
+                nEvents = 0;
+                for(size_t j = 1; j < vFds.size(); j++) {
+                    if(vFds[j].fd == nFd) {
+                        nEvents = vFds[j].revents;
+                        break;
+                    }
+                }
+                if(nEvents & (POLLHUP | POLLERR | POLLNVAL))
+                    pChannel->setFailed(ERR_COMMNOLINK);
+                else if(nEvents & POLLIN)
+                    pChannel->service();
+                continue;
+            }
+#endif
+            if(pChannel->hasReader())
+                pChannel->service();
+        }
+        if(nChannels)
+            m_nNextChannel = (m_nNextChannel + 1) % nChannels;
+    }
+}
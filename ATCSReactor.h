@@ -0,0 +1,107 @@
+#pragma once
+
+// C++ includes
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <algorithm>
+
+#include "ATCSTransport.h"
+#include "ATCSSpscRing.h"
+
+#define REACTOR_RX_SLOTS        8       // power of 2
+#define REACTOR_TX_SLOTS        8       // power of 2
+#define REACTOR_MAX_CHUNK       256     // max bytes read from one channel per pass, so one busy port can't starve the others
+#define REACTOR_TX_WAIT_TIMEOUT 1000    // ms a writer waits for room in a full submission ring
+
+// one read from the port filled in place by the reactor thread, or one write filled in place by the caller
+typedef struct {
+    unsigned long   ulLen;
+    char            data[REACTOR_MAX_CHUNK];
+} ReactorChunk;
+
+class ATCSReactor;
+
+// Transport wrapper used when several mount instances share the reactor thread.
+// Both directions go through wait-free rings, the ATCS command mutex makes the caller the only
+// producer of the submission ring and the only consumer of the receive ring, the reactor thread is the other side.
+// write() queues the bytes and returns, the reactor writes them on its next pass, a write error is
+// reported by the next read. read() takes what the reactor read and wakes up a waiting caller.
+class ATCSReactorChannel : public ATCSTransport
+{
+public:
+    ATCSReactorChannel(ATCSTransport *pTransport);
+    virtual ~ATCSReactorChannel();
+
+    virtual int     open(const char *pszPort);
+    virtual int     close();
+    virtual bool    isConnected() const { return m_pTransport->isConnected(); }
+
+    virtual int     write(const char *pBuf, unsigned long ulSize);
+    virtual int     read(char *pBuf, unsigned long ulMaxSize, unsigned long &ulBytesRead, int nTimeoutMs);
+    virtual int     purge();
+
+    virtual int     pollFd() const { return m_pTransport->pollFd(); }
+    virtual const char *name() const { return m_pTransport->name(); }
+
+    ATCSTransport   *transport() { return m_pTransport; }
+
+protected:
+    friend class ATCSReactor;
+    // called by the reactor thread
+    void    service();
+    void    setFailed(int nErr);
+    bool    hasReader() const { return m_nReaders > 0; }
+    bool    isFull();
+    void    flushTx();
+
+private:
+    ATCSTransport   *m_pTransport;
+    ATCSReactor     *m_pReactor;
+
+    std::mutex              m_TransportMutex;   // reactor reads vs caller writes and purges
+    CSpscRing<ReactorChunk, REACTOR_RX_SLOTS> m_RxRing;
+    CFutexEvent             m_RxEvent;
+    CSpscRing<ReactorChunk, REACTOR_TX_SLOTS> m_TxRing;
+    CFutexEvent             m_TxEvent;      // the reactor made room in m_TxRing
+    unsigned long           m_ulRxOffset;       // consumed part of the oldest chunk
+    std::atomic<int>        m_nLastErr;
+    std::atomic<int>        m_nReaders;
+    std::atomic<bool>       m_bFailed;      // hung up or read error, don't poll it until purged or reopened
+};
+
+
+// One I/O thread for all the ATCS instances in the process.
+class ATCSReactor
+{
+public:
+    static ATCSReactor *acquire();
+    static void         release();
+
+    void    addChannel(ATCSReactorChannel *pChannel);
+    void    removeChannel(ATCSReactorChannel *pChannel);
+    void    wakeup();
+
+private:
+    ATCSReactor();
+    ~ATCSReactor();
+
+    void    run();
+
+    std::thread                         m_thread;
+    std::mutex                          m_mutex;
+    std::condition_variable             m_cv;
+    std::vector<ATCSReactorChannel*>    m_vChannels;
+    size_t                              m_nNextChannel;
+    bool                                m_bRunning;
+    std::atomic<bool>                   m_bWakeup;
+#ifndef SB_WIN_BUILD
+    int                                 m_nWakeupPipe[2];
+#endif
+
+    static std::mutex       m_InstanceMutex;
+    static ATCSReactor      *m_pInstance;
+    static int              m_nRefCount;
+};
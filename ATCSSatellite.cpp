@@ -0,0 +1,459 @@
+#include "ATCSSatellite.h"
+
+#include <stdlib.h>
+#include <math.h>
+
+#include <fstream>
+
+// WGS72
+#define SGP4_RE         6378.135            // km
+#define SGP4_XKE        0.07436691613317    // 60 / sqrt(re^3 / mu)
+#define SGP4_J2         0.001082616
+#define SGP4_J3         -0.00000253881
+#define SGP4_J4         -0.00000165597
+#define SGP4_J3OJ2      (SGP4_J3 / SGP4_J2)
+#define SGP4_X2O3       (2.0 / 3.0)
+#define SGP4_PI         3.14159265358979323846
+#define SGP4_TWOPI      (2.0 * SGP4_PI)
+#define SGP4_DEEP_SPACE_PERIOD  225.0       // minutes
+#define WGS72_FLATTENING    (1.0 / 298.26)
+
+CSGP4::CSGP4()
+{
+    m_bValid = false;
+    m_dEpochJD = 0;
+}
+
+// TLE field, blanks are allowed
+double CSGP4::tleNumber(const std::string &sLine, size_t nStart, size_t nLen)
+{
+    if(sLine.size() < nStart + nLen)
+        return 0;
+    return atof(sLine.substr(nStart, nLen).c_str());
+}
+
+// TLE field with an assumed leading decimal point and an exponent, " 12345-3" is 0.12345e-3
+double CSGP4::tleExponent(const std::string &sLine, size_t nStart, size_t nLen)
+{
+    std::string sField;
+    std::string sMantissa;
+    size_t nExp;
+    double dSign = 1;
+
+    if(sLine.size() < nStart + nLen)
+        return 0;
+    sField = sLine.substr(nStart, nLen);
+    sField.erase(0, sField.find_first_not_of(' '));
+    if(sField.empty())
+        return 0;
+    if(sField[0] == '-' || sField[0] == '+') {
+        dSign = (sField[0] == '-') ? -1 : 1;
+        sField.erase(0, 1);
+    }
+    nExp = sField.find_last_of("+-");
+    if(nExp == std::string::npos || nExp == 0)
+        return dSign * atof(("0." + sField).c_str());
+    sMantissa = sField.substr(0, nExp);
+    return dSign * atof(("0." + sMantissa).c_str()) * pow(10.0, atof(sField.substr(nExp).c_str()));
+}
+
+int CSGP4::init(const std::string &sLine1, const std::string &sLine2)
+{
+    int nYear;
+    double dDay;
+    double dEccsq, dOmeosq, dRteosq, dCosio, dCosio2, dCosio4, dSinio;
+    double dAk, dD1, dDel, dAdel, dAo, dPo, dPosq, dCon42, dRp;
+    double dSs, dQzms2t, dSfour, dQzms24, dPerige, dPinvsq, dTsi, dEtasq, dEeta, dPsisq, dCoef, dCoef1, dCc2, dCc3;
+    double dTemp1, dTemp2, dTemp3, dXhdot1, dCc1sq, dTemp;
+
+    m_bValid = false;
+    if(sLine1.size() < 63 || sLine2.size() < 63 || sLine1[0] != '1' || sLine2[0] != '2')
+        return SGP4_BAD_TLE;
+
+    nYear = (int)tleNumber(sLine1, 18, 2);
+    nYear += (nYear < 57) ? 2000 : 1900;
+    dDay = tleNumber(sLine1, 20, 12);
+    // JD of Jan 1st 0h + day of year
+    m_dEpochJD = 367.0 * nYear - floor(7.0 * nYear / 4.0) + 30.0 + 1721013.5 + dDay;
+
+    m_dBstar = tleExponent(sLine1, 53, 8);
+    m_dInclo = tleNumber(sLine2, 8, 8) * SGP4_PI / 180.0;
+    m_dNodeo = tleNumber(sLine2, 17, 8) * SGP4_PI / 180.0;
+    m_dEcco = atof(("0." + sLine2.substr(26, 7)).c_str());
+    m_dArgpo = tleNumber(sLine2, 34, 8) * SGP4_PI / 180.0;
+    m_dMo = tleNumber(sLine2, 43, 8) * SGP4_PI / 180.0;
+    m_dNo = tleNumber(sLine2, 52, 11) * SGP4_TWOPI / 1440.0;   // rad/min
+    if(m_dNo <= 0 || m_dEcco >= 1)
+        return SGP4_BAD_TLE;
+
+    // recover the original mean motion and semi-major axis
+    dEccsq = m_dEcco * m_dEcco;
+    dOmeosq = 1.0 - dEccsq;
+    dRteosq = sqrt(dOmeosq);
+    dCosio = cos(m_dInclo);
+    dCosio2 = dCosio * dCosio;
+    dAk = pow(SGP4_XKE / m_dNo, SGP4_X2O3);
+    dD1 = 0.75 * SGP4_J2 * (3.0 * dCosio2 - 1.0) / (dRteosq * dOmeosq);
+    dDel = dD1 / (dAk * dAk);
+    dAdel = dAk * (1.0 - dDel * dDel - dDel * (1.0 / 3.0 + 134.0 * dDel * dDel / 81.0));
+    dDel = dD1 / (dAdel * dAdel);
+    m_dNo = m_dNo / (1.0 + dDel);
+
+    if(SGP4_TWOPI / m_dNo >= SGP4_DEEP_SPACE_PERIOD)
+        return SGP4_DEEP_SPACE;
+
+    dAo = pow(SGP4_XKE / m_dNo, SGP4_X2O3);
+    dSinio = sin(m_dInclo);
+    dPo = dAo * dOmeosq;
+    dCon42 = 1.0 - 5.0 * dCosio2;
+    m_dCon41 = -dCon42 - dCosio2 - dCosio2;
+    dPosq = dPo * dPo;
+    dRp = dAo * (1.0 - m_dEcco);
+
+    // drag terms
+    dSs = 78.0 / SGP4_RE + 1.0;
+    dQzms2t = pow((120.0 - 78.0) / SGP4_RE, 4);
+    m_bSimple = (dRp < (220.0 / SGP4_RE + 1.0));
+    dSfour = dSs;
+    dQzms24 = dQzms2t;
+    dPerige = (dRp - 1.0) * SGP4_RE;
+    if(dPerige < 156.0) {
+        dSfour = dPerige - 78.0;
+        if(dPerige < 98.0)
+            dSfour = 20.0;
+        dQzms24 = pow((120.0 - dSfour) / SGP4_RE, 4);
+        dSfour = dSfour / SGP4_RE + 1.0;
+    }
+    dPinvsq = 1.0 / dPosq;
+    dTsi = 1.0 / (dAo - dSfour);
+    m_dEta = dAo * m_dEcco * dTsi;
+    dEtasq = m_dEta * m_dEta;
+    dEeta = m_dEcco * m_dEta;
+    dPsisq = fabs(1.0 - dEtasq);
+    dCoef = dQzms24 * pow(dTsi, 4);
+    dCoef1 = dCoef / pow(dPsisq, 3.5);
+    dCc2 = dCoef1 * m_dNo * (dAo * (1.0 + 1.5 * dEtasq + dEeta * (4.0 + dEtasq)) +
+           0.375 * SGP4_J2 * dTsi / dPsisq * m_dCon41 * (8.0 + 3.0 * dEtasq * (8.0 + dEtasq)));
+    m_dCc1 = m_dBstar * dCc2;
+    dCc3 = 0;
+    if(m_dEcco > 1.0e-4)
+        dCc3 = -2.0 * dCoef * dTsi * SGP4_J3OJ2 * m_dNo * dSinio / m_dEcco;
+    m_dX1mth2 = 1.0 - dCosio2;
+    m_dCc4 = 2.0 * m_dNo * dCoef1 * dAo * dOmeosq *
+             (m_dEta * (2.0 + 0.5 * dEtasq) + m_dEcco * (0.5 + 2.0 * dEtasq) -
+              SGP4_J2 * dTsi / (dAo * dPsisq) *
+              (-3.0 * m_dCon41 * (1.0 - 2.0 * dEeta + dEtasq * (1.5 - 0.5 * dEeta)) +
+               0.75 * m_dX1mth2 * (2.0 * dEtasq - dEeta * (1.0 + dEtasq)) * cos(2.0 * m_dArgpo)));
+    m_dCc5 = 2.0 * dCoef1 * dAo * dOmeosq * (1.0 + 2.75 * (dEtasq + dEeta) + dEeta * dEtasq);
+
+    // secular rates
+    dCosio4 = dCosio2 * dCosio2;
+    dTemp1 = 1.5 * SGP4_J2 * dPinvsq * m_dNo;
+    dTemp2 = 0.5 * dTemp1 * SGP4_J2 * dPinvsq;
+    dTemp3 = -0.46875 * SGP4_J4 * dPinvsq * dPinvsq * m_dNo;
+    m_dMdot = m_dNo + 0.5 * dTemp1 * dRteosq * m_dCon41 + 0.0625 * dTemp2 * dRteosq * (13.0 - 78.0 * dCosio2 + 137.0 * dCosio4);
+    m_dArgpdot = -0.5 * dTemp1 * dCon42 + 0.0625 * dTemp2 * (7.0 - 114.0 * dCosio2 + 395.0 * dCosio4) +
+                 dTemp3 * (3.0 - 36.0 * dCosio2 + 49.0 * dCosio4);
+    dXhdot1 = -dTemp1 * dCosio;
+    m_dNodedot = dXhdot1 + (0.5 * dTemp2 * (4.0 - 19.0 * dCosio2) + 2.0 * dTemp3 * (3.0 - 7.0 * dCosio2)) * dCosio;
+    m_dOmgcof = m_dBstar * dCc3 * cos(m_dArgpo);
+    m_dXmcof = 0;
+    if(m_dEcco > 1.0e-4)
+        m_dXmcof = -SGP4_X2O3 * dCoef * m_dBstar / dEeta;
+    m_dNodecf = 3.5 * dOmeosq * dXhdot1 * m_dCc1;
+    m_dT2cof = 1.5 * m_dCc1;
+    if(fabs(dCosio + 1.0) > 1.5e-12)
+        m_dXlcof = -0.25 * SGP4_J3OJ2 * dSinio * (3.0 + 5.0 * dCosio) / (1.0 + dCosio);
+    else
+        m_dXlcof = -0.25 * SGP4_J3OJ2 * dSinio * (3.0 + 5.0 * dCosio) / 1.5e-12;
+    m_dAycof = -0.5 * SGP4_J3OJ2 * dSinio;
+    m_dDelmo = pow(1.0 + m_dEta * cos(m_dMo), 3);
+    m_dSinmao = sin(m_dMo);
+    m_dX7thm1 = 7.0 * dCosio2 - 1.0;
+
+    m_dD2 = m_dD3 = m_dD4 = 0;
+    m_dT3cof = m_dT4cof = m_dT5cof = 0;
+    if(!m_bSimple) {
+        dCc1sq = m_dCc1 * m_dCc1;
+        m_dD2 = 4.0 * dAo * dTsi * dCc1sq;
+        dTemp = m_dD2 * dTsi * m_dCc1 / 3.0;
+        m_dD3 = (17.0 * dAo + dSfour) * dTemp;
+        m_dD4 = 0.5 * dTemp * dAo * dTsi * (221.0 * dAo + 31.0 * dSfour) * m_dCc1;
+        m_dT3cof = m_dD2 + 2.0 * dCc1sq;
+        m_dT4cof = 0.25 * (3.0 * m_dD3 + m_dCc1 * (12.0 * m_dD2 + 10.0 * dCc1sq));
+        m_dT5cof = 0.2 * (3.0 * m_dD4 + 12.0 * m_dCc1 * m_dD3 + 6.0 * m_dD2 * m_dD2 + 15.0 * dCc1sq * (2.0 * m_dD2 + dCc1sq));
+    }
+
+    m_bValid = true;
+    return SGP4_OK;
+}
+
+int CSGP4::propagateJD(double dJD, double dPos[3], double dVel[3]) const
+{
+    return propagate((dJD - m_dEpochJD) * 1440.0, dPos, dVel);
+}
+
+int CSGP4::propagate(double dT, double dPos[3], double dVel[3]) const
+{
+    int nIter;
+    double dXmdf, dArgpdf, dNodedf, dArgpm, dMm, dT2, dT3, dT4, dNodem, dTempa, dTempe, dTempl;
+    double dDelomg, dDelm, dTemp, dNm, dEm, dAm, dXlm;
+    double dAxnl, dAynl, dXl, dU, dEo1, dTem5, dSineo1, dCoseo1;
+    double dEcose, dEsine, dEl2, dPl, dRl, dRdotl, dRvdotl, dBetal, dSinu, dCosu, dSu;
+    double dSin2u, dCos2u, dTemp1, dTemp2, dMrt, dXnode, dXinc, dMvt, dRvdot;
+    double dSinsu, dCossu, dSnod, dCnod, dSini, dCosi, dXmx, dXmy, dUx, dUy, dUz, dVx, dVy, dVz;
+    double dVkmPerSec = SGP4_RE * SGP4_XKE / 60.0;
+    double dCosim, dSinim;
+
+    if(!m_bValid)
+        return SGP4_BAD_TLE;
+
+    // secular gravity and atmospheric drag
+    dXmdf = m_dMo + m_dMdot * dT;
+    dArgpdf = m_dArgpo + m_dArgpdot * dT;
+    dNodedf = m_dNodeo + m_dNodedot * dT;
+    dArgpm = dArgpdf;
+    dMm = dXmdf;
+    dT2 = dT * dT;
+    dNodem = dNodedf + m_dNodecf * dT2;
+    dTempa = 1.0 - m_dCc1 * dT;
+    dTempe = m_dBstar * m_dCc4 * dT;
+    dTempl = m_dT2cof * dT2;
+
+    if(!m_bSimple) {
+        dDelomg = m_dOmgcof * dT;
+        dDelm = m_dXmcof * (pow(1.0 + m_dEta * cos(dXmdf), 3) - m_dDelmo);
+        dTemp = dDelomg + dDelm;
+        dMm = dXmdf + dTemp;
+        dArgpm = dArgpdf - dTemp;
+        dT3 = dT2 * dT;
+        dT4 = dT3 * dT;
+        dTempa = dTempa - m_dD2 * dT2 - m_dD3 * dT3 - m_dD4 * dT4;
+        dTempe = dTempe + m_dBstar * m_dCc5 * (sin(dMm) - m_dSinmao);
+        dTempl = dTempl + m_dT3cof * dT3 + dT4 * (m_dT4cof + dT * m_dT5cof);
+    }
+
+    dAm = pow(SGP4_XKE / m_dNo, SGP4_X2O3) * dTempa * dTempa;
+    dNm = SGP4_XKE / pow(dAm, 1.5);
+    dEm = m_dEcco - dTempe;
+    if(dEm >= 1.0 || dEm < -0.001 || dAm < 0.95)
+        return SGP4_BAD_ELEMENTS;
+    if(dEm < 1.0e-6)
+        dEm = 1.0e-6;
+    dMm = dMm + m_dNo * dTempl;
+    dXlm = dMm + dArgpm + dNodem;
+    dNodem = fmod(dNodem, SGP4_TWOPI);
+    dArgpm = fmod(dArgpm, SGP4_TWOPI);
+    dXlm = fmod(dXlm, SGP4_TWOPI);
+    dMm = fmod(dXlm - dArgpm - dNodem, SGP4_TWOPI);
+    dSinim = sin(m_dInclo);
+    dCosim = cos(m_dInclo);
+
+    // long period periodics
+    dAxnl = dEm * cos(dArgpm);
+    dTemp = 1.0 / (dAm * (1.0 - dEm * dEm));
+    dAynl = dEm * sin(dArgpm) + dTemp * m_dAycof;
+    dXl = dMm + dArgpm + dNodem + dTemp * m_dXlcof * dAxnl;
+
+    // Kepler's equation
+    dU = fmod(dXl - dNodem, SGP4_TWOPI);
+    dEo1 = dU;
+    dTem5 = 9999.9;
+    dSineo1 = dCoseo1 = 0;
+    for(nIter = 0; fabs(dTem5) >= 1.0e-12 && nIter < 10; nIter++) {
+        dSineo1 = sin(dEo1);
+        dCoseo1 = cos(dEo1);
+        dTem5 = 1.0 - dCoseo1 * dAxnl - dSineo1 * dAynl;
+        dTem5 = (dU - dAynl * dCoseo1 + dAxnl * dSineo1 - dEo1) / dTem5;
+        if(fabs(dTem5) >= 0.95)
+            dTem5 = dTem5 > 0.0 ? 0.95 : -0.95;
+        dEo1 = dEo1 + dTem5;
+    }
+
+    // short period preliminary quantities
+    dEcose = dAxnl * dCoseo1 + dAynl * dSineo1;
+    dEsine = dAxnl * dSineo1 - dAynl * dCoseo1;
+    dEl2 = dAxnl * dAxnl + dAynl * dAynl;
+    dPl = dAm * (1.0 - dEl2);
+    if(dPl < 0.0)
+        return SGP4_BAD_ELEMENTS;
+    dRl = dAm * (1.0 - dEcose);
+    dRdotl = sqrt(dAm) * dEsine / dRl;
+    dRvdotl = sqrt(dPl) / dRl;
+    dBetal = sqrt(1.0 - dEl2);
+    dTemp = dEsine / (1.0 + dBetal);
+    dSinu = dAm / dRl * (dSineo1 - dAynl - dAxnl * dTemp);
+    dCosu = dAm / dRl * (dCoseo1 - dAxnl + dAynl * dTemp);
+    dSu = atan2(dSinu, dCosu);
+    dSin2u = (dCosu + dCosu) * dSinu;
+    dCos2u = 1.0 - 2.0 * dSinu * dSinu;
+    dTemp = 1.0 / dPl;
+    dTemp1 = 0.5 * SGP4_J2 * dTemp;
+    dTemp2 = dTemp1 * dTemp;
+
+    // short period periodics
+    dMrt = dRl * (1.0 - 1.5 * dTemp2 * dBetal * m_dCon41) + 0.5 * dTemp1 * m_dX1mth2 * dCos2u;
+    dSu = dSu - 0.25 * dTemp2 * m_dX7thm1 * dSin2u;
+    dXnode = dNodem + 1.5 * dTemp2 * dCosim * dSin2u;
+    dXinc = m_dInclo + 1.5 * dTemp2 * dCosim * dSinim * dCos2u;
+    dMvt = dRdotl - dNm * dTemp1 * m_dX1mth2 * dSin2u / SGP4_XKE;
+    dRvdot = dRvdotl + dNm * dTemp1 * (m_dX1mth2 * dCos2u + 1.5 * m_dCon41) / SGP4_XKE;
+
+    // orientation vectors
+    dSinsu = sin(dSu);
+    dCossu = cos(dSu);
+    dSnod = sin(dXnode);
+    dCnod = cos(dXnode);
+    dSini = sin(dXinc);
+    dCosi = cos(dXinc);
+    dXmx = -dSnod * dCosi;
+    dXmy = dCnod * dCosi;
+    dUx = dXmx * dSinsu + dCnod * dCossu;
+    dUy = dXmy * dSinsu + dSnod * dCossu;
+    dUz = dSini * dSinsu;
+    dVx = dXmx * dCossu - dCnod * dSinsu;
+    dVy = dXmy * dCossu - dSnod * dSinsu;
+    dVz = dSini * dCossu;
+
+    dPos[0] = dMrt * dUx * SGP4_RE;
+    dPos[1] = dMrt * dUy * SGP4_RE;
+    dPos[2] = dMrt * dUz * SGP4_RE;
+    dVel[0] = (dMvt * dUx + dRvdot * dVx) * dVkmPerSec;
+    dVel[1] = (dMvt * dUy + dRvdot * dVy) * dVkmPerSec;
+    dVel[2] = (dMvt * dUz + dRvdot * dVz) * dVkmPerSec;
+
+    if(dMrt < 1.0)
+        return SGP4_DECAYED;
+    return SGP4_OK;
+}
+
+#pragma mark - CSatellitePredictor
+
+CSatellitePredictor::CSatellitePredictor()
+{
+    m_dLatitude = 0;
+    m_dLongitude = 0;
+    m_dElevation = 0;
+}
+
+int CSatellitePredictor::setTLE(const std::string &sLine1, const std::string &sLine2)
+{
+    return m_Sgp4.init(sLine1, sLine2);
+}
+
+int CSatellitePredictor::readTLEFile(const std::string &sPath, std::string &sLine1, std::string &sLine2)
+{
+    std::ifstream fTLE(sPath.c_str());
+    std::string sLine;
+
+    sLine1.clear();
+    sLine2.clear();
+    if(!fTLE.is_open())
+        return SGP4_BAD_TLE;
+
+    while(std::getline(fTLE, sLine)) {
+        sLine = sLine.substr(0, sLine.find_last_not_of(" \t\r") + 1);
+        if(sLine.compare(0, 2, "1 ") == 0)
+            sLine1 = sLine;
+        else if(sLine.compare(0, 2, "2 ") == 0 && !sLine1.empty()) {
+            sLine2 = sLine;
+            return SGP4_OK;
+        }
+    }
+    return SGP4_BAD_TLE;
+}
+
+void CSatellitePredictor::setSite(double dLatitude, double dLongitude, double dElevation)
+{
+    m_dLatitude = dLatitude * SGP4_PI / 180.0;
+    m_dLongitude = dLongitude * SGP4_PI / 180.0;
+    m_dElevation = dElevation / 1000.0;
+}
+
+// Greenwich mean sidereal time in radians (IAU 1982), UT1 taken as UTC
+double CSatellitePredictor::gmst(double dJD)
+{
+    double dTut1;
+    double dGmst;
+
+    dTut1 = (dJD - 2451545.0) / 36525.0;
+    dGmst = -6.2e-6 * dTut1 * dTut1 * dTut1 + 0.093104 * dTut1 * dTut1 +
+            (876600.0 * 3600.0 + 8640184.812866) * dTut1 + 67310.54841;     // seconds
+    dGmst = fmod(dGmst * SGP4_PI / 43200.0, SGP4_TWOPI);
+    if(dGmst < 0)
+        dGmst += SGP4_TWOPI;
+    return dGmst;
+}
+
+int CSatellitePredictor::pointingAt(double dTime, double &dRa, double &dDec, double &dAltitude) const
+{
+    int nErr;
+    int i;
+    double dJD;
+    double dSat[3], dVel[3], dObs[3], dUp[3], dRho[3];
+    double dTheta, dSinLat, dCosLat, dE2, dC, dRxy, dRange;
+    double dSinAlt = 0;
+
+    dJD = unixToJD(dTime);
+    nErr = m_Sgp4.propagateJD(dJD, dSat, dVel);
+    if(nErr)
+        return nErr;
+
+    // observer in the same frame (local sidereal time, WGS72 ellipsoid)
+    dTheta = gmst(dJD) + m_dLongitude;
+    dSinLat = sin(m_dLatitude);
+    dCosLat = cos(m_dLatitude);
+    dE2 = WGS72_FLATTENING * (2.0 - WGS72_FLATTENING);
+    dC = 1.0 / sqrt(1.0 - dE2 * dSinLat * dSinLat);
+    dRxy = (SGP4_RE * dC + m_dElevation) * dCosLat;
+    dObs[0] = dRxy * cos(dTheta);
+    dObs[1] = dRxy * sin(dTheta);
+    dObs[2] = (SGP4_RE * dC * (1.0 - dE2) + m_dElevation) * dSinLat;
+    dUp[0] = dCosLat * cos(dTheta);
+    dUp[1] = dCosLat * sin(dTheta);
+    dUp[2] = dSinLat;
+
+    for(i = 0; i < 3; i++)
+        dRho[i] = dSat[i] - dObs[i];
+    dRange = sqrt(dRho[0] * dRho[0] + dRho[1] * dRho[1] + dRho[2] * dRho[2]);
+    for(i = 0; i < 3; i++)
+        dSinAlt += dRho[i] * dUp[i];
+
+    dRa = atan2(dRho[1], dRho[0]) * 12.0 / SGP4_PI;
+    if(dRa < 0)
+        dRa += 24.0;
+    dDec = asin(dRho[2] / dRange) * 180.0 / SGP4_PI;
+    dAltitude = asin(dSinAlt / dRange) * 180.0 / SGP4_PI;
+    return SGP4_OK;
+}
+
+int CSatellitePredictor::ratesOver(double dStart, double dEnd, double &dRaRate, double &dDecRate) const
+{
+    int nErr;
+    double dRa1, dDec1, dAlt1;
+    double dRa2, dDec2, dAlt2;
+    double dDeltaRa;
+
+    dRaRate = 0;
+    dDecRate = 0;
+    if(dEnd <= dStart)
+        return SGP4_OK;
+
+    nErr = pointingAt(dStart, dRa1, dDec1, dAlt1);
+    if(nErr)
+        return nErr;
+    nErr = pointingAt(dEnd, dRa2, dDec2, dAlt2);
+    if(nErr)
+        return nErr;
+
+    dDeltaRa = dRa2 - dRa1;
+    if(dDeltaRa > 12.0)
+        dDeltaRa -= 24.0;
+    else if(dDeltaRa < -12.0)
+        dDeltaRa += 24.0;
+
+    // sidereal tracking holds RA constant so the RA/Dec change is the offset, RA in arcsec of RA
+    dRaRate = dDeltaRa * 15.0 * 3600.0 * 3600.0 / (dEnd - dStart);
+    dDecRate = (dDec2 - dDec1) * 3600.0 * 3600.0 / (dEnd - dStart);
+    return SGP4_OK;
+}
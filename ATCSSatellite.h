@@ -0,0 +1,68 @@
+#pragma once
+
+// C++ includes
+#include <string>
+
+#define SGP4_OK             0
+#define SGP4_BAD_TLE        1
+#define SGP4_DEEP_SPACE     2   // period >= 225 minutes, only the near-Earth model is implemented
+#define SGP4_BAD_ELEMENTS   3   // eccentricity or semi-major axis out of range during propagation
+#define SGP4_DECAYED        4
+
+// Near-Earth SGP4 propagator (Spacetrack Report #3 with the Vallado 2006 corrections, WGS72 constants).
+// Positions are in km, velocities in km/s, in the TEME frame.
+class CSGP4
+{
+public:
+    CSGP4();
+
+    int     init(const std::string &sLine1, const std::string &sLine2);
+    bool    isValid() const { return m_bValid; }
+    double  epochJD() const { return m_dEpochJD; }
+
+    int     propagate(double dMinutesSinceEpoch, double dPos[3], double dVel[3]) const;
+    int     propagateJD(double dJD, double dPos[3], double dVel[3]) const;
+
+private:
+    bool    m_bValid;
+    double  m_dEpochJD;
+
+    // elements
+    double  m_dBstar, m_dEcco, m_dInclo, m_dNodeo, m_dArgpo, m_dMo, m_dNo;
+
+    // initialised constants
+    bool    m_bSimple;
+    double  m_dAycof, m_dCon41, m_dCc1, m_dCc4, m_dCc5, m_dD2, m_dD3, m_dD4;
+    double  m_dDelmo, m_dEta, m_dArgpdot, m_dOmgcof, m_dSinmao, m_dT2cof, m_dT3cof, m_dT4cof, m_dT5cof;
+    double  m_dX1mth2, m_dX7thm1, m_dMdot, m_dNodedot, m_dXlcof, m_dXmcof, m_dNodecf;
+
+    static double  tleNumber(const std::string &sLine, size_t nStart, size_t nLen);
+    static double  tleExponent(const std::string &sLine, size_t nStart, size_t nLen);
+};
+
+// Topocentric pointing to a satellite from an observing site.
+// Longitude is east positive (same as ATCS::setSiteData), elevation in meters.
+// RA/Dec are apparent of date (TEME), RA in hours and Dec in degrees, times are unix time.
+class CSatellitePredictor
+{
+public:
+    CSatellitePredictor();
+
+    int     setTLE(const std::string &sLine1, const std::string &sLine2);
+    void    setSite(double dLatitude, double dLongitude, double dElevation);
+
+    int     pointingAt(double dTime, double &dRa, double &dDec, double &dAltitude) const;
+    // mean RA/Dec rates over [dStart, dEnd] in arcsec/hour (RA in arcsec of RA), offsets from sidereal
+    int     ratesOver(double dStart, double dEnd, double &dRaRate, double &dDecRate) const;
+
+    // element lines of a TLE file, the optional title line is skipped
+    static int     readTLEFile(const std::string &sPath, std::string &sLine1, std::string &sLine2);
+    static double  unixToJD(double dTime) { return dTime / 86400.0 + 2440587.5; }
+    static double  gmst(double dJD);
+
+private:
+    CSGP4   m_Sgp4;
+    double  m_dLatitude;    // radians
+    double  m_dLongitude;   // radians
+    double  m_dElevation;   // km
+};
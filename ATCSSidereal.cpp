@@ -0,0 +1,55 @@
+#include "ATCSSidereal.h"
+
+// C++ includes
+#include <cmath>
+
+#include "ATCSSatellite.h"
+
+#define RADIANS_TO_HOURS    (12.0 / 3.14159265358979323846)
+
+CSiderealClock::CSiderealClock()
+{
+    clearLongitude();
+}
+
+void CSiderealClock::setLongitude(double dLongitude)
+{
+    m_dLongitude = dLongitude;
+    m_bLongitudeKnown = true;
+}
+
+void CSiderealClock::clearLongitude()
+{
+    m_dLongitude = 0;
+    m_bLongitudeKnown = false;
+}
+
+double CSiderealClock::localSiderealTime(double dTime) const
+{
+    double dLst;
+
+    dLst = CSatellitePredictor::gmst(CSatellitePredictor::unixToJD(dTime)) * RADIANS_TO_HOURS + m_dLongitude / 15.0;
+    dLst = fmod(dLst, 24.0);
+    if(dLst < 0)
+        dLst += 24.0;
+    return dLst;
+}
+
+double CSiderealClock::hourAngle(double dRa, double dTime) const
+{
+    double dHourAngle;
+
+    hourAngles(&dRa, &dHourAngle, 1, dTime);
+    return dHourAngle;
+}
+
+void CSiderealClock::hourAngles(const double *pdRa, double *pdHourAngle, size_t nTargets, double dTime) const
+{
+    // shifted by 12h so a single floor() wraps to [-12, 12), no branch in the loop
+    double dLst = localSiderealTime(dTime) + 12.0;
+
+    for(size_t i = 0; i < nTargets; i++) {
+        double dHourAngle = dLst - pdRa[i];
+        pdHourAngle[i] = dHourAngle - 24.0 * floor(dHourAngle / 24.0) - 12.0;
+    }
+}
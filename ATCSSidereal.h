@@ -0,0 +1,29 @@
+#pragma once
+
+#include <stddef.h>
+
+// Local sidereal time and hour angles from the site longitude, without going back to TheSkyX or the controller.
+// Longitude is east positive (same as ATCS::setSiteData), RA and hour angles in hours, times are unix time.
+// Mean sidereal time (IAU 1982, UT1 taken as UTC) : good to a fraction of a second, far below what the limits
+// and the pier side need.
+class CSiderealClock
+{
+public:
+    CSiderealClock();
+
+    void    setLongitude(double dLongitude);
+    void    clearLongitude();
+    bool    hasLongitude() const { return m_bLongitudeKnown; }
+    double  longitude() const { return m_dLongitude; }
+
+    // [0, 24)
+    double  localSiderealTime(double dTime) const;
+    // [-12, 12), positive west of the meridian
+    double  hourAngle(double dRa, double dTime) const;
+    // same for a list of targets, the sidereal time is computed once for all of them
+    void    hourAngles(const double *pdRa, double *pdHourAngle, size_t nTargets, double dTime) const;
+
+private:
+    bool    m_bLongitudeKnown;
+    double  m_dLongitude;   // degrees
+};
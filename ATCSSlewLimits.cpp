@@ -0,0 +1,188 @@
+#include "ATCSSlewLimits.h"
+
+// C++ includes
+#include <cmath>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#define DEG_TO_RAD      (3.14159265358979323846 / 180.0)
+
+CSlewLimits::CSlewLimits()
+{
+    clearLimits();
+    clearLatitude();
+}
+
+void CSlewLimits::setLimits(double dHoursEast, double dHoursWest)
+{
+    m_dHoursEast = dHoursEast;
+    m_dHoursWest = dHoursWest;
+    m_bLimitsKnown = true;
+}
+
+void CSlewLimits::clearLimits()
+{
+    m_bLimitsKnown = false;
+    m_dHoursEast = 0;
+    m_dHoursWest = 0;
+}
+
+void CSlewLimits::setLatitude(double dLatitude)
+{
+    if(m_bLatitudeKnown && m_dLatitude == dLatitude)
+        return;
+    m_dLatitude = dLatitude;
+    m_bLatitudeKnown = true;
+    build();
+}
+
+void CSlewLimits::clearLatitude()
+{
+    m_bLatitudeKnown = false;
+    m_dLatitude = 0;
+    m_fMargin.clear();
+}
+
+void CSlewLimits::setHorizon(const std::vector<double> &dAzimuths, const std::vector<double> &dAltitudes)
+{
+    std::vector<std::pair<double, double> > points;
+
+    for(size_t i = 0; i < dAzimuths.size() && i < dAltitudes.size(); i++)
+        points.push_back(std::make_pair(fmod(fmod(dAzimuths[i], 360.0) + 360.0, 360.0), dAltitudes[i]));
+    std::sort(points.begin(), points.end());
+
+    m_dHorizonAz.clear();
+    m_dHorizonAlt.clear();
+    for(size_t i = 0; i < points.size(); i++) {
+        m_dHorizonAz.push_back(points[i].first);
+        m_dHorizonAlt.push_back(points[i].second);
+    }
+    build();
+}
+
+bool CSlewLimits::loadHorizon(const std::string &sPath)
+{
+    std::ifstream fHorizon(sPath.c_str());
+    std::string sLine;
+    double dAzimuth, dAltitude;
+    std::vector<double> dAzimuths;
+    std::vector<double> dAltitudes;
+
+    if(!fHorizon.is_open())
+        return false;
+
+    while(std::getline(fHorizon, sLine)) {
+        sLine = sLine.substr(0, sLine.find('#'));
+        if(sLine.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+        std::istringstream ssLine(sLine);
+        if(!(ssLine >> dAzimuth >> dAltitude))
+            return false;
+        dAzimuths.push_back(dAzimuth);
+        dAltitudes.push_back(dAltitude);
+    }
+    if(dAzimuths.empty())
+        return false;
+    setHorizon(dAzimuths, dAltitudes);
+    return true;
+}
+
+void CSlewLimits::clearHorizon()
+{
+    m_dHorizonAz.clear();
+    m_dHorizonAlt.clear();
+    m_fMargin.clear();
+}
+
+SlewCheck CSlewLimits::check(double dHourAngle, double dDec, SlewSide nSide) const
+{
+    double dHa, dDecIdx;
+    int nHa, nDec;
+    const float *pfRow;
+    double dMargin;
+
+    dHourAngle = fmod(fmod(dHourAngle + 12.0, 24.0) + 24.0, 24.0) - 12.0;
+
+    // a limit of 0 is a limit the controller doesn't enforce
+    if(m_bLimitsKnown) {
+        if(nSide != SLEW_SIDE_BEYOND_POLE && m_dHoursEast > 0 && dHourAngle < -m_dHoursEast)
+            return SLEW_PAST_EAST_LIMIT;
+        if(nSide != SLEW_SIDE_NORMAL && m_dHoursWest > 0 && dHourAngle > m_dHoursWest)
+            return SLEW_PAST_WEST_LIMIT;
+    }
+
+    if(m_fMargin.empty())
+        return SLEW_OK;
+
+    dHa = (dHourAngle + 12.0) / SLEW_GRID_HA_STEP;
+    dDecIdx = (std::min(std::max(dDec, -90.0), 90.0) + 90.0) / SLEW_GRID_DEC_STEP;
+    nHa = std::min((int)dHa, SLEW_GRID_NB_HA - 2);
+    nDec = std::min((int)dDecIdx, SLEW_GRID_NB_DEC - 2);
+    dHa -= nHa;
+    dDecIdx -= nDec;
+
+    pfRow = &m_fMargin[(size_t)nDec * SLEW_GRID_NB_HA + nHa];
+    dMargin = (1 - dDecIdx) * ((1 - dHa) * pfRow[0] + dHa * pfRow[1]) +
+              dDecIdx * ((1 - dHa) * pfRow[SLEW_GRID_NB_HA] + dHa * pfRow[SLEW_GRID_NB_HA + 1]);
+    return dMargin < 0 ? SLEW_BELOW_HORIZON : SLEW_OK;
+}
+
+double CSlewLimits::horizonAltitude(double dAzimuth) const
+{
+    size_t nNext, nPrev;
+    double dSpan, dAzPrev;
+
+    if(m_dHorizonAz.empty())
+        return 0.0;
+    if(m_dHorizonAz.size() == 1)
+        return m_dHorizonAlt[0];
+
+    dAzimuth = fmod(fmod(dAzimuth, 360.0) + 360.0, 360.0);
+    nNext = std::upper_bound(m_dHorizonAz.begin(), m_dHorizonAz.end(), dAzimuth) - m_dHorizonAz.begin();
+    // wraps around north between the last and the first point
+    if(nNext == 0 || nNext == m_dHorizonAz.size()) {
+        nPrev = m_dHorizonAz.size() - 1;
+        nNext = 0;
+        dAzPrev = m_dHorizonAz[nPrev] - (dAzimuth < m_dHorizonAz[0] ? 360.0 : 0.0);
+        dSpan = m_dHorizonAz[0] + 360.0 - m_dHorizonAz[nPrev];
+    }
+    else {
+        nPrev = nNext - 1;
+        dAzPrev = m_dHorizonAz[nPrev];
+        dSpan = m_dHorizonAz[nNext] - m_dHorizonAz[nPrev];
+    }
+    if(dSpan <= 0)
+        return m_dHorizonAlt[nPrev];
+    return m_dHorizonAlt[nPrev] + (m_dHorizonAlt[nNext] - m_dHorizonAlt[nPrev]) * (dAzimuth - dAzPrev) / dSpan;
+}
+
+// azimuth from north through east
+void CSlewLimits::altAz(double dHourAngle, double dDec, double dLatitude, double &dAltitude, double &dAzimuth)
+{
+    double dH = dHourAngle * 15.0 * DEG_TO_RAD;
+    double dD = dDec * DEG_TO_RAD;
+    double dL = dLatitude * DEG_TO_RAD;
+
+    dAltitude = asin(std::min(1.0, std::max(-1.0, sin(dD) * sin(dL) + cos(dD) * cos(dL) * cos(dH)))) / DEG_TO_RAD;
+    dAzimuth = atan2(-cos(dD) * sin(dH), sin(dD) * cos(dL) - cos(dD) * sin(dL) * cos(dH)) / DEG_TO_RAD;
+    if(dAzimuth < 0)
+        dAzimuth += 360.0;
+}
+
+void CSlewLimits::build()
+{
+    double dAltitude, dAzimuth;
+
+    m_fMargin.clear();
+    if(!m_bLatitudeKnown || m_dHorizonAz.empty())
+        return;
+
+    m_fMargin.resize((size_t)SLEW_GRID_NB_HA * SLEW_GRID_NB_DEC);
+    for(int nDec = 0; nDec < SLEW_GRID_NB_DEC; nDec++) {
+        for(int nHa = 0; nHa < SLEW_GRID_NB_HA; nHa++) {
+            altAz(-12.0 + nHa * SLEW_GRID_HA_STEP, -90.0 + nDec * SLEW_GRID_DEC_STEP, m_dLatitude, dAltitude, dAzimuth);
+            m_fMargin[(size_t)nDec * SLEW_GRID_NB_HA + nHa] = (float)(dAltitude - horizonAltitude(dAzimuth));
+        }
+    }
+}
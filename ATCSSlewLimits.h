@@ -0,0 +1,57 @@
+#pragma once
+
+// C++ includes
+#include <string>
+#include <vector>
+
+// horizon grid, altitude margins at every node are interpolated bilinearly
+#define SLEW_GRID_HA_STEP       0.1     // hours
+#define SLEW_GRID_DEC_STEP      1.0     // degrees
+#define SLEW_GRID_NB_HA         241     // -12h to +12h
+#define SLEW_GRID_NB_DEC        181     // -90 to +90
+
+enum SlewCheck {SLEW_OK = 0, SLEW_PAST_EAST_LIMIT, SLEW_PAST_WEST_LIMIT, SLEW_BELOW_HORIZON};
+// which soft limits apply to a target. Without a meridian flip both do, under Full(GEM) they are how far past
+// the meridian each side can track : the west one beyond the pole, the east one on the normal side.
+enum SlewSide {SLEW_SIDE_ANY = 0, SLEW_SIDE_BEYOND_POLE, SLEW_SIDE_NORMAL};
+
+// Local check of a slew target, so an impossible one is refused before anything is sent to the controller.
+// Soft limits are hours on each side of the meridian (ATCS::getLimits), checked exactly for the side the target lands on.
+// The horizon mask is the altitude (degrees) a target must be above at each azimuth (degrees, north through east),
+// linearly interpolated and wrapped around. Its margins are precomputed on an hour angle / declination grid
+// when the site latitude or the mask change. Whatever isn't known yet isn't checked.
+class CSlewLimits
+{
+public:
+    CSlewLimits();
+
+    void    setLimits(double dHoursEast, double dHoursWest);
+    void    clearLimits();
+    void    setLatitude(double dLatitude);
+    void    clearLatitude();
+
+    void    setHorizon(const std::vector<double> &dAzimuths, const std::vector<double> &dAltitudes);
+    // text file with one "azimuth altitude" point per line, '#' starts a comment
+    bool    loadHorizon(const std::string &sPath);
+    void    clearHorizon();
+    bool    hasHorizon() const { return !m_dHorizonAz.empty(); }
+
+    // hour angle in hours, positive west, Dec in degrees
+    SlewCheck   check(double dHourAngle, double dDec, SlewSide nSide = SLEW_SIDE_ANY) const;
+    double      horizonAltitude(double dAzimuth) const;
+
+    static void    altAz(double dHourAngle, double dDec, double dLatitude, double &dAltitude, double &dAzimuth);
+
+private:
+    bool    m_bLimitsKnown;
+    double  m_dHoursEast;
+    double  m_dHoursWest;
+    bool    m_bLatitudeKnown;
+    double  m_dLatitude;
+
+    std::vector<double> m_dHorizonAz;      // sorted
+    std::vector<double> m_dHorizonAlt;
+    std::vector<float>  m_fMargin;         // altitude above the horizon at the grid nodes, empty when not checked
+
+    void    build();
+};
@@ -0,0 +1,102 @@
+#include "ATCSSnapshot.h"
+
+#include <stdio.h>
+#include <stdint.h>
+
+#define SNAPSHOT_MAX_STRING     256
+
+#define CHILD_KEY_VERSION       "Version"
+#define CHILD_KEY_FINGERPRINT   "Fingerprint"
+#define CHILD_KEY_FIRMWARE      "Firmware"
+#define CHILD_KEY_MODEL         "Model"
+#define CHILD_KEY_SITE_NUMBER   "SiteNumber"
+#define CHILD_KEY_EPOCH         "Epoch"
+
+void snapshotClear(ControllerSnapshot &snapshot)
+{
+    snapshot.bValid = false;
+    snapshot.sFingerprint.clear();
+    snapshot.sFirmware.clear();
+    snapshot.sModel.clear();
+    snapshot.nSiteNumber = 0;
+    snapshot.sEpoch.clear();
+}
+
+static std::string parentKey(int nInstance)
+{
+    return nInstance ? SNAPSHOT_PARENT_KEY + std::to_string(nInstance) : std::string(SNAPSHOT_PARENT_KEY);
+}
+
+static std::string readIniString(BasicIniUtilInterface *pIniUtil, const std::string &sParentKey, const char *pszChildKey)
+{
+    char szValue[SNAPSHOT_MAX_STRING];
+
+    szValue[0] = 0;
+    pIniUtil->readString(sParentKey.c_str(), pszChildKey, "", szValue, SNAPSHOT_MAX_STRING);
+    return std::string(szValue);
+}
+
+bool snapshotLoad(BasicIniUtilInterface *pIniUtil, int nInstance, ControllerSnapshot &snapshot)
+{
+    std::string sParentKey = parentKey(nInstance);
+
+    snapshotClear(snapshot);
+    if(!pIniUtil)
+        return false;
+
+    if(pIniUtil->readInt(sParentKey.c_str(), CHILD_KEY_VERSION, 0) != SNAPSHOT_VERSION)
+        return false;
+    snapshot.sFingerprint = readIniString(pIniUtil, sParentKey, CHILD_KEY_FINGERPRINT);
+    if(snapshot.sFingerprint.empty())
+        return false;
+
+    snapshot.sFirmware = readIniString(pIniUtil, sParentKey, CHILD_KEY_FIRMWARE);
+    snapshot.sModel = readIniString(pIniUtil, sParentKey, CHILD_KEY_MODEL);
+    snapshot.nSiteNumber = pIniUtil->readInt(sParentKey.c_str(), CHILD_KEY_SITE_NUMBER, 0);
+    snapshot.sEpoch = readIniString(pIniUtil, sParentKey, CHILD_KEY_EPOCH);
+    snapshot.bValid = true;
+    return true;
+}
+
+void snapshotSave(BasicIniUtilInterface *pIniUtil, int nInstance, const ControllerSnapshot &snapshot)
+{
+    std::string sParentKey = parentKey(nInstance);
+
+    if(!pIniUtil)
+        return;
+
+    // the fingerprint goes last, a snapshot interrupted half way doesn't match anything
+    snapshotInvalidate(pIniUtil, nInstance);
+    pIniUtil->writeString(sParentKey.c_str(), CHILD_KEY_FIRMWARE, snapshot.sFirmware.c_str());
+    pIniUtil->writeString(sParentKey.c_str(), CHILD_KEY_MODEL, snapshot.sModel.c_str());
+    pIniUtil->writeInt(sParentKey.c_str(), CHILD_KEY_SITE_NUMBER, snapshot.nSiteNumber);
+    pIniUtil->writeString(sParentKey.c_str(), CHILD_KEY_EPOCH, snapshot.sEpoch.c_str());
+    pIniUtil->writeInt(sParentKey.c_str(), CHILD_KEY_VERSION, SNAPSHOT_VERSION);
+    pIniUtil->writeString(sParentKey.c_str(), CHILD_KEY_FINGERPRINT, snapshot.sFingerprint.c_str());
+}
+
+void snapshotInvalidate(BasicIniUtilInterface *pIniUtil, int nInstance)
+{
+    if(!pIniUtil)
+        return;
+    pIniUtil->writeString(parentKey(nInstance).c_str(), CHILD_KEY_FINGERPRINT, "");
+}
+
+// FNV-1a, the fields are separated so "ab"+"c" and "a"+"bc" don't collide
+std::string snapshotFingerprint(const std::string &sPort, const std::string *psReplies, size_t nReplies)
+{
+    uint64_t nHash = 14695981039346656037ULL;
+    char szHash[32];
+
+    for(size_t i = 0; i <= nReplies; i++) {
+        const std::string &sField = i ? psReplies[i-1] : sPort;
+        for(size_t j = 0; j < sField.size(); j++) {
+            nHash ^= (unsigned char)sField[j];
+            nHash *= 1099511628211ULL;
+        }
+        nHash ^= 0x1F;
+        nHash *= 1099511628211ULL;
+    }
+    snprintf(szHash, sizeof(szHash), "%016llX", (unsigned long long)nHash);
+    return std::string(szHash);
+}
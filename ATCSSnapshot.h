@@ -0,0 +1,48 @@
+#pragma once
+
+// C++ includes
+#include <string>
+#include <vector>
+
+#include "../../licensedinterfaces/basiciniutilinterface.h"
+
+#include "ATCSCommands.h"
+
+#define SNAPSHOT_PARENT_KEY     "ATCSMountSnapshot"     // instance 0, the other instances add their index
+#define SNAPSHOT_VERSION        2       // bump when the stored fields change, older snapshots are ignored
+
+// Read on every connect in the setup batch, they tell us the controller is in the state the snapshot was taken in.
+// HGfv : same controller and firmware, SGuu : same site, ACst : not power cycled since the time was set,
+// NGat/NGam : nobody changed the alignment settings with the hand paddle.
+// NGle/NGlw and TGlf/TGdf can also be changed from the hand paddle, Connect uses these replies directly.
+static const ATCLCommandId g_SnapshotFingerprintCmds[] = {
+    ATCL_CMD_HGFV,
+    ATCL_CMD_SGUU,
+    ATCL_CMD_ACST,
+    ATCL_CMD_NGAT,
+    ATCL_CMD_NGAM,
+    ATCL_CMD_NGLE,
+    ATCL_CMD_NGLW,
+    ATCL_CMD_TGLF,
+    ATCL_CMD_TGDF
+};
+#define SNAPSHOT_NB_FINGERPRINT  (sizeof(g_SnapshotFingerprintCmds)/sizeof(g_SnapshotFingerprintCmds[0]))
+
+// What Connect reads or sets up on a controller, kept between TheSkyX sessions.
+// When the fingerprint still matches, a warm connect takes it from here instead of asking again.
+typedef struct {
+    bool        bValid;
+    std::string sFingerprint;
+    std::string sFirmware;
+    std::string sModel;
+    int         nSiteNumber;
+    std::string sEpoch;     // PSEP arguments, can't be read back
+} ControllerSnapshot;
+
+// each mount instance keeps its own snapshot, nInstance is the X2 multi instance index
+void        snapshotClear(ControllerSnapshot &snapshot);
+bool        snapshotLoad(BasicIniUtilInterface *pIniUtil, int nInstance, ControllerSnapshot &snapshot);
+void        snapshotSave(BasicIniUtilInterface *pIniUtil, int nInstance, const ControllerSnapshot &snapshot);
+void        snapshotInvalidate(BasicIniUtilInterface *pIniUtil, int nInstance);
+// hash of the port and the fingerprint replies, in g_SnapshotFingerprintCmds order
+std::string snapshotFingerprint(const std::string &sPort, const std::string *psReplies, size_t nReplies);
@@ -0,0 +1,60 @@
+#include "ATCSSpscRing.h"
+
+#ifdef SB_LINUX_BUILD
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#endif
+
+// C++ includes
+#include <chrono>
+
+CFutexEvent::CFutexEvent()
+{
+    m_nSeq = 0;
+    m_nWaiters = 0;
+}
+
+bool CFutexEvent::wait(uint32_t nSeq, int nTimeoutMs)
+{
+    bool bSignaled;
+
+    if(m_nSeq.load(std::memory_order_acquire) != nSeq)
+        return true;
+    if(nTimeoutMs <= 0)
+        return false;
+
+    m_nWaiters.fetch_add(1);
+#ifdef SB_LINUX_BUILD
+    struct timespec ts;
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex needs a plain 32 bit word");
+    ts.tv_sec = nTimeoutMs / 1000;
+    ts.tv_nsec = (long)(nTimeoutMs % 1000) * 1000000L;
+    // returns right away (EAGAIN) if notify() already moved the sequence
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_nSeq), FUTEX_WAIT_PRIVATE, nSeq, &ts, NULL, 0);
+    bSignaled = (m_nSeq.load(std::memory_order_acquire) != nSeq);
+#else
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        bSignaled = m_cv.wait_for(lock, std::chrono::milliseconds(nTimeoutMs), [this, nSeq]{ return m_nSeq.load(std::memory_order_acquire) != nSeq; });
+    }
+#endif
+    m_nWaiters.fetch_sub(1);
+    return bSignaled;
+}
+
+void CFutexEvent::notify()
+{
+    // seq_cst on both sides : either the waiter sees the new sequence or we see the waiter
+    m_nSeq.fetch_add(1);
+    if(!m_nWaiters.load())
+        return;
+#ifdef SB_LINUX_BUILD
+    syscall(SYS_futex, reinterpret_cast<uint32_t*>(&m_nSeq), FUTEX_WAKE_PRIVATE, INT32_MAX, NULL, NULL, 0);
+#else
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cv.notify_all();
+#endif
+}
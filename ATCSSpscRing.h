@@ -0,0 +1,112 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// C++ includes
+#include <atomic>
+#ifndef SB_LINUX_BUILD
+#include <mutex>
+#include <condition_variable>
+#endif
+
+#define SPSC_CACHE_LINE     64
+
+// Wait-free single producer / single consumer ring of preallocated slots.
+// The producer fills writeSlot() in place then publish(), the consumer reads readSlot() then release().
+// Head and tail are a cache line apart and each side keeps a private copy of the other side's
+// index, so the shared line is only read when the cached copy says full/empty.
+// N must be a power of 2.
+template <typename T, size_t N>
+class CSpscRing
+{
+public:
+    CSpscRing()
+    {
+        m_nHead = 0;
+        m_nTail = 0;
+        m_nTailCache = 0;
+        m_nHeadCache = 0;
+    }
+
+    // producer
+    T *writeSlot()
+    {
+        size_t nTail = m_nTail.load(std::memory_order_relaxed);
+        if(nTail - m_nHeadCache >= N) {
+            m_nHeadCache = m_nHead.load(std::memory_order_acquire);
+            if(nTail - m_nHeadCache >= N)
+                return NULL;
+        }
+        return &m_Slots[nTail & (N - 1)];
+    }
+
+    void publish()
+    {
+        m_nTail.store(m_nTail.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // consumer
+    T *readSlot()
+    {
+        size_t nHead = m_nHead.load(std::memory_order_relaxed);
+        if(nHead == m_nTailCache) {
+            m_nTailCache = m_nTail.load(std::memory_order_acquire);
+            if(nHead == m_nTailCache)
+                return NULL;
+        }
+        return &m_Slots[nHead & (N - 1)];
+    }
+
+    void release()
+    {
+        m_nHead.store(m_nHead.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // consumer, drop everything published so far
+    void clear()
+    {
+        m_nTailCache = m_nTail.load(std::memory_order_acquire);
+        m_nHead.store(m_nTailCache, std::memory_order_release);
+    }
+
+    // either side, only a hint while the other side is running
+    bool full() const
+    {
+        return m_nTail.load(std::memory_order_acquire) - m_nHead.load(std::memory_order_acquire) >= N;
+    }
+
+private:
+    // consumer line
+    std::atomic<size_t>     m_nHead;
+    size_t                  m_nTailCache;
+    char                    m_Pad1[SPSC_CACHE_LINE - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+    // producer line
+    std::atomic<size_t>     m_nTail;
+    size_t                  m_nHeadCache;
+    char                    m_Pad2[SPSC_CACHE_LINE - sizeof(std::atomic<size_t>) - sizeof(size_t)];
+
+    T                       m_Slots[N];
+};
+
+// Sequence counter a consumer can sleep on once its ring is empty.
+// prepare() before the last emptiness check, then wait() returns as soon as notify() was called
+// after prepare(), so a wakeup can't be lost. notify() is a single atomic add when nobody waits.
+// Uses a futex on Linux, a condition variable elsewhere.
+class CFutexEvent
+{
+public:
+    CFutexEvent();
+
+    uint32_t    prepare() const { return m_nSeq.load(std::memory_order_acquire); }
+    // false on timeout
+    bool        wait(uint32_t nSeq, int nTimeoutMs);
+    void        notify();
+
+private:
+    std::atomic<uint32_t>   m_nSeq;
+    std::atomic<int>        m_nWaiters;
+#ifndef SB_LINUX_BUILD
+    std::mutex              m_mutex;
+    std::condition_variable m_cv;
+#endif
+};
@@ -0,0 +1,63 @@
+#include "ATCSTiming.h"
+
+#include <iomanip>
+
+std::atomic<CTimingSite*> CTimingSite::m_pFirst(NULL);
+
+CTimingSite::CTimingSite(const char *pszName)
+{
+    m_pszName = pszName;
+    m_nCount = 0;
+    m_nTotalNs = 0;
+    m_nMaxNs = 0;
+
+    // lock free push on the site list, sites are never removed
+    m_pNext = m_pFirst.load();
+    while(!m_pFirst.compare_exchange_weak(m_pNext, this))
+        ;
+}
+
+void CTimingSite::record(int64_t nNs)
+{
+    int64_t nMax;
+
+    m_nCount++;
+    m_nTotalNs += nNs;
+    nMax = m_nMaxNs.load();
+    while(nNs > nMax && !m_nMaxNs.compare_exchange_weak(nMax, nNs))
+        ;
+}
+
+void CTimingSite::reset()
+{
+    m_nCount = 0;
+    m_nTotalNs = 0;
+    m_nMaxNs = 0;
+}
+
+void CTimingSite::report(std::ostream &os)
+{
+    CTimingSite *pSite;
+    uint64_t nCount;
+    std::ios::fmtflags oldFlags = os.flags();
+    std::streamsize nOldPrecision = os.precision();
+
+    for(pSite = m_pFirst.load(); pSite; pSite = pSite->m_pNext) {
+        nCount = pSite->count();
+        if(!nCount)
+            continue;
+        os << pSite->name() << " : " << nCount << " calls, mean " << std::fixed << std::setprecision(3)
+           << double(pSite->totalNs()) / double(nCount) / 1.0e6 << " ms, max "
+           << double(pSite->maxNs()) / 1.0e6 << " ms" << std::endl;
+    }
+    os.flags(oldFlags);
+    os.precision(nOldPrecision);
+}
+
+void CTimingSite::resetAll()
+{
+    CTimingSite *pSite;
+
+    for(pSite = m_pFirst.load(); pSite; pSite = pSite->m_pNext)
+        pSite->reset();
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include <stdint.h>
+
+// C++ includes
+#include <chrono>
+#include <atomic>
+#include <ostream>
+#include <type_traits>
+
+#include "ATCSTrace.h"
+
+// Monotonic timer in nanoseconds.
+// steady_clock doesn't jump when NTP or the user changes the system time.
+class CSteadyTimer
+{
+public:
+    CSteadyTimer() { Reset(); }
+
+    inline void     Reset() { m_Start = std::chrono::steady_clock::now(); }
+
+    inline int64_t  GetElapsedNs() const
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_Start).count();
+    }
+    inline double   GetElapsedMs() const { return double(GetElapsedNs()) / 1.0e6; }
+    inline double   GetElapsedSeconds() const { return double(GetElapsedNs()) / 1.0e9; }
+
+    static inline int64_t NowNs()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    std::chrono::steady_clock::time_point m_Start;
+};
+
+
+// Accumulated timing for one instrumented code location.
+// Sites are static objects, they link themselves into a process wide list on first use.
+class CTimingSite
+{
+public:
+    CTimingSite(const char *pszName);
+
+    void        record(int64_t nNs);
+    void        reset();
+
+    const char  *name() const { return m_pszName; }
+    uint64_t    count() const { return m_nCount; }
+    int64_t     totalNs() const { return m_nTotalNs; }
+    int64_t     maxNs() const { return m_nMaxNs; }
+
+    // one line per site that was hit : name, count, mean, max
+    static void report(std::ostream &os);
+    static void resetAll();
+
+private:
+    const char              *m_pszName;
+    std::atomic<uint64_t>   m_nCount;
+    std::atomic<int64_t>    m_nTotalNs;
+    std::atomic<int64_t>    m_nMaxNs;
+    CTimingSite             *m_pNext;
+
+    static std::atomic<CTimingSite*>    m_pFirst;
+};
+
+
+// Times the enclosing scope into a CTimingSite (and the trace when enabled)
+class CScopedSpan
+{
+public:
+    CScopedSpan(CTimingSite &site) : m_Site(site) { m_nStartNs = CSteadyTimer::NowNs(); }
+    ~CScopedSpan()
+    {
+        int64_t nDurationNs = CSteadyTimer::NowNs() - m_nStartNs;
+        m_Site.record(nDurationNs);
+        if(CATCSTracer::enabled())
+            CATCSTracer::complete(m_Site.name(), m_nStartNs, nDurationNs);
+    }
+
+private:
+    CScopedSpan(const CScopedSpan&);
+    CScopedSpan &operator=(const CScopedSpan&);
+
+    CTimingSite &m_Site;
+    int64_t     m_nStartNs;
+};
+
+// Scoped lock (std::mutex or X2 MutexInterface) that records how long it waited for the lock.
+// Like X2MutexLocker a NULL mutex is accepted and does nothing.
+template <class MutexType>
+class CTimedMutexLocker
+{
+public:
+    CTimedMutexLocker(MutexType *pMutex, CTimingSite &site) : m_pMutex(pMutex)
+    {
+        int64_t nStartNs;
+        int64_t nWaitNs;
+
+        if(!m_pMutex)
+            return;
+        nStartNs = CSteadyTimer::NowNs();
+        m_pMutex->lock();
+        nWaitNs = CSteadyTimer::NowNs() - nStartNs;
+        site.record(nWaitNs);
+        if(CATCSTracer::enabled())
+            CATCSTracer::complete(site.name(), nStartNs, nWaitNs);
+    }
+    ~CTimedMutexLocker()
+    {
+        if(m_pMutex)
+            m_pMutex->unlock();
+    }
+
+private:
+    CTimedMutexLocker(const CTimedMutexLocker&);
+    CTimedMutexLocker &operator=(const CTimedMutexLocker&);
+
+    MutexType   *m_pMutex;
+};
+
+#define ATCS_SPAN_CONCAT2(a, b) a##b
+#define ATCS_SPAN_CONCAT(a, b)  ATCS_SPAN_CONCAT2(a, b)
+// ATCS_SCOPED_SPAN("X2Mount::getRaAndDec"); times everything until the end of the scope
+#define ATCS_SCOPED_SPAN(pszName) \
+    static CTimingSite ATCS_SPAN_CONCAT(atcsSpanSite_, __LINE__)(pszName); \
+    CScopedSpan ATCS_SPAN_CONCAT(atcsSpan_, __LINE__)(ATCS_SPAN_CONCAT(atcsSpanSite_, __LINE__))
+
+// ATCS_TIMED_LOCK(lock, &m_mutex, "mutex wait"); same as a lock guard named lock, timing the wait
+#define ATCS_TIMED_LOCK(lockName, pMutex, pszName) \
+    static CTimingSite ATCS_SPAN_CONCAT(atcsLockSite_, __LINE__)(pszName); \
+    CTimedMutexLocker<std::remove_pointer<decltype(pMutex)>::type> lockName(pMutex, ATCS_SPAN_CONCAT(atcsLockSite_, __LINE__))
@@ -0,0 +1,118 @@
+#include "ATCSTrace.h"
+
+#include "../../licensedinterfaces/sberrorx.h"
+
+std::atomic<bool>                   CATCSTracer::m_bEnabled(false);
+std::mutex                          CATCSTracer::m_mutex;
+std::vector<CATCSTracer::TraceEvent> CATCSTracer::m_vEvents;
+size_t                              CATCSTracer::m_nHead = 0;
+size_t                              CATCSTracer::m_nCount = 0;
+uint64_t                            CATCSTracer::m_nDropped = 0;
+std::ofstream                       CATCSTracer::m_TraceFile;
+bool                                CATCSTracer::m_bFirstEvent = true;
+std::atomic<int>                    CATCSTracer::m_nNextTid(1);
+
+bool CATCSTracer::start(const std::string &sPath)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if(m_bEnabled)
+        return true; // already tracing, all instances share the same file
+
+    m_TraceFile.open(sPath, std::ios::out | std::ios::trunc);
+    if(!m_TraceFile.is_open())
+        return false;
+    // the closing ']' is optional in the JSON array format, so flushes can just append
+    m_TraceFile << "[" << std::endl;
+    m_bFirstEvent = true;
+    m_vEvents.resize(TRACE_MAX_EVENTS);
+    m_nHead = 0;
+    m_nCount = 0;
+    m_nDropped = 0;
+    m_bEnabled = true;
+    return true;
+}
+
+void CATCSTracer::stop()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if(!m_bEnabled)
+        return;
+    m_bEnabled = false;
+    writeEvents();
+    m_TraceFile << std::endl << "]" << std::endl;
+    m_TraceFile.close();
+    std::vector<TraceEvent>().swap(m_vEvents);
+}
+
+int CATCSTracer::threadId()
+{
+    static thread_local int nTid = 0;
+
+    if(!nTid)
+        nTid = m_nNextTid++;
+    return nTid;
+}
+
+void CATCSTracer::complete(const char *pszName, int64_t nStartNs, int64_t nDurationNs)
+{
+    size_t nSlot;
+    int nTid;
+
+    if(!enabled())
+        return;
+
+    nTid = threadId();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_vEvents.empty())
+        return;
+
+    if(m_nCount < m_vEvents.size()) {
+        nSlot = (m_nHead + m_nCount) % m_vEvents.size();
+        m_nCount++;
+    }
+    else {
+        // full, overwrite the oldest
+        nSlot = m_nHead;
+        m_nHead = (m_nHead + 1) % m_vEvents.size();
+        m_nDropped++;
+    }
+    m_vEvents[nSlot].pszName = pszName;
+    m_vEvents[nSlot].nStartNs = nStartNs;
+    m_vEvents[nSlot].nDurationNs = nDurationNs;
+    m_vEvents[nSlot].nTid = nTid;
+}
+
+int CATCSTracer::flush()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if(!m_bEnabled)
+        return SB_OK;
+    return writeEvents();
+}
+
+// called with m_mutex held
+int CATCSTracer::writeEvents()
+{
+    size_t i;
+    const TraceEvent *pEvent;
+
+    for(i = 0; i < m_nCount; i++) {
+        pEvent = &m_vEvents[(m_nHead + i) % m_vEvents.size()];
+        if(!m_bFirstEvent)
+            m_TraceFile << "," << std::endl;
+        m_bFirstEvent = false;
+        // timestamps are in us, keep the ns as fraction
+        m_TraceFile << "{\"name\":\"" << pEvent->pszName << "\",\"cat\":\"ATCS\",\"ph\":\"X\",\"pid\":1,\"tid\":" << pEvent->nTid
+                    << ",\"ts\":" << pEvent->nStartNs / 1000 << "." << (pEvent->nStartNs % 1000) / 100
+                    << ",\"dur\":" << pEvent->nDurationNs / 1000 << "." << (pEvent->nDurationNs % 1000) / 100 << "}";
+    }
+    m_nHead = 0;
+    m_nCount = 0;
+    m_TraceFile.flush();
+    if(!m_TraceFile.good())
+        return ERR_CMDFAILED;
+    return SB_OK;
+}
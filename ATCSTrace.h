@@ -0,0 +1,49 @@
+#pragma once
+#include <stdint.h>
+
+// C++ includes
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <fstream>
+
+#define TRACE_MAX_EVENTS    65536   // events kept in memory between flushes, oldest are dropped first
+
+// Chrome / Perfetto trace-event recorder (JSON array format, "X" complete events).
+// Process wide and off by default. When enabled every CScopedSpan also lands here
+// so X2Mount calls, lock waits, transport reads/writes and parsing show up as
+// nested slices per thread. Events stay in a bounded ring buffer until flush().
+class CATCSTracer
+{
+public:
+    static bool     start(const std::string &sPath);
+    static void     stop();
+    static inline bool enabled() { return m_bEnabled.load(std::memory_order_relaxed); }
+
+    static void     complete(const char *pszName, int64_t nStartNs, int64_t nDurationNs);
+    static int      flush();
+
+    static uint64_t droppedEvents() { return m_nDropped; }
+
+private:
+    typedef struct {
+        const char  *pszName;   // span names are string literals
+        int64_t     nStartNs;
+        int64_t     nDurationNs;
+        int         nTid;
+    } TraceEvent;
+
+    static int      threadId();
+    static int      writeEvents();
+
+    static std::atomic<bool>        m_bEnabled;
+    static std::mutex               m_mutex;
+    static std::vector<TraceEvent>  m_vEvents;
+    static size_t                   m_nHead;        // oldest event once the buffer wrapped
+    static size_t                   m_nCount;
+    static uint64_t                 m_nDropped;
+    static std::ofstream            m_TraceFile;
+    static bool                     m_bFirstEvent;
+    static std::atomic<int>         m_nNextTid;
+};
@@ -0,0 +1,79 @@
+#include "ATCSTransport.h"
+
+SerXTransport::SerXTransport()
+{
+    m_pSerx = NULL;
+}
+
+int SerXTransport::open(const char *pszPort)
+{
+    if(!m_pSerx)
+        return ERR_POINTER;
+
+    // 19200 8N1
+    if(m_pSerx->open(pszPort, 19200, SerXInterface::B_NOPARITY, "-DTR_CONTROL 1") != 0)
+        return ERR_COMMNOLINK;
+    return SB_OK;
+}
+
+int SerXTransport::close()
+{
+    if(!m_pSerx)
+        return ERR_POINTER;
+
+    m_pSerx->flushTx();
+    m_pSerx->purgeTxRx();
+    return m_pSerx->close();
+}
+
+bool SerXTransport::isConnected() const
+{
+    if(!m_pSerx)
+        return false;
+    return m_pSerx->isConnected();
+}
+
+int SerXTransport::write(const char *pBuf, unsigned long ulSize)
+{
+    int nErr;
+    unsigned long  ulBytesWrite;
+
+    nErr = m_pSerx->writeFile((void *)pBuf, ulSize, ulBytesWrite);
+    m_pSerx->flushTx();
+    if(nErr)
+        return nErr;
+    if(ulBytesWrite != ulSize)
+        return ERR_CMDFAILED;
+    return SB_OK;
+}
+
+int SerXTransport::read(char *pBuf, unsigned long ulMaxSize, unsigned long &ulBytesRead, int nTimeoutMs)
+{
+    int nErr = SB_OK;
+    int nBytesWaiting = 0;
+    int nWaited = 0;
+
+    ulBytesRead = 0;
+    // SerXInterface has no blocking wait we can rely on, so poll bytesWaitingRx
+    while(true) {
+        nErr = m_pSerx->bytesWaitingRx(nBytesWaiting);
+        if(nErr)
+            return nErr;
+        if(nBytesWaiting)
+            break;
+        if(nWaited >= nTimeoutMs)
+            return ERR_RXTIMEOUT;
+        std::this_thread::sleep_for(std::chrono::milliseconds(TRANSPORT_READ_WAIT_TIMEOUT));
+        nWaited += TRANSPORT_READ_WAIT_TIMEOUT;
+    }
+
+    if((unsigned long)nBytesWaiting > ulMaxSize)
+        nBytesWaiting = (int)ulMaxSize;
+
+    return m_pSerx->readFile(pBuf, nBytesWaiting, ulBytesRead, nTimeoutMs);
+}
+
+int SerXTransport::purge()
+{
+    return m_pSerx->purgeTxRx();
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <stdlib.h>
+#include <string.h>
+
+// C++ includes
+#include <chrono>
+#include <thread>
+
+#include "../../licensedinterfaces/sberrorx.h"
+#include "../../licensedinterfaces/serxinterface.h"
+
+#define TRANSPORT_READ_WAIT_TIMEOUT 25  // ms between bytesWaitingRx polls on transports that can't block
+
+enum ATCSTransportType {TRANSPORT_SERX=0, TRANSPORT_NATIVE_SERIAL, TRANSPORT_TCP};
+
+// Byte link to the ATCS controller.
+// All calls return SB_OK on success, ERR_RXTIMEOUT when no data arrived in time
+// or another sberrorx.h code on failure.
+class ATCSTransport
+{
+public:
+    virtual ~ATCSTransport() {}
+
+    virtual int     open(const char *pszPort) = 0;
+    virtual int     close() = 0;
+    virtual bool    isConnected() const = 0;
+
+    // write the whole buffer
+    virtual int     write(const char *pBuf, unsigned long ulSize) = 0;
+    // wait up to nTimeoutMs for data, then return what is available (at most ulMaxSize bytes)
+    virtual int     read(char *pBuf, unsigned long ulMaxSize, unsigned long &ulBytesRead, int nTimeoutMs) = 0;
+    // drop anything pending in both directions
+    virtual int     purge() = 0;
+
+    // file descriptor usable with poll/epoll, -1 if the transport can only be polled
+    virtual int     pollFd() const { return -1; }
+    virtual const char *name() const = 0;
+};
+
+
+// Transport going through TheSkyX SerXInterface (default, works on all platforms)
+class SerXTransport : public ATCSTransport
+{
+public:
+    SerXTransport();
+
+    void    setSerxPointer(SerXInterface *p) { m_pSerx = p; }
+
+    virtual int     open(const char *pszPort);
+    virtual int     close();
+    virtual bool    isConnected() const;
+
+    virtual int     write(const char *pBuf, unsigned long ulSize);
+    virtual int     read(char *pBuf, unsigned long ulMaxSize, unsigned long &ulBytesRead, int nTimeoutMs);
+    virtual int     purge();
+
+    virtual const char *name() const { return "SerX"; }
+
+private:
+    SerXInterface   *m_pSerx;
+};
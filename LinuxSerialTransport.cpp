@@ -0,0 +1,234 @@
+#include "LinuxSerialTransport.h"
+
+#ifdef SB_LINUX_BUILD
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <sys/ioctl.h>
+#include <linux/serial.h>
+
+LinuxSerialTransport::LinuxSerialTransport()
+{
+    m_nFd = -1;
+    m_nEpollFd = -1;
+    m_bTermiosSaved = false;
+    m_nOldSerialFlags = 0;
+    m_bLowLatencySet = false;
+}
+
+LinuxSerialTransport::~LinuxSerialTransport()
+{
+    close();
+}
+
+int LinuxSerialTransport::open(const char *pszPort)
+{
+    int nErr;
+    struct epoll_event ev;
+
+    if(m_nFd >= 0)
+        close();
+
+    m_nFd = ::open(pszPort, O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if(m_nFd < 0)
+        return ERR_COMMNOLINK;
+
+    if(tcgetattr(m_nFd, &m_OldTermios) == 0)
+        m_bTermiosSaved = true;
+
+    nErr = setLineParameters();
+    if(nErr) {
+        close();
+        return nErr;
+    }
+    setLowLatency();
+
+    m_nEpollFd = epoll_create1(EPOLL_CLOEXEC);
+    if(m_nEpollFd < 0) {
+        close();
+        return ERR_COMMNOLINK;
+    }
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.fd = m_nFd;
+    if(epoll_ctl(m_nEpollFd, EPOLL_CTL_ADD, m_nFd, &ev) < 0) {
+        close();
+        return ERR_COMMNOLINK;
+    }
+
+    tcflush(m_nFd, TCIOFLUSH);
+    return SB_OK;
+}
+
+int LinuxSerialTransport::close()
+{
+    if(m_nEpollFd >= 0) {
+        ::close(m_nEpollFd);
+        m_nEpollFd = -1;
+    }
+    if(m_nFd >= 0) {
+        tcflush(m_nFd, TCIOFLUSH);
+        restoreLowLatency();
+        if(m_bTermiosSaved)
+            tcsetattr(m_nFd, TCSANOW, &m_OldTermios);
+        ::close(m_nFd);
+        m_nFd = -1;
+    }
+    m_bTermiosSaved = false;
+    return SB_OK;
+}
+
+int LinuxSerialTransport::setLineParameters()
+{
+    struct termios tio;
+    int nModemBits;
+
+    if(tcgetattr(m_nFd, &tio) < 0)
+        return ERR_COMMNOLINK;
+
+    // 19200 8N1, raw, no flow control
+    cfmakeraw(&tio);
+    cfsetispeed(&tio, B19200);
+    cfsetospeed(&tio, B19200);
+    tio.c_cflag &= ~(CSIZE | PARENB | CSTOPB | CRTSCTS);
+    tio.c_cflag |= CS8 | CLOCAL | CREAD;
+    tio.c_iflag &= ~(IXON | IXOFF | IXANY);
+
+    // The smallest ATCL frame is a single ACK/NACK byte, so the line discipline must
+    // wake us up on the first byte (VMIN=1). VTIME=0 as the deadline is enforced by epoll.
+    tio.c_cc[VMIN] = 1;
+    tio.c_cc[VTIME] = 0;
+
+    if(tcsetattr(m_nFd, TCSANOW, &tio) < 0)
+        return ERR_COMMNOLINK;
+
+    // same as SerX "-DTR_CONTROL 1"
+    nModemBits = TIOCM_DTR;
+    ioctl(m_nFd, TIOCMBIS, &nModemBits);
+
+    return SB_OK;
+}
+
+void LinuxSerialTransport::setLowLatency()
+{
+    struct serial_struct serial;
+
+    m_bLowLatencySet = false;
+    // not all tty drivers support this (pty, some CDC-ACM), failing is not an error.
+    if(ioctl(m_nFd, TIOCGSERIAL, &serial) < 0)
+        return;
+    m_nOldSerialFlags = serial.flags;
+    if(serial.flags & ASYNC_LOW_LATENCY) {
+        m_bLowLatencySet = true;
+        return;
+    }
+    serial.flags |= ASYNC_LOW_LATENCY;
+    if(ioctl(m_nFd, TIOCSSERIAL, &serial) == 0)
+        m_bLowLatencySet = true;
+}
+
+void LinuxSerialTransport::restoreLowLatency()
+{
+    struct serial_struct serial;
+
+    if(!m_bLowLatencySet || (m_nOldSerialFlags & ASYNC_LOW_LATENCY))
+        return;
+    if(ioctl(m_nFd, TIOCGSERIAL, &serial) < 0)
+        return;
+    serial.flags = m_nOldSerialFlags;
+    ioctl(m_nFd, TIOCSSERIAL, &serial);
+    m_bLowLatencySet = false;
+}
+
+int LinuxSerialTransport::waitFor(unsigned int nEvents, int nTimeoutMs)
+{
+    int nRet;
+    struct epoll_event ev;
+    struct pollfd pfd;
+
+    if(nEvents == EPOLLIN) {
+        nRet = epoll_wait(m_nEpollFd, &ev, 1, nTimeoutMs);
+    }
+    else {
+        pfd.fd = m_nFd;
+        pfd.events = POLLOUT;
+        pfd.revents = 0;
+        nRet = poll(&pfd, 1, nTimeoutMs);
+    }
+    if(nRet < 0 && errno == EINTR)
+        return SB_OK; // caller re-checks its deadline
+    if(nRet < 0)
+        return ERR_CMDFAILED;
+    if(nRet == 0)
+        return ERR_RXTIMEOUT;
+    return SB_OK;
+}
+
+int LinuxSerialTransport::write(const char *pBuf, unsigned long ulSize)
+{
+    int nErr;
+    ssize_t nWritten;
+    unsigned long ulTotal = 0;
+
+    if(m_nFd < 0)
+        return ERR_NOLINK;
+
+    while(ulTotal < ulSize) {
+        nWritten = ::write(m_nFd, pBuf + ulTotal, ulSize - ulTotal);
+        if(nWritten > 0) {
+            ulTotal += nWritten;
+            continue;
+        }
+        if(nWritten < 0 && errno == EINTR)
+            continue;
+        if(nWritten < 0 && errno != EAGAIN)
+            return ERR_CMDFAILED;
+        // output queue full, wait for room
+        nErr = waitFor(POLLOUT, 1000);
+        if(nErr)
+            return nErr;
+    }
+    return SB_OK;
+}
+
+int LinuxSerialTransport::read(char *pBuf, unsigned long ulMaxSize, unsigned long &ulBytesRead, int nTimeoutMs)
+{
+    int nErr;
+    ssize_t nRead;
+    long long nRemaining;
+    std::chrono::steady_clock::time_point deadline;
+
+    ulBytesRead = 0;
+    if(m_nFd < 0)
+        return ERR_NOLINK;
+
+    deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(nTimeoutMs);
+    while(true) {
+        nRead = ::read(m_nFd, pBuf, ulMaxSize);
+        if(nRead > 0) {
+            ulBytesRead = (unsigned long)nRead;
+            return SB_OK;
+        }
+        if(nRead < 0 && errno != EAGAIN && errno != EINTR)
+            return ERR_CMDFAILED;
+
+        nRemaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if(nRemaining <= 0)
+            return ERR_RXTIMEOUT;
+        nErr = waitFor(EPOLLIN, (int)nRemaining);
+        if(nErr)
+            return nErr;
+    }
+}
+
+int LinuxSerialTransport::purge()
+{
+    if(m_nFd < 0)
+        return ERR_NOLINK;
+    tcflush(m_nFd, TCIOFLUSH);
+    return SB_OK;
+}
+
+#endif
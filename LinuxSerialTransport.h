@@ -0,0 +1,46 @@
+#pragma once
+
+#include "ATCSTransport.h"
+
+#ifdef SB_LINUX_BUILD
+#include <termios.h>
+
+// Direct termios access to the tty, bypassing SerXInterface.
+// Reads block in epoll until data arrives or the deadline expires instead of
+// sleeping between bytesWaitingRx polls, and USB-serial adapters are switched to
+// low latency mode so the FTDI 16ms latency timer doesn't delay every reply.
+class LinuxSerialTransport : public ATCSTransport
+{
+public:
+    LinuxSerialTransport();
+    virtual ~LinuxSerialTransport();
+
+    virtual int     open(const char *pszPort);
+    virtual int     close();
+    virtual bool    isConnected() const { return m_nFd >= 0; }
+
+    virtual int     write(const char *pBuf, unsigned long ulSize);
+    virtual int     read(char *pBuf, unsigned long ulMaxSize, unsigned long &ulBytesRead, int nTimeoutMs);
+    virtual int     purge();
+
+    virtual int     pollFd() const { return m_nFd; }
+    virtual const char *name() const { return "Linux serial"; }
+
+    bool    isLowLatency() const { return m_bLowLatencySet; }
+
+private:
+    int     m_nFd;
+    int     m_nEpollFd;
+
+    struct termios  m_OldTermios;
+    bool    m_bTermiosSaved;
+    int     m_nOldSerialFlags;
+    bool    m_bLowLatencySet;
+
+    int     setLineParameters();
+    void    setLowLatency();
+    void    restoreLowLatency();
+    int     waitFor(unsigned int nEvents, int nTimeoutMs);
+};
+
+#endif
@@ -0,0 +1,277 @@
+#include "TCPTransport.h"
+
+#ifndef SB_WIN_BUILD
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+
+TCPTransport::TCPTransport()
+{
+    m_nSocket = -1;
+    m_bWaitingReply = false;
+    resetLatencyStats();
+}
+
+TCPTransport::~TCPTransport()
+{
+    close();
+}
+
+void TCPTransport::resetLatencyStats()
+{
+    std::lock_guard<std::mutex> lock(m_StatsMutex);
+    m_Stats.ulSamples = 0;
+    m_Stats.llMin = 0;
+    m_Stats.llMax = 0;
+    m_Stats.llTotal = 0;
+    m_Stats.llLast = 0;
+}
+
+void TCPTransport::getLatencyStats(TransportLatencyStats &stats) const
+{
+    std::lock_guard<std::mutex> lock(m_StatsMutex);
+    stats = m_Stats;
+}
+
+void TCPTransport::addLatencySample(long long llLatency)
+{
+    std::lock_guard<std::mutex> lock(m_StatsMutex);
+    m_Stats.llLast = llLatency;
+    if(!m_Stats.ulSamples || llLatency < m_Stats.llMin)
+        m_Stats.llMin = llLatency;
+    if(llLatency > m_Stats.llMax)
+        m_Stats.llMax = llLatency;
+    m_Stats.llTotal += llLatency;
+    m_Stats.ulSamples++;
+}
+
+int TCPTransport::parseAddress(const char *pszPort, std::string &sHost, std::string &sService)
+{
+    std::string sAddress;
+    size_t nPos;
+
+    if(!pszPort)
+        return ERR_POINTER;
+
+    sAddress.assign(pszPort);
+    nPos = sAddress.rfind(':');
+    if(nPos == std::string::npos || nPos == 0 || nPos == sAddress.size()-1)
+        return ERR_COMMOPENING;
+
+    sHost = sAddress.substr(0, nPos);
+    sService = sAddress.substr(nPos+1);
+    // [ipv6]:port
+    if(sHost.size() > 2 && sHost[0] == '[' && sHost[sHost.size()-1] == ']')
+        sHost = sHost.substr(1, sHost.size()-2);
+    return SB_OK;
+}
+
+int TCPTransport::open(const char *pszPort)
+{
+    int nErr;
+    std::string sHost;
+    std::string sService;
+    struct addrinfo hints;
+    struct addrinfo *pResult = NULL;
+    struct addrinfo *pAddr;
+
+    if(m_nSocket >= 0)
+        close();
+
+    nErr = parseAddress(pszPort, sHost, sService);
+    if(nErr)
+        return nErr;
+
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if(getaddrinfo(sHost.c_str(), sService.c_str(), &hints, &pResult) != 0)
+        return ERR_COMMNOLINK;
+
+    nErr = ERR_COMMNOLINK;
+    for(pAddr = pResult; pAddr; pAddr = pAddr->ai_next) {
+        m_nSocket = socket(pAddr->ai_family, pAddr->ai_socktype, pAddr->ai_protocol);
+        if(m_nSocket < 0)
+            continue;
+        fcntl(m_nSocket, F_SETFD, FD_CLOEXEC);
+        fcntl(m_nSocket, F_SETFL, fcntl(m_nSocket, F_GETFL) | O_NONBLOCK);
+        nErr = connectWithTimeout(pAddr->ai_addr, (unsigned int)pAddr->ai_addrlen, TCP_CONNECT_TIMEOUT);
+        if(!nErr)
+            break;
+        ::close(m_nSocket);
+        m_nSocket = -1;
+    }
+    freeaddrinfo(pResult);
+    if(nErr)
+        return nErr;
+
+    setSocketOptions();
+    m_bWaitingReply = false;
+    return SB_OK;
+}
+
+int TCPTransport::connectWithTimeout(const struct sockaddr *pAddr, unsigned int nAddrLen, int nTimeoutMs)
+{
+    int nSockErr = 0;
+    socklen_t nLen = sizeof(nSockErr);
+
+    if(connect(m_nSocket, pAddr, (socklen_t)nAddrLen) == 0)
+        return SB_OK;
+    if(errno != EINPROGRESS)
+        return ERR_COMMNOLINK;
+
+    if(waitFor(POLLOUT, nTimeoutMs))
+        return ERR_COMMNOLINK;
+    if(getsockopt(m_nSocket, SOL_SOCKET, SO_ERROR, &nSockErr, &nLen) < 0 || nSockErr)
+        return ERR_COMMNOLINK;
+    return SB_OK;
+}
+
+void TCPTransport::setSocketOptions()
+{
+    int nVal;
+
+    nVal = 1;
+    setsockopt(m_nSocket, IPPROTO_TCP, TCP_NODELAY, &nVal, sizeof(nVal));
+    nVal = 1;
+    setsockopt(m_nSocket, SOL_SOCKET, SO_KEEPALIVE, &nVal, sizeof(nVal));
+#if defined(TCP_KEEPIDLE)
+    nVal = TCP_KEEPALIVE_IDLE;
+    setsockopt(m_nSocket, IPPROTO_TCP, TCP_KEEPIDLE, &nVal, sizeof(nVal));
+#elif defined(TCP_KEEPALIVE)
+    // macOS name for TCP_KEEPIDLE
+    nVal = TCP_KEEPALIVE_IDLE;
+    setsockopt(m_nSocket, IPPROTO_TCP, TCP_KEEPALIVE, &nVal, sizeof(nVal));
+#endif
+#if defined(TCP_KEEPINTVL)
+    nVal = TCP_KEEPALIVE_INTERVAL;
+    setsockopt(m_nSocket, IPPROTO_TCP, TCP_KEEPINTVL, &nVal, sizeof(nVal));
+#endif
+#if defined(TCP_KEEPCNT)
+    nVal = TCP_KEEPALIVE_COUNT;
+    setsockopt(m_nSocket, IPPROTO_TCP, TCP_KEEPCNT, &nVal, sizeof(nVal));
+#endif
+#if defined(SO_NOSIGPIPE)
+    nVal = 1;
+    setsockopt(m_nSocket, SOL_SOCKET, SO_NOSIGPIPE, &nVal, sizeof(nVal));
+#endif
+}
+
+int TCPTransport::close()
+{
+    if(m_nSocket >= 0) {
+        shutdown(m_nSocket, SHUT_RDWR);
+        ::close(m_nSocket);
+        m_nSocket = -1;
+    }
+    m_bWaitingReply = false;
+    return SB_OK;
+}
+
+int TCPTransport::waitFor(short nEvents, int nTimeoutMs)
+{
+    int nRet;
+    struct pollfd pfd;
+
+    pfd.fd = m_nSocket;
+    pfd.events = nEvents;
+    pfd.revents = 0;
+    nRet = poll(&pfd, 1, nTimeoutMs);
+    if(nRet < 0 && errno == EINTR)
+        return SB_OK; // caller re-checks its deadline
+    if(nRet < 0)
+        return ERR_CMDFAILED;
+    if(nRet == 0)
+        return ERR_RXTIMEOUT;
+    if((pfd.revents & (POLLERR | POLLNVAL)) || ((pfd.revents & POLLHUP) && !(pfd.revents & POLLIN)))
+        return ERR_COMMNOLINK;
+    return SB_OK;
+}
+
+int TCPTransport::write(const char *pBuf, unsigned long ulSize)
+{
+    int nErr;
+    int nFlags = 0;
+    ssize_t nWritten;
+    unsigned long ulTotal = 0;
+
+    if(m_nSocket < 0)
+        return ERR_NOLINK;
+
+#if defined(MSG_NOSIGNAL)
+    nFlags = MSG_NOSIGNAL;
+#endif
+    // taken before sending, the reply can be back before send() returns to us
+    m_WriteTime = std::chrono::steady_clock::now();
+    while(ulTotal < ulSize) {
+        nWritten = send(m_nSocket, pBuf + ulTotal, ulSize - ulTotal, nFlags);
+        if(nWritten > 0) {
+            ulTotal += nWritten;
+            continue;
+        }
+        if(nWritten < 0 && errno == EINTR)
+            continue;
+        if(nWritten < 0 && errno != EAGAIN && errno != EWOULDBLOCK)
+            return ERR_COMMNOLINK;
+        nErr = waitFor(POLLOUT, 1000);
+        if(nErr)
+            return nErr;
+    }
+    m_bWaitingReply = true;
+    return SB_OK;
+}
+
+int TCPTransport::read(char *pBuf, unsigned long ulMaxSize, unsigned long &ulBytesRead, int nTimeoutMs)
+{
+    int nErr;
+    ssize_t nRead;
+    long long nRemaining;
+    std::chrono::steady_clock::time_point deadline;
+
+    ulBytesRead = 0;
+    if(m_nSocket < 0)
+        return ERR_NOLINK;
+
+    deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(nTimeoutMs);
+    while(true) {
+        nRead = recv(m_nSocket, pBuf, ulMaxSize, 0);
+        if(nRead > 0) {
+            ulBytesRead = (unsigned long)nRead;
+            if(m_bWaitingReply) {
+                m_bWaitingReply = false;
+                addLatencySample(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - m_WriteTime).count());
+            }
+            return SB_OK;
+        }
+        if(nRead == 0)
+            return ERR_COMMNOLINK; // bridge closed the connection
+        if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+            return ERR_COMMNOLINK;
+
+        nRemaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if(nRemaining <= 0)
+            return ERR_RXTIMEOUT;
+        nErr = waitFor(POLLIN, (int)nRemaining);
+        if(nErr)
+            return nErr;
+    }
+}
+
+int TCPTransport::purge()
+{
+    char szDrain[256];
+
+    if(m_nSocket < 0)
+        return ERR_NOLINK;
+    // nothing to flush on the TX side, drop whatever is already received
+    while(recv(m_nSocket, szDrain, sizeof(szDrain), 0) > 0)
+        ;
+    m_bWaitingReply = false;
+    return SB_OK;
+}
+
+#endif
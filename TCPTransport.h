@@ -0,0 +1,65 @@
+#pragma once
+
+#include "ATCSTransport.h"
+
+#ifndef SB_WIN_BUILD
+#include <sys/socket.h>
+
+// C++ includes
+#include <mutex>
+#include <string>
+
+#define TCP_CONNECT_TIMEOUT     3000    // ms
+#define TCP_KEEPALIVE_IDLE      10      // s of silence before the first probe
+#define TCP_KEEPALIVE_INTERVAL  5       // s between probes
+#define TCP_KEEPALIVE_COUNT     3       // unanswered probes before the link is declared dead
+
+// Round trip time from a command write to the first byte of its reply, in microseconds
+typedef struct {
+    unsigned long   ulSamples;
+    long long       llMin;
+    long long       llMax;
+    long long       llTotal;
+    long long       llLast;
+} TransportLatencyStats;
+
+// Raw TCP link to a serial-to-Ethernet bridge (ser2net, Moxa, Lantronix, ...) in raw mode.
+// The port name is "host:port".
+// Nagle is disabled as every ATCL command is a small write waiting for a small reply,
+// and keepalive is tuned so a dead bridge is detected in ~25s instead of hours.
+class TCPTransport : public ATCSTransport
+{
+public:
+    TCPTransport();
+    virtual ~TCPTransport();
+
+    virtual int     open(const char *pszPort);
+    virtual int     close();
+    virtual bool    isConnected() const { return m_nSocket >= 0; }
+
+    virtual int     write(const char *pBuf, unsigned long ulSize);
+    virtual int     read(char *pBuf, unsigned long ulMaxSize, unsigned long &ulBytesRead, int nTimeoutMs);
+    virtual int     purge();
+
+    virtual int     pollFd() const { return m_nSocket; }
+    virtual const char *name() const { return "TCP"; }
+
+    // the reads run on the reactor thread, these can be called from any thread
+    void    getLatencyStats(TransportLatencyStats &stats) const;
+    void    resetLatencyStats();
+
+private:
+    int     m_nSocket;
+    bool    m_bWaitingReply;
+    std::chrono::steady_clock::time_point   m_WriteTime;
+    TransportLatencyStats   m_Stats;
+    mutable std::mutex      m_StatsMutex;
+
+    int     parseAddress(const char *pszPort, std::string &sHost, std::string &sService);
+    int     connectWithTimeout(const struct sockaddr *pAddr, unsigned int nAddrLen, int nTimeoutMs);
+    void    setSocketOptions();
+    int     waitFor(short nEvents, int nTimeoutMs);
+    void    addLatencySample(long long llLatency);
+};
+
+#endif
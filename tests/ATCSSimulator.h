@@ -0,0 +1,147 @@
+#pragma once
+// Fake ATCS controller for the tests.
+// It answers ATCL frames ("!XXxx...;" and the ENTER byte) on the master side of a pty,
+// a test opens the slave side (portName()) like a real serial port.
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <pty.h>
+#include <termios.h>
+
+// C++ includes
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#define SIM_ACK     ((char)0x8F)
+#define SIM_ENTER   ((char)0xB1)
+
+class CATCSSimulator
+{
+public:
+    typedef std::function<std::string(const std::string &sCmd)> ReplyFunction;
+
+    CATCSSimulator()
+    {
+        m_nMaster = -1;
+        m_nSlave = -1;
+        m_nReplyDelayMs = 0;
+        m_bRunning = false;
+        m_szPortName[0] = 0;
+        m_fnReply = defaultReply;
+    }
+
+    ~CATCSSimulator() { stop(); }
+
+    bool start()
+    {
+        struct termios tio;
+
+        memset(&tio, 0, sizeof(tio));
+        cfmakeraw(&tio);
+        // raw from the start, a cooked pty would echo the replies back to us
+        if(openpty(&m_nMaster, &m_nSlave, m_szPortName, &tio, NULL) < 0)
+            return false;
+        m_bRunning = true;
+        m_Thread = std::thread(&CATCSSimulator::run, this);
+        return true;
+    }
+
+    void stop()
+    {
+        m_bRunning = false;
+        if(m_Thread.joinable())
+            m_Thread.join();
+        if(m_nMaster >= 0)
+            close(m_nMaster);
+        if(m_nSlave >= 0)
+            close(m_nSlave);
+        m_nMaster = m_nSlave = -1;
+    }
+
+    const char *portName() const { return m_szPortName; }
+
+    void setReply(ReplyFunction fnReply) { std::lock_guard<std::mutex> lock(m_Mutex); m_fnReply = fnReply; }
+    void setReplyDelay(int nMs) { m_nReplyDelayMs = nMs; }
+
+    // raw bytes to the driver, outside of any command
+    void send(const std::string &sData) { if(write(m_nMaster, sData.data(), sData.size()) < 0) perror("sim write"); }
+
+    std::vector<std::string> commands() { std::lock_guard<std::mutex> lock(m_Mutex); return m_Commands; }
+    void clearCommands() { std::lock_guard<std::mutex> lock(m_Mutex); m_Commands.clear(); }
+
+    // ACK for the setters, a plausible value for the getters
+    static std::string defaultReply(const std::string &sCmd)
+    {
+        if(sCmd.size() < 4 || sCmd[0] != '!')
+            return std::string(1, SIM_ACK);
+        if(sCmd == "!CGra;")
+            return "12:00:00.0;";
+        if(sCmd == "!CGde;")
+            return "+10:00:00;";
+        if(sCmd == "!AGak;")
+            return "No;";
+        if(sCmd == "!AGas;")
+            return "Complete;";
+        if(sCmd == "!ACst;")
+            return "Yes;";
+        if(sCmd == "!TGlf;")
+            return "24hr;";
+        if(sCmd == "!TGdf;")
+            return "dd/mm/yy;";
+        if(sCmd == "!RGtr;")
+            return "Sidereal;";
+        if(sCmd[2] == 'G')
+            return "0.00;";
+        return std::string(1, SIM_ACK);
+    }
+
+private:
+    int             m_nMaster;
+    int             m_nSlave;
+    char            m_szPortName[64];
+    std::atomic<int>    m_nReplyDelayMs;
+    std::atomic<bool>   m_bRunning;
+    std::thread     m_Thread;
+    std::mutex      m_Mutex;
+    ReplyFunction   m_fnReply;
+    std::vector<std::string>    m_Commands;
+
+    void run()
+    {
+        std::string sFrame;
+        std::string sReply;
+        char szBuf[256];
+        struct pollfd pfd;
+        ssize_t nRead;
+
+        while(m_bRunning) {
+            pfd.fd = m_nMaster;
+            pfd.events = POLLIN;
+            pfd.revents = 0;
+            if(poll(&pfd, 1, 20) <= 0)
+                continue;
+            nRead = read(m_nMaster, szBuf, sizeof(szBuf));
+            for(ssize_t i = 0; i < nRead; i++) {
+                sFrame += szBuf[i];
+                if(szBuf[i] != ';' && szBuf[i] != SIM_ENTER)
+                    continue;
+                {
+                    std::lock_guard<std::mutex> lock(m_Mutex);
+                    m_Commands.push_back(sFrame);
+                    sReply = m_fnReply(sFrame);
+                }
+                sFrame.clear();
+                if(m_nReplyDelayMs)
+                    std::this_thread::sleep_for(std::chrono::milliseconds(m_nReplyDelayMs));
+                if(sReply.size())
+                    send(sReply);
+            }
+        }
+    }
+};
@@ -0,0 +1,128 @@
+#pragma once
+// Loopback stand-in for a serial-to-Ethernet bridge (ser2net raw mode) in front of the simulator.
+// Listens on 127.0.0.1, accepts one client at a time and copies bytes between it and the simulator pty.
+
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/socket.h>
+
+#include "ATCSSimulator.h"
+
+class CTCPBridge
+{
+public:
+    CTCPBridge()
+    {
+        m_nListen = -1;
+        m_nClient = -1;
+        m_nSerial = -1;
+        m_nPort = 0;
+        m_bRunning = false;
+        m_bDropClient = false;
+        m_szAddress[0] = 0;
+    }
+
+    ~CTCPBridge() { stop(); }
+
+    bool start(const char *pszSerialPort)
+    {
+        struct sockaddr_in addr;
+        socklen_t nLen = sizeof(addr);
+        struct termios tio;
+
+        m_nSerial = open(pszSerialPort, O_RDWR | O_NOCTTY);
+        if(m_nSerial < 0)
+            return false;
+        // raw, or the pty line discipline eats the ATCL bytes
+        tcgetattr(m_nSerial, &tio);
+        cfmakeraw(&tio);
+        tcsetattr(m_nSerial, TCSANOW, &tio);
+
+        m_nListen = socket(AF_INET, SOCK_STREAM, 0);
+        memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if(bind(m_nListen, (struct sockaddr *)&addr, sizeof(addr)) < 0 || listen(m_nListen, 1) < 0)
+            return false;
+        getsockname(m_nListen, (struct sockaddr *)&addr, &nLen);
+        m_nPort = ntohs(addr.sin_port);
+        snprintf(m_szAddress, sizeof(m_szAddress), "127.0.0.1:%d", m_nPort);
+
+        m_bRunning = true;
+        m_Thread = std::thread(&CTCPBridge::run, this);
+        return true;
+    }
+
+    void stop()
+    {
+        m_bRunning = false;
+        if(m_Thread.joinable())
+            m_Thread.join();
+        if(m_nClient >= 0)
+            close(m_nClient);
+        if(m_nListen >= 0)
+            close(m_nListen);
+        if(m_nSerial >= 0)
+            close(m_nSerial);
+        m_nClient = m_nListen = m_nSerial = -1;
+    }
+
+    // "host:port" for TCPTransport::open
+    const char *address() const { return m_szAddress; }
+    int port() const { return m_nPort; }
+
+    // close the client connection like a bridge being power cycled
+    void dropClient() { m_bDropClient = true; }
+
+private:
+    int     m_nListen;
+    int     m_nClient;
+    int     m_nSerial;
+    int     m_nPort;
+    char    m_szAddress[32];
+    std::atomic<bool>   m_bRunning;
+    std::atomic<bool>   m_bDropClient;
+    std::thread         m_Thread;
+
+    void run()
+    {
+        struct pollfd pfd[3];
+        char szBuf[256];
+        ssize_t nRead;
+
+        while(m_bRunning) {
+            if(m_bDropClient && m_nClient >= 0) {
+                close(m_nClient);
+                m_nClient = -1;
+                m_bDropClient = false;
+            }
+            pfd[0].fd = m_nListen;
+            pfd[0].events = POLLIN;
+            pfd[1].fd = m_nSerial;
+            pfd[1].events = POLLIN;
+            pfd[2].fd = m_nClient;
+            pfd[2].events = POLLIN;
+            pfd[0].revents = pfd[1].revents = pfd[2].revents = 0;
+            if(poll(pfd, m_nClient >= 0 ? 3 : 2, 20) <= 0)
+                continue;
+            if((pfd[0].revents & POLLIN) && m_nClient < 0)
+                m_nClient = accept(m_nListen, NULL, NULL);
+            if(pfd[1].revents & POLLIN) {
+                nRead = read(m_nSerial, szBuf, sizeof(szBuf));
+                // no client connected: the bytes are lost, as on a real bridge
+                if(nRead > 0 && m_nClient >= 0 && send(m_nClient, szBuf, nRead, MSG_NOSIGNAL) < 0)
+                    perror("bridge send");
+            }
+            if(m_nClient >= 0 && (pfd[2].revents & (POLLIN | POLLHUP))) {
+                nRead = recv(m_nClient, szBuf, sizeof(szBuf), 0);
+                if(nRead <= 0) {
+                    close(m_nClient);
+                    m_nClient = -1;
+                }
+                else if(write(m_nSerial, szBuf, nRead) < 0)
+                    perror("bridge write");
+            }
+        }
+    }
+};
@@ -0,0 +1,30 @@
+#pragma once
+// Minimal checks for the test programs, each test is a main() returning the number of failures.
+
+#include <stdio.h>
+
+// C++ includes
+#include <chrono>
+
+static int g_nTestFailures = 0;
+
+#define CHECK(cond) do { \
+        if(!(cond)) { \
+            fprintf(stderr, "%s:%d: CHECK failed: %s\n", __FILE__, __LINE__, #cond); \
+            g_nTestFailures++; \
+        } \
+    } while(0)
+
+#define CHECK_EQ(a, b) do { \
+        if(!((a) == (b))) { \
+            fprintf(stderr, "%s:%d: CHECK_EQ failed: %s == %s\n", __FILE__, __LINE__, #a, #b); \
+            g_nTestFailures++; \
+        } \
+    } while(0)
+
+#define TEST_RESULT(pszName) (printf("%s: %s\n", pszName, g_nTestFailures ? "FAILED" : "OK"), g_nTestFailures)
+
+static inline long long testElapsedUs(std::chrono::steady_clock::time_point tStart)
+{
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - tStart).count();
+}
@@ -0,0 +1,84 @@
+// The status reads TheSkyX polls all the time (position, slew progress, park state) must not
+// go to the heap once the connection is up, whether the reply comes from the poll cache or the link.
+
+#include "ATCSTest.h"
+#include "ATCSSimulator.h"
+
+#include "ATCS.h"
+
+// C++ includes
+#include <new>
+
+// allocations made by the thread that set t_bCountAllocs, the simulator and ATCS threads aren't counted
+static std::atomic<long> g_nAllocs(0);
+static thread_local bool t_bCountAllocs = false;
+
+void *operator new(size_t nSize)
+{
+    void *p;
+
+    if(t_bCountAllocs)
+        g_nAllocs++;
+    p = malloc(nSize ? nSize : 1);
+    if(!p)
+        throw std::bad_alloc();
+    return p;
+}
+
+void operator delete(void *p) noexcept
+{
+    free(p);
+}
+
+void operator delete(void *p, size_t) noexcept
+{
+    free(p);
+}
+
+template <class Fn>
+static long countAllocs(int nCalls, Fn fnCall)
+{
+    g_nAllocs = 0;
+    t_bCountAllocs = true;
+    for(int i = 0; i < nCalls; i++)
+        fnCall();
+    t_bCountAllocs = false;
+    return g_nAllocs.load();
+}
+
+int main()
+{
+    CATCSSimulator sim;
+    ATCS atcs;
+    char szPort[64];
+    double dRa, dDec;
+    bool bComplete;
+    bool bParked;
+    int i;
+
+    CHECK(sim.start());
+    snprintf(szPort, sizeof(szPort), "%s", sim.portName());
+    CHECK_EQ(atcs.setTransportType(TRANSPORT_NATIVE_SERIAL), PLUGIN_OK);
+    CHECK_EQ(atcs.Connect(szPort), PLUGIN_OK);
+
+    // first reads size the poll cache and the scratch buffers
+    for(i = 0; i < 3; i++) {
+        CHECK_EQ(atcs.getRaAndDec(dRa, dDec, 0), PLUGIN_OK);
+        CHECK_EQ(atcs.isSlewToComplete(bComplete), PLUGIN_OK);
+        CHECK_EQ(atcs.getAtPark(bParked), PLUGIN_OK);
+    }
+    CHECK(dRa > 11.99 && dRa < 12.01);
+    CHECK(dDec > 9.99 && dDec < 10.01);
+    CHECK(bComplete);
+    CHECK(!bParked);
+
+    // from the link, a max age of 0 forces a read
+    CHECK_EQ(countAllocs(20, [&] { atcs.getRaAndDec(dRa, dDec, 0); }), 0L);
+    // from the poll cache
+    CHECK_EQ(countAllocs(100, [&] { atcs.getRaAndDec(dRa, dDec, 100000); }), 0L);
+    CHECK_EQ(countAllocs(20, [&] { atcs.isSlewToComplete(bComplete); }), 0L);
+    CHECK_EQ(countAllocs(100, [&] { atcs.getAtPark(bParked); }), 0L);
+
+    atcs.Disconnect();
+    return TEST_RESULT("testAllocations");
+}
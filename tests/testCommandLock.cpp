@@ -0,0 +1,65 @@
+// CATCLCommandLock hands the link to the most urgent waiter, and the reply types of the command table.
+
+#include "ATCSTest.h"
+
+#include "ATCSCommands.h"
+
+// C++ includes
+#include <thread>
+#include <vector>
+#include <atomic>
+
+#define LOCK_SETTLE_MS  50      // long enough for the waiters to block
+
+int main()
+{
+    CATCLCommandLock commandLock;
+    std::vector<ATCLPriority> vOrder;
+    std::mutex orderMutex;
+    std::vector<std::thread> vWaiters;
+    const ATCLPriority nArrivals[] = { ATCL_PRIO_POLL, ATCL_PRIO_CONTROL, ATCL_PRIO_POLL, ATCL_PRIO_STOP };
+
+    // the link is busy, a poll, a setter, another poll and a stop queue up in that order
+    commandLock.lock(ATCL_PRIO_POLL);
+    for(ATCLPriority nPriority : nArrivals) {
+        vWaiters.push_back(std::thread([&commandLock, &vOrder, &orderMutex, nPriority] {
+            commandLock.level(nPriority).lock();
+            {
+                std::lock_guard<std::mutex> lock(orderMutex);
+                vOrder.push_back(nPriority);
+            }
+            commandLock.level(nPriority).unlock();
+        }));
+        std::this_thread::sleep_for(std::chrono::milliseconds(LOCK_SETTLE_MS));
+    }
+    commandLock.unlock();
+    for(std::thread &waiter : vWaiters)
+        waiter.join();
+
+    CHECK_EQ(vOrder.size(), (size_t)4);
+    if(vOrder.size() == 4) {
+        CHECK_EQ(vOrder[0], ATCL_PRIO_STOP);
+        CHECK_EQ(vOrder[1], ATCL_PRIO_CONTROL);
+        CHECK_EQ(vOrder[2], ATCL_PRIO_POLL);
+        CHECK_EQ(vOrder[3], ATCL_PRIO_POLL);
+    }
+
+    // the stops are the only commands ahead of the setters
+    CHECK_EQ(atclPriority(ATCL_CMD_XXXX), ATCL_PRIO_STOP);
+    CHECK_EQ(atclPriority(ATCL_CMD_RSOR), ATCL_PRIO_CONTROL);
+    CHECK_EQ(atclPriority(ATCL_CMD_CGRA), ATCL_PRIO_POLL);
+
+    // typed replies, what the status poll cache accepts
+    CHECK(atclResponseValid(ATCL_CMD_CGRA, "12:34:56.7"));
+    CHECK(atclResponseValid(ATCL_CMD_CGDE, "N/A"));
+    CHECK(!atclResponseValid(ATCL_CMD_CGDE, "Complete"));
+    CHECK(atclResponseValid(ATCL_CMD_GGGR, "42%"));
+    CHECK(!atclResponseValid(ATCL_CMD_GGGR, "Yes"));
+    CHECK(atclResponseValid(ATCL_CMD_AGAK, "No"));
+    CHECK(!atclResponseValid(ATCL_CMD_AGAK, "0.00"));
+    CHECK(atclResponseValid(ATCL_CMD_RGOR, "-15.04"));
+    CHECK(!atclResponseValid(ATCL_CMD_RGOR, "Sidereal"));
+    CHECK(atclResponseValid(ATCL_CMD_RGTR, "Sidereal"));
+
+    return TEST_RESULT("testCommandLock");
+}
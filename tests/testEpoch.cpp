@@ -0,0 +1,86 @@
+// CEpochConverter against Meeus example 23.a, the vector lanes against the scalar loop, and the batch cost.
+// The timing is reported, not checked.
+
+#include "ATCSTest.h"
+
+#include "ATCSEpoch.h"
+
+// C++ includes
+#include <cmath>
+#include <vector>
+#include <algorithm>
+
+#define EPOCH_BENCH_TARGETS 1000
+#define EPOCH_BENCH_PASSES  200
+
+// theta Persei, Meeus "Astronomical Algorithms" example 23.a, 2028 Nov 13.19 TD
+#define MEEUS_JD            2462088.69
+#define MEEUS_RA_J2000      (2.0 + 44.0 / 60.0 + 11.986 / 3600.0)
+#define MEEUS_DEC_J2000     (49.0 + 13.0 / 60.0 + 42.48 / 3600.0)
+#define MEEUS_RA_APPARENT   (2.0 + 46.0 / 60.0 + 13.401 / 3600.0)
+#define MEEUS_DEC_APPARENT  (49.0 + 21.0 / 60.0 + 10.03 / 3600.0)
+
+#define TOLERANCE_ARCSEC    0.5
+
+static double jdToUnixTime(double dJd)
+{
+    return (dJd - 2440587.5) * 86400.0;
+}
+
+int main()
+{
+    CEpochConverter converter;
+    std::vector<double> vRa(EPOCH_BENCH_TARGETS), vDec(EPOCH_BENCH_TARGETS), vRaOut(EPOCH_BENCH_TARGETS), vDecOut(EPOCH_BENCH_TARGETS);
+    std::chrono::steady_clock::time_point tStart;
+    double dRa, dDec, dMaxDiff = 0;
+    long long llBatchUs, llSingleUs;
+    int i, nPass;
+
+    // reference check, the RA error is taken on the sky
+    converter.setEpoch(jdToUnixTime(MEEUS_JD));
+    converter.convert(MEEUS_RA_J2000, MEEUS_DEC_J2000, dRa, dDec);
+    printf("theta Persei : dRA %.3f\", dDec %.3f\"\n",
+           (dRa - MEEUS_RA_APPARENT) * 54000.0 * cos(MEEUS_DEC_APPARENT * 3.14159265358979323846 / 180.0), (dDec - MEEUS_DEC_APPARENT) * 3600.0);
+    CHECK(fabs(dRa - MEEUS_RA_APPARENT) * 54000.0 * cos(MEEUS_DEC_APPARENT * 3.14159265358979323846 / 180.0) < TOLERANCE_ARCSEC);
+    CHECK(fabs(dDec - MEEUS_DEC_APPARENT) * 3600.0 < TOLERANCE_ARCSEC);
+
+    // a single target only goes through the scalar tail, a batch through the vector lanes
+    for(i = 0; i < EPOCH_BENCH_TARGETS; i++) {
+        vRa[i] = fmod(i * 0.37, 24.0);
+        vDec[i] = -85.0 + fmod(i * 7.3, 170.0);
+    }
+    converter.convert(vRa.data(), vDec.data(), vRaOut.data(), vDecOut.data(), EPOCH_BENCH_TARGETS);
+    for(i = 0; i < EPOCH_BENCH_TARGETS; i++) {
+        converter.convert(vRa[i], vDec[i], dRa, dDec);
+        dMaxDiff = std::max(dMaxDiff, std::max(fabs(dRa - vRaOut[i]) * 15.0, fabs(dDec - vDecOut[i])));
+    }
+    printf("vector / scalar : max difference %.3g deg\n", dMaxDiff);
+    CHECK(dMaxDiff < 1e-9);
+
+    // in place conversion
+    vRaOut = vRa;
+    vDecOut = vDec;
+    converter.convert(vRaOut.data(), vDecOut.data(), vRaOut.data(), vDecOut.data(), EPOCH_BENCH_TARGETS);
+    converter.convert(vRa[EPOCH_BENCH_TARGETS - 1], vDec[EPOCH_BENCH_TARGETS - 1], dRa, dDec);
+    CHECK(fabs(vRaOut[EPOCH_BENCH_TARGETS - 1] - dRa) < 1e-9);
+    CHECK(fabs(vDecOut[EPOCH_BENCH_TARGETS - 1] - dDec) < 1e-9);
+
+    // batch with the epoch set once, against the epoch recomputed for every target
+    tStart = std::chrono::steady_clock::now();
+    for(nPass = 0; nPass < EPOCH_BENCH_PASSES; nPass++)
+        converter.convert(vRa.data(), vDec.data(), vRaOut.data(), vDecOut.data(), EPOCH_BENCH_TARGETS);
+    llBatchUs = testElapsedUs(tStart);
+
+    tStart = std::chrono::steady_clock::now();
+    for(nPass = 0; nPass < EPOCH_BENCH_PASSES; nPass++) {
+        for(i = 0; i < EPOCH_BENCH_TARGETS; i++) {
+            converter.setEpoch(jdToUnixTime(MEEUS_JD));
+            converter.convert(vRa[i], vDec[i], vRaOut[i], vDecOut[i]);
+        }
+    }
+    llSingleUs = testElapsedUs(tStart);
+    printf("batch : %.1f ns per target, epoch per target : %.1f ns per target\n",
+           llBatchUs * 1000.0 / (EPOCH_BENCH_PASSES * EPOCH_BENCH_TARGETS), llSingleUs * 1000.0 / (EPOCH_BENCH_PASSES * EPOCH_BENCH_TARGETS));
+
+    return TEST_RESULT("testEpoch");
+}
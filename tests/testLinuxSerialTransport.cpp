@@ -0,0 +1,108 @@
+// LinuxSerialTransport against the pty simulator
+
+#include "ATCSTest.h"
+#include "ATCSSimulator.h"
+
+#include "LinuxSerialTransport.h"
+
+// read until a full reply (';' terminated or a single ACK) or the timeout
+static int readReply(ATCSTransport &transport, std::string &sReply, int nTimeoutMs)
+{
+    char szBuf[64];
+    unsigned long ulRead;
+    int nErr;
+
+    sReply.clear();
+    while(true) {
+        nErr = transport.read(szBuf, sizeof(szBuf), ulRead, nTimeoutMs);
+        if(nErr)
+            return nErr;
+        sReply.append(szBuf, ulRead);
+        if(sReply.back() == ';' || sReply == std::string(1, SIM_ACK))
+            return SB_OK;
+    }
+}
+
+int main()
+{
+    CATCSSimulator sim;
+    LinuxSerialTransport transport;
+    std::string sReply;
+    std::chrono::steady_clock::time_point tStart;
+    long long llElapsed;
+    unsigned long ulRead;
+    char szBuf[64];
+
+    CHECK(sim.start());
+
+    CHECK_EQ(transport.open("/dev/does-not-exist"), ERR_COMMNOLINK);
+    CHECK(!transport.isConnected());
+    CHECK_EQ(transport.write("!CGra;", 6), ERR_NOLINK);
+
+    CHECK_EQ(transport.open(sim.portName()), SB_OK);
+    CHECK(transport.isConnected());
+    CHECK(transport.pollFd() >= 0);
+    // ptys have no serial_struct, open must still succeed without low latency mode
+    CHECK(!transport.isLowLatency());
+
+    // round trip
+    tStart = std::chrono::steady_clock::now();
+    CHECK_EQ(transport.write("!CGra;", 6), SB_OK);
+    CHECK_EQ(readReply(transport, sReply, 500), SB_OK);
+    llElapsed = testElapsedUs(tStart);
+    CHECK_EQ(sReply, std::string("12:00:00.0;"));
+    CHECK(llElapsed < 16000);
+    printf("round trip %lld us\n", llElapsed);
+
+    // setter, single ACK byte
+    CHECK_EQ(transport.write("!RStr0;", 7), SB_OK);
+    CHECK_EQ(readReply(transport, sReply, 500), SB_OK);
+    CHECK_EQ(sReply, std::string(1, SIM_ACK));
+
+    // nothing to read: the deadline is honoured
+    tStart = std::chrono::steady_clock::now();
+    CHECK_EQ(transport.read(szBuf, sizeof(szBuf), ulRead, 100), ERR_RXTIMEOUT);
+    llElapsed = testElapsedUs(tStart);
+    CHECK_EQ(ulRead, 0UL);
+    CHECK(llElapsed >= 95000 && llElapsed < 300000);
+
+    // a late reply wakes the reader right away, not at the deadline
+    sim.setReplyDelay(30);
+    tStart = std::chrono::steady_clock::now();
+    CHECK_EQ(transport.write("!CGde;", 6), SB_OK);
+    CHECK_EQ(readReply(transport, sReply, 1000), SB_OK);
+    llElapsed = testElapsedUs(tStart);
+    CHECK_EQ(sReply, std::string("+10:00:00;"));
+    CHECK(llElapsed >= 29000 && llElapsed < 200000);
+    sim.setReplyDelay(0);
+
+    // back to back commands keep their order
+    CHECK_EQ(transport.write("!CGra;!CGde;", 12), SB_OK);
+    CHECK_EQ(readReply(transport, sReply, 500), SB_OK);
+    if(sReply == "12:00:00.0;")
+        CHECK_EQ(readReply(transport, sReply, 500), SB_OK);
+    else
+        CHECK_EQ(sReply, std::string("12:00:00.0;+10:00:00;"));
+    CHECK(sReply.find("+10:00:00;") != std::string::npos);
+
+    // purge drops stale input
+    sim.send("stale;");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK_EQ(transport.purge(), SB_OK);
+    CHECK_EQ(transport.read(szBuf, sizeof(szBuf), ulRead, 50), ERR_RXTIMEOUT);
+
+    CHECK_EQ(sim.commands().size(), 5UL);
+
+    CHECK_EQ(transport.close(), SB_OK);
+    CHECK(!transport.isConnected());
+    CHECK_EQ(transport.read(szBuf, sizeof(szBuf), ulRead, 10), ERR_NOLINK);
+    CHECK_EQ(transport.purge(), ERR_NOLINK);
+
+    // reopen after close
+    CHECK_EQ(transport.open(sim.portName()), SB_OK);
+    CHECK_EQ(transport.write("!CGra;", 6), SB_OK);
+    CHECK_EQ(readReply(transport, sReply, 500), SB_OK);
+    CHECK_EQ(sReply, std::string("12:00:00.0;"));
+
+    return TEST_RESULT("testLinuxSerialTransport");
+}
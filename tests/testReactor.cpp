@@ -0,0 +1,78 @@
+// ATCSReactorChannel over LinuxSerialTransport : commands go through the submission ring, replies through the receive ring
+
+#include "ATCSTest.h"
+#include "ATCSSimulator.h"
+
+#include "LinuxSerialTransport.h"
+#include "ATCSReactor.h"
+
+// read until nReplies ';' terminated replies or the timeout
+static int readReplies(ATCSTransport &transport, std::string &sReply, int nReplies, int nTimeoutMs)
+{
+    char szBuf[64];
+    unsigned long ulRead;
+    int nErr;
+
+    sReply.clear();
+    while(std::count(sReply.begin(), sReply.end(), ';') < nReplies) {
+        nErr = transport.read(szBuf, sizeof(szBuf), ulRead, nTimeoutMs);
+        if(nErr)
+            return nErr;
+        sReply.append(szBuf, ulRead);
+    }
+    return SB_OK;
+}
+
+int main()
+{
+    CATCSSimulator sim;
+    LinuxSerialTransport serial;
+    ATCSReactorChannel channel(&serial);
+    std::string sReply;
+    std::string sBurst;
+    std::string sExpected;
+    std::chrono::steady_clock::time_point tStart;
+    long long llElapsed;
+    unsigned long ulRead;
+    char szBuf[64];
+    int i;
+
+    CHECK(sim.start());
+
+    CHECK_EQ(channel.write("!CGra;", 6), ERR_NOLINK);
+    CHECK_EQ(channel.open(sim.portName()), SB_OK);
+
+    // round trip through both rings
+    tStart = std::chrono::steady_clock::now();
+    CHECK_EQ(channel.write("!CGra;", 6), SB_OK);
+    CHECK_EQ(readReplies(channel, sReply, 1, 500), SB_OK);
+    llElapsed = testElapsedUs(tStart);
+    CHECK_EQ(sReply, std::string("12:00:00.0;"));
+    printf("round trip %lld us\n", llElapsed);
+
+    // more than the submission ring holds : the writer waits for the reactor and the order is kept
+    for(i = 0; i < 400; i++) {
+        sBurst += (i % 2) ? "!CGde;" : "!CGra;";
+        sExpected += (i % 2) ? "+10:00:00;" : "12:00:00.0;";
+    }
+    CHECK(sBurst.size() > REACTOR_TX_SLOTS * REACTOR_MAX_CHUNK);
+    CHECK_EQ(channel.write(sBurst.c_str(), sBurst.size()), SB_OK);
+    CHECK_EQ(readReplies(channel, sReply, 400, 2000), SB_OK);
+    CHECK_EQ(sReply, sExpected);
+    CHECK_EQ(sim.commands().size(), 401UL);
+
+    // purge drops stale input
+    sim.send("stale;");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK_EQ(channel.purge(), SB_OK);
+    CHECK_EQ(channel.read(szBuf, sizeof(szBuf), ulRead, 50), ERR_RXTIMEOUT);
+
+    CHECK_EQ(channel.write("!CGde;", 6), SB_OK);
+    CHECK_EQ(readReplies(channel, sReply, 1, 500), SB_OK);
+    CHECK_EQ(sReply, std::string("+10:00:00;"));
+
+    CHECK_EQ(channel.close(), SB_OK);
+    CHECK_EQ(channel.write("!CGra;", 6), ERR_NOLINK);
+
+    return TEST_RESULT("testReactor");
+}
@@ -0,0 +1,78 @@
+// A query whose reply is cut short or comes late is asked again right away with a short timeout,
+// and the late reply is dropped instead of waited for.
+
+#include "ATCSTest.h"
+#include "ATCSSimulator.h"
+
+#include "ATCS.h"
+
+#define WARMUP_QUERIES      40      // enough samples to learn the PGre timeout (the 50 ms floor here)
+#define LATE_REPLY_MS       80      // past the learned timeout
+// first timeout + retry, the old resync waited for the late reply under the 250 ms default timeout first
+#define MAX_RECOVERY_MS     150
+#define MAX_NEXT_QUERY_MS   40
+
+enum SimFault {FAULT_NONE, FAULT_TRUNCATE, FAULT_LATE};
+
+int main()
+{
+    CATCSSimulator sim;
+    ATCS atcs;
+    std::atomic<int> nFault(FAULT_NONE);
+    std::chrono::steady_clock::time_point tStart;
+    char szPort[64];
+    bool bEnabled;
+    bool b24h;
+    long long llRecoveryUs, llNextUs;
+    int i;
+
+    sim.setReply([&nFault](const std::string &sCmd) -> std::string {
+        if(sCmd != "!PGre;")
+            return CATCSSimulator::defaultReply(sCmd);
+        switch(nFault.exchange(FAULT_NONE)) {
+            case FAULT_TRUNCATE:
+                return "Ye";
+            case FAULT_LATE:
+                std::this_thread::sleep_for(std::chrono::milliseconds(LATE_REPLY_MS));
+                return "Yes;";
+            default:
+                return "Yes;";
+        }
+    });
+    CHECK(sim.start());
+    snprintf(szPort, sizeof(szPort), "%s", sim.portName());
+    CHECK_EQ(atcs.setTransportType(TRANSPORT_NATIVE_SERIAL), PLUGIN_OK);
+    CHECK_EQ(atcs.Connect(szPort), PLUGIN_OK);
+
+    for(i = 0; i < WARMUP_QUERIES; i++)
+        CHECK_EQ(atcs.getRefractionCorrEnabled(bEnabled), PLUGIN_OK);
+
+    // the reply stops before its ';' and the rest never comes
+    nFault = FAULT_TRUNCATE;
+    tStart = std::chrono::steady_clock::now();
+    CHECK_EQ(atcs.getRefractionCorrEnabled(bEnabled), PLUGIN_OK);
+    llRecoveryUs = testElapsedUs(tStart);
+    CHECK(bEnabled);
+    tStart = std::chrono::steady_clock::now();
+    CHECK_EQ(atcs.getLocalTimeFormat(b24h), PLUGIN_OK);
+    llNextUs = testElapsedUs(tStart);
+    CHECK(b24h);
+    printf("truncated reply : recovered in %.1f ms, next query %.1f ms\n", llRecoveryUs / 1000.0, llNextUs / 1000.0);
+    CHECK(llRecoveryUs < MAX_RECOVERY_MS * 1000);
+    CHECK(llNextUs < MAX_NEXT_QUERY_MS * 1000);
+
+    // the first reply comes after the retry was sent, the second one must not answer the next query
+    nFault = FAULT_LATE;
+    tStart = std::chrono::steady_clock::now();
+    CHECK_EQ(atcs.getRefractionCorrEnabled(bEnabled), PLUGIN_OK);
+    llRecoveryUs = testElapsedUs(tStart);
+    CHECK(bEnabled);
+    b24h = false;
+    CHECK_EQ(atcs.getLocalTimeFormat(b24h), PLUGIN_OK);
+    CHECK(b24h);
+    printf("late reply : recovered in %.1f ms\n", llRecoveryUs / 1000.0);
+    CHECK(llRecoveryUs < MAX_RECOVERY_MS * 1000);
+
+    atcs.Disconnect();
+    return TEST_RESULT("testRetry");
+}
@@ -0,0 +1,234 @@
+// CSGP4 against the Spacetrack Report #3 test case, then a pass followed on the pty simulator :
+// the slew goes to where the satellite will be at the acquisition time and the rates only stream from then on.
+
+#include "ATCSTest.h"
+#include "ATCSSimulator.h"
+
+#include "ATCS.h"
+
+// C++ includes
+#include <cmath>
+
+// Spacetrack Report #3 SGP4 test case, satellite 88888, km and km/s.
+// The report's values differ from the Vallado 2006 revision we implement by a few meters.
+#define STR3_LINE1  "1 88888U          80275.98708465  .00073094  13844-3  66816-4 0    8"
+#define STR3_LINE2  "2 88888  72.8435 115.9689 0086731  52.6988 110.5714 16.05824518  105"
+#define STR3_POS_TOLERANCE  0.015
+#define STR3_VEL_TOLERANCE  2e-5
+
+static const double s_dStr3[][7] = {
+    // minutes since epoch, X, Y, Z, XDOT, YDOT, ZDOT
+    {   0.0, 2328.97048951, -5995.22076416, 1719.97067261, 2.91207230, -0.98341546, -7.09081703},
+    { 360.0, 2456.10705566, -6071.93853760, 1222.89727783, 2.67938992, -0.44829041, -7.22879231},
+    { 720.0, 2567.56195068, -6112.50384522,  713.96397400, 2.44024599,  0.09810869, -7.31995916},
+    {1080.0, 2663.09078980, -6115.48229980,  196.39640427, 2.19611958,  0.65241995, -7.36282432},
+    {1440.0, 2742.55133057, -6079.67144775, -326.38095856, 1.94850229,  1.21106251, -7.35619372}
+};
+
+#define STREAM_CHECK_S      1.0     // rate stream watched that long after the acquisition
+#define MIN_STREAM_UPDATES  5
+#define SLEW_TOLERANCE_ARCSEC   5.0 // HH:MM:SS.S and DD:MM:SS on the link
+#define PI  3.14159265358979323846
+
+// the observing site TheSkyX would give us, longitude + going west like TheSkyX
+class CTestSite : public TheSkyXFacadeForDriversInterface
+{
+public:
+    double  m_dLatitude;
+    double  m_dLongitude;
+
+    CTestSite() { m_dLatitude = 0; m_dLongitude = 0; }
+
+    int version() { return 0; }
+    int build() { return 0; }
+    void pathToWriteConfigFilesTo(char *pszOut, const int &nOutMaxSize) { snprintf(pszOut, nOutMaxSize, "/tmp"); }
+    int localDateTime(int &yy, int &mm, int &dd, int &h, int &min, double &sec, int &nIsDST)
+    {
+        time_t tNow = time(NULL);
+        struct tm *pTm = gmtime(&tNow);
+
+        yy = pTm->tm_year + 1900; mm = pTm->tm_mon + 1; dd = pTm->tm_mday;
+        h = pTm->tm_hour; min = pTm->tm_min; sec = pTm->tm_sec; nIsDST = 0;
+        return 0;
+    }
+    double julianDate() { return CSatellitePredictor::unixToJD(unixNow()); }
+    double lst() { return fmod(CSatellitePredictor::gmst(julianDate()) * 12.0 / PI - m_dLongitude / 15.0 + 48.0, 24.0); }
+    double hourAngle(const double &dRAIn) { return remainder(lst() - dRAIn, 24.0); }
+    double timeZone() { return 0; }
+    double latitude() { return m_dLatitude; }
+    double longitude() { return m_dLongitude; }
+    double elevation() { return 0; }
+    double refractionInAltAz() { return 0; }
+    int EqToHz(const double &, const double &, double &dAz, double &dAlt) { dAz = 0; dAlt = 90; return 0; }
+    int HzToEq(const double &, const double &, double &dRa, double &dDec) { dRa = 0; dDec = 0; return 0; }
+
+    static double unixNow()
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count() / 1e6;
+    }
+};
+
+typedef struct {
+    double      dTime;
+    std::string sCmd;
+} SimCommand;
+
+static std::string sexagesimal(double dValue, bool bSign, int nDecimals)
+{
+    char szBuf[32];
+    double dAbs = fabs(dValue);
+    int nDeg = (int)dAbs;
+    int nMin = (int)((dAbs - nDeg) * 60.0);
+    double dSec = ((dAbs - nDeg) * 60.0 - nMin) * 60.0;
+
+    snprintf(szBuf, sizeof(szBuf), "%s%02d:%02d:%0*.*f", bSign ? (dValue < 0 ? "-" : "+") : "", nDeg, nMin, nDecimals ? 3 + nDecimals : 2, nDecimals, dSec);
+    return szBuf;
+}
+
+// 88888's elements at a fresh epoch, so it's in orbit now
+static void currentTLE(double dEpoch, std::string &sLine1, std::string &sLine2)
+{
+    char szEpoch[32];
+    time_t tEpoch = (time_t)dEpoch;
+    struct tm *pTm = gmtime(&tEpoch);
+
+    snprintf(szEpoch, sizeof(szEpoch), "%02d%012.8f", pTm->tm_year % 100,
+             pTm->tm_yday + 1 + (pTm->tm_hour * 3600 + pTm->tm_min * 60 + pTm->tm_sec + (dEpoch - tEpoch)) / 86400.0);
+    sLine1 = std::string(STR3_LINE1).replace(18, 14, szEpoch);
+    sLine2 = STR3_LINE2;
+}
+
+static void checkReport3()
+{
+    CSGP4 sgp4;
+    double dPos[3], dVel[3];
+    size_t i;
+    int j;
+
+    CHECK_EQ(sgp4.init(STR3_LINE1, STR3_LINE2), SGP4_OK);
+    for(i = 0; i < sizeof(s_dStr3) / sizeof(s_dStr3[0]); i++) {
+        CHECK_EQ(sgp4.propagate(s_dStr3[i][0], dPos, dVel), SGP4_OK);
+        for(j = 0; j < 3; j++) {
+            CHECK(fabs(dPos[j] - s_dStr3[i][1 + j]) < STR3_POS_TOLERANCE);
+            CHECK(fabs(dVel[j] - s_dStr3[i][4 + j]) < STR3_VEL_TOLERANCE);
+        }
+        printf("88888 at %4.0f min : %.6f %.6f %.6f km\n", s_dStr3[i][0], dPos[0], dPos[1], dPos[2]);
+    }
+}
+
+int main()
+{
+    CATCSSimulator sim;
+    ATCS atcs;
+    CTestSite site;
+    CSGP4 sgp4;
+    CSatellitePredictor predictor;
+    SatelliteStats stats;
+    std::mutex commandMutex;
+    std::vector<SimCommand> vCommands;
+    std::string sLine1, sLine2;
+    std::string sMountRa, sMountDec;
+    char szPort[64];
+    double dNow, dCallTime, dOverhead;
+    double dPos[3], dVel[3];
+    double dRa, dDec, dAltitude, dRaNow, dDecNow;
+    double dSlewRa = -1, dSlewDec = -1;
+    double dFirstRate = 0, dFirstRateTime = 0;
+    int nStreamUpdates = 0;
+    int nEarlyUpdates = 0;
+
+    checkReport3();
+
+    // put the site under the satellite a little after the acquisition margin, the pass is then overhead
+    dNow = CTestSite::unixNow();
+    currentTLE(dNow - 60.0, sLine1, sLine2);
+    CHECK_EQ(sgp4.init(sLine1, sLine2), SGP4_OK);
+    dOverhead = dNow + SAT_ACQUISITION_MARGIN + 1.0;
+    CHECK_EQ(sgp4.propagateJD(CSatellitePredictor::unixToJD(dOverhead), dPos, dVel), SGP4_OK);
+    site.m_dLatitude = asin(dPos[2] / sqrt(dPos[0] * dPos[0] + dPos[1] * dPos[1] + dPos[2] * dPos[2])) * 180.0 / PI;
+    site.m_dLongitude = -remainder((atan2(dPos[1], dPos[0]) - CSatellitePredictor::gmst(CSatellitePredictor::unixToJD(dOverhead))) * 180.0 / PI, 360.0);
+    CHECK_EQ(predictor.setTLE(sLine1, sLine2), SGP4_OK);
+    predictor.setSite(site.m_dLatitude, -site.m_dLongitude, site.elevation());
+
+    // the mount already points about there, the slew estimate is short
+    CHECK_EQ(predictor.pointingAt(dNow + SAT_ACQUISITION_MARGIN, dRa, dDec, dAltitude), SGP4_OK);
+    sMountRa = sexagesimal(dRa, false, 1) + ";";
+    sMountDec = sexagesimal(dDec, true, 0) + ";";
+
+    sim.setReply([&](const std::string &sCmd) -> std::string {
+        {
+            std::lock_guard<std::mutex> lock(commandMutex);
+            vCommands.push_back({CTestSite::unixNow(), sCmd});
+        }
+        if(sCmd == "!CGra;")
+            return sMountRa;
+        if(sCmd == "!CGde;")
+            return sMountDec;
+        if(sCmd == "!GGgr;")
+            return "0%;";
+        return CATCSSimulator::defaultReply(sCmd);
+    });
+    CHECK(sim.start());
+    snprintf(szPort, sizeof(szPort), "%s", sim.portName());
+    CHECK_EQ(atcs.setTransportType(TRANSPORT_NATIVE_SERIAL), PLUGIN_OK);
+    CHECK_EQ(atcs.Connect(szPort), PLUGIN_OK);
+    atcs.setTSX(&site);
+
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        vCommands.clear();
+    }
+    dCallTime = CTestSite::unixNow();
+    CHECK_EQ(atcs.startSatelliteTracking(sLine1, sLine2, 0), PLUGIN_OK);
+    atcs.getSatelliteStats(stats);
+    printf("acquisition %.2f s after the call\n", stats.dAcquisitionTime - dCallTime);
+    CHECK(stats.dAcquisitionTime >= dCallTime + SAT_ACQUISITION_MARGIN);
+    CHECK(stats.dAcquisitionTime < dCallTime + SAT_ACQUISITION_MARGIN + 1.0);
+
+    // let the pass start and stream for a while
+    dNow = CTestSite::unixNow();
+    std::this_thread::sleep_for(std::chrono::milliseconds((long long)((stats.dAcquisitionTime - dNow + STREAM_CHECK_S) * 1000.0)));
+    CHECK(atcs.isSatelliteTrackingActive());
+    atcs.stopSatelliteTracking();
+    CHECK(!atcs.isSatelliteTrackingActive());
+
+    {
+        std::lock_guard<std::mutex> lock(commandMutex);
+        for(const SimCommand &cmd : vCommands) {
+            if(cmd.sCmd.compare(0, 5, "!CStr") == 0)
+                atclParseSexagesimal(cmd.sCmd.substr(5, cmd.sCmd.size() - 6).c_str(), dSlewRa);
+            else if(cmd.sCmd.compare(0, 5, "!CStd") == 0)
+                atclParseSexagesimal(cmd.sCmd.substr(5, cmd.sCmd.size() - 6).c_str(), dSlewDec);
+            else if(cmd.sCmd.compare(0, 5, "!RSor") == 0) {
+                if(cmd.dTime < stats.dAcquisitionTime)
+                    nEarlyUpdates++;
+                else if(!nStreamUpdates++) {
+                    dFirstRate = atof(cmd.sCmd.c_str() + 5);
+                    dFirstRateTime = cmd.dTime;
+                }
+            }
+        }
+    }
+
+    // the slew went to where the satellite is at the acquisition, not to where it was at the call
+    CHECK_EQ(predictor.pointingAt(stats.dAcquisitionTime, dRa, dDec, dAltitude), SGP4_OK);
+    CHECK_EQ(predictor.pointingAt(dCallTime, dRaNow, dDecNow, dAltitude), SGP4_OK);
+    printf("slew target : dRA %.1f\", dDec %.1f\" from the acquisition point, %.2f deg from the satellite at the call\n",
+           remainder(dSlewRa - dRa, 24.0) * 54000.0 * cos(dDec * PI / 180.0), (dSlewDec - dDec) * 3600.0,
+           std::max(fabs(remainder(dSlewRa - dRaNow, 24.0)) * 15.0 * cos(dDecNow * PI / 180.0), fabs(dSlewDec - dDecNow)));
+    CHECK(fabs(remainder(dSlewRa - dRa, 24.0)) * 54000.0 * cos(dDec * PI / 180.0) < SLEW_TOLERANCE_ARCSEC);
+    CHECK(fabs(dSlewDec - dDec) * 3600.0 < SLEW_TOLERANCE_ARCSEC);
+    CHECK(std::max(fabs(remainder(dSlewRa - dRaNow, 24.0)) * 15.0 * cos(dDecNow * PI / 180.0), fabs(dSlewDec - dDecNow)) > 1.0);
+
+    // sidereal while we wait, then the satellite's rates
+    printf("rate stream : %d updates, first %.3f s after the acquisition at %.0f arcsec/h\n", nStreamUpdates, dFirstRateTime - stats.dAcquisitionTime, dFirstRate);
+    CHECK_EQ(nEarlyUpdates, 0);
+    CHECK(nStreamUpdates >= MIN_STREAM_UPDATES);
+    CHECK(dFirstRateTime - stats.dAcquisitionTime < 0.5);
+    CHECK(fabs(dFirstRate) > 1000.0);
+    atcs.getSatelliteStats(stats);
+    CHECK(stats.ulUpdates >= (unsigned long)MIN_STREAM_UPDATES);
+
+    atcs.Disconnect();
+    return TEST_RESULT("testSatellite");
+}
@@ -0,0 +1,119 @@
+// TCPTransport against the simulator behind a loopback ser2net stand-in
+
+#include "ATCSTest.h"
+#include "ATCSTCPBridge.h"
+
+#include "TCPTransport.h"
+
+static int readReply(ATCSTransport &transport, std::string &sReply, int nTimeoutMs)
+{
+    char szBuf[64];
+    unsigned long ulRead;
+    int nErr;
+
+    sReply.clear();
+    while(true) {
+        nErr = transport.read(szBuf, sizeof(szBuf), ulRead, nTimeoutMs);
+        if(nErr)
+            return nErr;
+        sReply.append(szBuf, ulRead);
+        if(sReply.back() == ';' || sReply == std::string(1, SIM_ACK))
+            return SB_OK;
+    }
+}
+
+int main()
+{
+    CATCSSimulator sim;
+    CTCPBridge bridge;
+    TCPTransport transport;
+    TransportLatencyStats stats;
+    std::string sReply;
+    std::chrono::steady_clock::time_point tStart;
+    long long llElapsed;
+    unsigned long ulRead;
+    char szBuf[64];
+    char szAddress[64];
+    std::atomic<bool> bPolling;
+    std::thread statsThread;
+
+    CHECK(sim.start());
+    CHECK(bridge.start(sim.portName()));
+
+    CHECK_EQ(transport.open("no-port-given"), ERR_COMMOPENING);
+    CHECK_EQ(transport.write("!CGra;", 6), ERR_NOLINK);
+    // nothing listens there once the bridge has the port
+    snprintf(szAddress, sizeof(szAddress), "127.0.0.1:%d", bridge.port() == 65535 ? 65534 : bridge.port() + 1);
+    CHECK(transport.open(szAddress) != SB_OK);
+    CHECK(!transport.isConnected());
+
+    CHECK_EQ(transport.open(bridge.address()), SB_OK);
+    CHECK(transport.isConnected());
+
+    tStart = std::chrono::steady_clock::now();
+    CHECK_EQ(transport.write("!CGra;", 6), SB_OK);
+    CHECK_EQ(readReply(transport, sReply, 1000), SB_OK);
+    llElapsed = testElapsedUs(tStart);
+    CHECK_EQ(sReply, std::string("12:00:00.0;"));
+    printf("round trip through the bridge %lld us\n", llElapsed);
+
+    CHECK_EQ(transport.write("!RStr0;", 7), SB_OK);
+    CHECK_EQ(readReply(transport, sReply, 1000), SB_OK);
+    CHECK_EQ(sReply, std::string(1, SIM_ACK));
+
+    // one sample per command, taken on the first byte of the reply
+    transport.getLatencyStats(stats);
+    CHECK_EQ(stats.ulSamples, 2UL);
+    CHECK(stats.llMin > 0 && stats.llMin <= stats.llMax);
+    CHECK(stats.llTotal >= stats.llMin + stats.llMax);
+
+    // a slow reply shows up in the stats, the stats can be read from another thread meanwhile
+    bPolling = true;
+    statsThread = std::thread([&]{
+        TransportLatencyStats threadStats;
+        while(bPolling) {
+            transport.getLatencyStats(threadStats);
+            CHECK(threadStats.ulSamples >= 2);
+        }
+    });
+    sim.setReplyDelay(40);
+    CHECK_EQ(transport.write("!CGde;", 6), SB_OK);
+    CHECK_EQ(readReply(transport, sReply, 1000), SB_OK);
+    CHECK_EQ(sReply, std::string("+10:00:00;"));
+    sim.setReplyDelay(0);
+    bPolling = false;
+    statsThread.join();
+    transport.getLatencyStats(stats);
+    CHECK_EQ(stats.ulSamples, 3UL);
+    CHECK(stats.llLast >= 40000);
+    CHECK_EQ(stats.llMax, stats.llLast);
+
+    transport.resetLatencyStats();
+    transport.getLatencyStats(stats);
+    CHECK_EQ(stats.ulSamples, 0UL);
+
+    // deadline with nothing to read
+    tStart = std::chrono::steady_clock::now();
+    CHECK_EQ(transport.read(szBuf, sizeof(szBuf), ulRead, 100), ERR_RXTIMEOUT);
+    llElapsed = testElapsedUs(tStart);
+    CHECK(llElapsed >= 95000 && llElapsed < 300000);
+
+    // purge drops what the bridge already delivered
+    sim.send("stale;");
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    CHECK_EQ(transport.purge(), SB_OK);
+    CHECK_EQ(transport.read(szBuf, sizeof(szBuf), ulRead, 50), ERR_RXTIMEOUT);
+
+    // the bridge going away is a lost link, not a timeout
+    bridge.dropClient();
+    CHECK_EQ(transport.read(szBuf, sizeof(szBuf), ulRead, 1000), ERR_COMMNOLINK);
+    CHECK_EQ(transport.close(), SB_OK);
+
+    CHECK_EQ(transport.open(bridge.address()), SB_OK);
+    CHECK_EQ(transport.write("!CGra;", 6), SB_OK);
+    CHECK_EQ(readReply(transport, sReply, 1000), SB_OK);
+    CHECK_EQ(sReply, std::string("12:00:00.0;"));
+    transport.close();
+
+    return TEST_RESULT("testTCPTransport");
+}
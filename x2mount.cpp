@@ -43,12 +43,17 @@ X2Mount::X2Mount(const char* pszDriverSelection,
     mATCS.setSerxPointer(m_pSerX);
     mATCS.setTSX(m_pTheSkyXForMounts);
     mATCS.setSleeper(m_pSleeper);
+    mATCS.setIniUtil(m_pIniUtil, m_nPrivateMulitInstanceIndex);
 
     m_CurrentRateIndex = 0;
 
 	// Read the current stored values for the settings
 	if (m_pIniUtil)
 	{
+        mATCS.setTransportType((ATCSTransportType)m_pIniUtil->readInt(PARENT_KEY, CHILD_KEY_TRANSPORT, TRANSPORT_SERX));
+        mATCS.setSharedReactor(m_pIniUtil->readInt(PARENT_KEY, CHILD_KEY_SHARED_REACTOR, 0) != 0);
+        if(m_pIniUtil->readInt(PARENT_KEY, CHILD_KEY_TRACE, 0))
+            mATCS.setTraceEnabled(true);
 	}
 
     // set mount alignement type and meridian avoidance mode.
@@ -133,11 +138,13 @@ int X2Mount::queryAbstraction(const char* pszName, void** ppVal)
 
 int X2Mount::startOpenLoopMove(const MountDriverInterface::MoveDir& Dir, const int& nRateIndex)
 {
+    ATCS_SCOPED_SPAN("X2Mount::startOpenLoopMove");
     int nErr = SB_OK;
+    int nTimedMoveMs = 0;
     if(!m_bLinked)
         return ERR_NOLINK;
 
-    X2MutexLocker ml(GetMutex());
+    ATCS_TIMED_LOCK(ml, GetMutex(), "X2Mount::startOpenLoopMove mutex wait");
 
 	m_CurrentRateIndex = nRateIndex;
 #ifdef ATCS_X2_DEBUG
@@ -150,7 +157,13 @@ int X2Mount::startOpenLoopMove(const MountDriverInterface::MoveDir& Dir, const i
 	}
 #endif
 
-    nErr = mATCS.startOpenSlew(Dir, nRateIndex);
+    // fixed length nudges (guiding through the mount, centering), endOpenLoopMove can still stop them early
+    if(m_pIniUtil)
+        nTimedMoveMs = m_pIniUtil->readInt(PARENT_KEY, CHILD_KEY_TIMED_MOVE, 0);
+    if(nTimedMoveMs > 0)
+        nErr = mATCS.startTimedOpenLoopMove(Dir, nRateIndex, nTimedMoveMs);
+    else
+        nErr = mATCS.startOpenSlew(Dir, nRateIndex);
     if(nErr) {
 #ifdef ATCS_X2_DEBUG
         if (LogFile) {
@@ -169,11 +182,12 @@ int X2Mount::startOpenLoopMove(const MountDriverInterface::MoveDir& Dir, const i
 
 int X2Mount::endOpenLoopMove(void)
 {
+    ATCS_SCOPED_SPAN("X2Mount::endOpenLoopMove");
 	int nErr = SB_OK;
     if(!m_bLinked)
         return ERR_NOLINK;
 
-    X2MutexLocker ml(GetMutex());
+    ATCS_TIMED_LOCK(ml, GetMutex(), "X2Mount::endOpenLoopMove mutex wait");
 
 #ifdef ATCS_X2_DEBUG
 	if (LogFile){
@@ -206,7 +220,7 @@ int X2Mount::rateCountOpenLoopMove(void) const
 {
     X2Mount* pMe = (X2Mount*)this;
 
-    X2MutexLocker ml(pMe->GetMutex());
+    ATCS_TIMED_LOCK(ml, pMe->GetMutex(), "X2Mount::rateCountOpenLoopMove mutex wait");
 	return pMe->mATCS.getNbSlewRates();
 }
 
@@ -262,7 +276,7 @@ int X2Mount::execModalSettingsDialog(void)
 		return ERR_POINTER;
 	}
 
-    X2MutexLocker ml(GetMutex());
+    ATCS_TIMED_LOCK(ml, GetMutex(), "X2Mount::execModalSettingsDialog mutex wait");
 
 	// Set values in the userinterface
     if(m_bLinked) {
@@ -383,28 +397,44 @@ void X2Mount::uiEvent(X2GUIExchangeInterface* uiex, const char* pszEvent)
 #pragma mark - LinkInterface
 int X2Mount::establishLink(void)
 {
+    ATCS_SCOPED_SPAN("X2Mount::establishLink");
     int nErr;
     char szPort[DRIVER_MAX_STRING];
+    char szHorizonFile[DRIVER_MAX_STRING];
+
+	ATCS_TIMED_LOCK(ml, GetMutex(), "X2Mount::establishLink mutex wait");
+	// get serial port device name, or the bridge address for TCP
+    if(mATCS.getTransportType() == TRANSPORT_TCP) {
+        snprintf(szPort, DRIVER_MAX_STRING, DEF_TCP_ADDRESS);
+        if (m_pIniUtil)
+            m_pIniUtil->readString(PARENT_KEY, CHILD_KEY_TCP_ADDRESS, szPort, szPort, DRIVER_MAX_STRING);
+    }
+    else
+        portNameOnToCharPtr(szPort,DRIVER_MAX_STRING);
 
-	X2MutexLocker ml(GetMutex());
-	// get serial port device name
-    portNameOnToCharPtr(szPort,DRIVER_MAX_STRING);
-
-	nErr =  mATCS.Connect(szPort);
+    nErr =  mATCS.Connect(szPort);
     if(nErr) {
         m_bLinked = false;
     }
     else {
         m_bLinked = true;
+        szHorizonFile[0] = 0;
+        if (m_pIniUtil)
+            m_pIniUtil->readString(PARENT_KEY, CHILD_KEY_HORIZON_FILE, "", szHorizonFile, DRIVER_MAX_STRING);
+        if(mATCS.loadHorizonMask(szHorizonFile))
+            m_pLogger->out("Can't read the horizon file, slews are only checked against the mount limits");
     }
     return nErr;
 }
 
 int X2Mount::terminateLink(void)
 {
+    ATCS_SCOPED_SPAN("X2Mount::terminateLink");
     int nErr = SB_OK;
 
-	X2MutexLocker ml(GetMutex());
+    // establishLink may be holding the mutex in its handshake, stop it first
+    mATCS.cancelConnect();
+	ATCS_TIMED_LOCK(ml, GetMutex(), "X2Mount::terminateLink mutex wait");
 
     nErr = mATCS.Disconnect();
     m_bLinked = false;
@@ -420,7 +450,7 @@ bool X2Mount::isLinked(void) const
 
 bool X2Mount::isEstablishLinkAbortable(void) const
 {
-    return false;
+    return true;
 }
 
 #pragma mark - AbstractDriverInfo
@@ -439,7 +469,7 @@ void X2Mount::deviceInfoNameShort(BasicStringInterface& str) const
 {
     if(m_bLinked) {
         X2Mount* pMe = (X2Mount*)this;
-        X2MutexLocker ml(pMe->GetMutex());
+        ATCS_TIMED_LOCK(ml, pMe->GetMutex(), "X2Mount::deviceInfoNameShort mutex wait");
         std::string sModel;
         pMe->mATCS.getModel(sModel);
         str = sModel.c_str();
@@ -459,9 +489,10 @@ void X2Mount::deviceInfoDetailedDescription(BasicStringInterface& str) const
 }
 void X2Mount::deviceInfoFirmwareVersion(BasicStringInterface& str)
 {
+    ATCS_SCOPED_SPAN("X2Mount::deviceInfoFirmwareVersion");
     if(m_bLinked) {
         std::string sFirmware;
-        X2MutexLocker ml(GetMutex());
+        ATCS_TIMED_LOCK(ml, GetMutex(), "X2Mount::deviceInfoFirmwareVersion mutex wait");
         mATCS.getFirmwareVersion(sFirmware);
         str = sFirmware.c_str();
     }
@@ -470,8 +501,9 @@ void X2Mount::deviceInfoFirmwareVersion(BasicStringInterface& str)
 }
 void X2Mount::deviceInfoModel(BasicStringInterface& str)
 {
+    ATCS_SCOPED_SPAN("X2Mount::deviceInfoModel");
     if(m_bLinked) {
-        X2MutexLocker ml(GetMutex());
+        ATCS_TIMED_LOCK(ml, GetMutex(), "X2Mount::deviceInfoModel mutex wait");
         std::string sModel;
         mATCS.getModel(sModel);
         str = sModel.c_str();
@@ -483,15 +515,19 @@ void X2Mount::deviceInfoModel(BasicStringInterface& str)
 #pragma mark - Common Mount specifics
 int X2Mount::raDec(double& ra, double& dec, const bool& bCached)
 {
+    ATCS_SCOPED_SPAN("X2Mount::raDec");
 	int nErr = 0;
 
     if(!m_bLinked)
         return ERR_NOLINK;
 
-    X2MutexLocker ml(GetMutex());
+    ATCS_TIMED_LOCK(ml, GetMutex(), "X2Mount::raDec mutex wait");
+
+    // TheSkyX polls the position all the time, a good moment to save what the background setup found
+    mATCS.savePendingSnapshot();
 
 	// Get the RA and DEC from the mount
-	nErr = mATCS.getRaAndDec(ra, dec);
+	nErr = mATCS.getRaAndDec(ra, dec, bCached ? POLL_AGE_CACHED : POLL_AGE_POSITION);
     if(nErr)
         nErr = ERR_CMDFAILED;
 
@@ -511,11 +547,14 @@ int X2Mount::raDec(double& ra, double& dec, const bool& bCached)
 
 int X2Mount::abort()
 {
+    ATCS_SCOPED_SPAN("X2Mount::abort");
     int nErr = SB_OK;
     if(!m_bLinked)
         return ERR_NOLINK;
 
-    X2MutexLocker ml(GetMutex());
+    // a sync, slew or unpark holding the mutex stops at its next step instead of running to the end
+    mATCS.requestAbort();
+    ATCS_TIMED_LOCK(ml, GetMutex(), "X2Mount::abort mutex wait");
 
 #ifdef ATCS_X2_DEBUG
 	if (LogFile) {
@@ -546,12 +585,13 @@ int X2Mount::abort()
 
 int X2Mount::startSlewTo(const double& dRa, const double& dDec)
 {
+    ATCS_SCOPED_SPAN("X2Mount::startSlewTo");
 	int nErr = SB_OK;
 
     if(!m_bLinked)
         return ERR_NOLINK;
 
-    X2MutexLocker ml(GetMutex());
+    // no X2 lock, ATCS runs one sync or slew at a time and takes the link per exchange, the polls go on meanwhile
 
 #ifdef ATCS_X2_DEBUG
 	if (LogFile) {
@@ -574,6 +614,9 @@ int X2Mount::startSlewTo(const double& dRa, const double& dDec)
         }
 #endif
         m_pLogger->out("startSlewTo ERROR");
+        // refused locally, nothing was sent
+        if(nErr == ERR_LIMITSEXCEEDED)
+            return nErr;
         return ERR_CMDFAILED;
     }
 
@@ -582,12 +625,13 @@ int X2Mount::startSlewTo(const double& dRa, const double& dDec)
 
 int X2Mount::isCompleteSlewTo(bool& bComplete) const
 {
+    ATCS_SCOPED_SPAN("X2Mount::isCompleteSlewTo");
     int nErr = SB_OK;
     if(!m_bLinked)
         return ERR_NOLINK;
 
     X2Mount* pMe = (X2Mount*)this;
-    X2MutexLocker ml(pMe->GetMutex());
+    ATCS_TIMED_LOCK(ml, pMe->GetMutex(), "X2Mount::isCompleteSlewTo mutex wait");
 
     nErr = pMe->mATCS.isSlewToComplete(bComplete);
     if(nErr)
@@ -608,6 +652,7 @@ int X2Mount::isCompleteSlewTo(bool& bComplete) const
 
 int X2Mount::endSlewTo(void)
 {
+    ATCS_SCOPED_SPAN("X2Mount::endSlewTo");
 #ifdef ATCS_X2_DEBUG
     if (LogFile) {
         time_t ltime = time(NULL);
@@ -623,12 +668,13 @@ int X2Mount::endSlewTo(void)
 
 int X2Mount::syncMount(const double& ra, const double& dec)
 {
+    ATCS_SCOPED_SPAN("X2Mount::syncMount");
 	int nErr = SB_OK;
 
     if(!m_bLinked)
         return ERR_NOLINK;
 
-    X2MutexLocker ml(GetMutex());
+    // no X2 lock, same as startSlewTo
 
 #ifdef ATCS_X2_DEBUG
     if (LogFile) {
@@ -659,12 +705,13 @@ int X2Mount::syncMount(const double& ra, const double& dec)
 
 bool X2Mount::isSynced(void)
 {
+    ATCS_SCOPED_SPAN("X2Mount::isSynced");
     int nErr;
 
     if(!m_bLinked)
         return false;
 
-    X2MutexLocker ml(GetMutex());
+    ATCS_TIMED_LOCK(ml, GetMutex(), "X2Mount::isSynced mutex wait");
 
    nErr = mATCS.isAligned(m_bSynced);
 
@@ -685,18 +732,41 @@ bool X2Mount::isSynced(void)
 #pragma mark - TrackingRatesInterface
 int X2Mount::setTrackingRates(const bool& bTrackingOn, const bool& bIgnoreRates, const double& dRaRateArcSecPerSec, const double& dDecRateArcSecPerSec)
 {
+    ATCS_SCOPED_SPAN("X2Mount::setTrackingRates");
     int nErr = SB_OK;
     double dTrackRaArcSecPerHr;
     double dTrackDecArcSecPerHr;
+    char szRateTable[DRIVER_MAX_STRING];
+    char szTLEFile[DRIVER_MAX_STRING];
+    std::string sTLELine1, sTLELine2;
+    CRateModel rateModel;
+
     if(!m_bLinked)
         return ERR_NOLINK;
 
-    X2MutexLocker ml(GetMutex());
+    ATCS_TIMED_LOCK(ml, GetMutex(), "X2Mount::setTrackingRates mutex wait");
 
     dTrackRaArcSecPerHr = dRaRateArcSecPerSec * 3600;
     dTrackDecArcSecPerHr = dDecRateArcSecPerSec * 3600;
 
-    nErr = mATCS.setTrackingRates(bTrackingOn, bIgnoreRates, dTrackRaArcSecPerHr, dTrackDecArcSecPerHr);
+    // custom rates : if we have an ephemeris table for tonight's target follow it instead of the static rates
+    // or in satellite mode, slew ahead of the satellite and follow its pass from there
+    szRateTable[0] = 0;
+    szTLEFile[0] = 0;
+    if(bTrackingOn && !bIgnoreRates && m_pIniUtil) {
+        m_pIniUtil->readString(PARENT_KEY, CHILD_KEY_RATE_TABLE, "", szRateTable, DRIVER_MAX_STRING);
+        if(m_pIniUtil->readInt(PARENT_KEY, CHILD_KEY_SATELLITE_MODE, 0) != 0)
+            m_pIniUtil->readString(PARENT_KEY, CHILD_KEY_SATELLITE_TLE, "", szTLEFile, DRIVER_MAX_STRING);
+    }
+    if(szRateTable[0] && rateModel.loadTable(szRateTable) && rateModel.covers((double)time(NULL)))
+        nErr = mATCS.startNonSiderealTracking(rateModel);
+    else if(szTLEFile[0] && mATCS.isSatelliteTrackingActive())
+        nErr = SB_OK;   // already on the pass, TheSkyX keeps sending rates while it follows the satellite
+    else if(szTLEFile[0] && CSatellitePredictor::readTLEFile(szTLEFile, sTLELine1, sTLELine2) == SGP4_OK &&
+            mATCS.startSatelliteTracking(sTLELine1, sTLELine2, 0) == PLUGIN_OK)
+        nErr = SB_OK;
+    else
+        nErr = mATCS.setTrackingRates(bTrackingOn, bIgnoreRates, dTrackRaArcSecPerHr, dTrackDecArcSecPerHr);
 #ifdef ATCS_X2_DEBUG
     if (LogFile) {
         time_t ltime = time(NULL);
@@ -725,6 +795,7 @@ int X2Mount::setTrackingRates(const bool& bTrackingOn, const bool& bIgnoreRates,
 
 int X2Mount::trackingRates(bool& bTrackingOn, double& dRaRateArcSecPerSec, double& dDecRateArcSecPerSec)
 {
+    ATCS_SCOPED_SPAN("X2Mount::trackingRates");
     int nErr = SB_OK;
     double dTrackRaArcSecPerHr;
     double dTrackDecArcSecPerHr;
@@ -732,7 +803,7 @@ int X2Mount::trackingRates(bool& bTrackingOn, double& dRaRateArcSecPerSec, doubl
     if(!m_bLinked)
         return ERR_NOLINK;
 
-    X2MutexLocker ml(GetMutex());
+    ATCS_TIMED_LOCK(ml, GetMutex(), "X2Mount::trackingRates mutex wait");
 
     nErr = mATCS.getTrackRates(bTrackingOn, dTrackRaArcSecPerHr, dTrackDecArcSecPerHr);
     if(nErr) {
@@ -765,11 +836,12 @@ int X2Mount::trackingRates(bool& bTrackingOn, double& dRaRateArcSecPerSec, doubl
 
 int X2Mount::siderealTrackingOn()
 {
+    ATCS_SCOPED_SPAN("X2Mount::siderealTrackingOn");
     int nErr = SB_OK;
     if(!m_bLinked)
         return ERR_NOLINK;
 
-    X2MutexLocker ml(GetMutex());
+    ATCS_TIMED_LOCK(ml, GetMutex(), "X2Mount::siderealTrackingOn mutex wait");
 
 #ifdef ATCS_X2_DEBUG
     if (LogFile) {
@@ -800,11 +872,12 @@ int X2Mount::siderealTrackingOn()
 
 int X2Mount::trackingOff()
 {
+    ATCS_SCOPED_SPAN("X2Mount::trackingOff");
     int nErr = SB_OK;
     if(!m_bLinked)
         return ERR_NOLINK;
 
-    X2MutexLocker ml(GetMutex());
+    ATCS_TIMED_LOCK(ml, GetMutex(), "X2Mount::trackingOff mutex wait");
 
 #ifdef ATCS_X2_DEBUG
     if (LogFile) {
@@ -835,13 +908,14 @@ int X2Mount::trackingOff()
 #pragma mark - NeedsRefractionInterface
 bool X2Mount::needsRefactionAdjustments(void)
 {
+    ATCS_SCOPED_SPAN("X2Mount::needsRefactionAdjustments");
     bool bEnabled;
     int nErr;
 
     if(!m_bLinked)
         return false;
 
-    X2MutexLocker ml(GetMutex());
+    ATCS_TIMED_LOCK(ml, GetMutex(), "X2Mount::needsRefactionAdjustments mutex wait");
 
     // check if ATCS refraction adjustment is on.
     nErr = mATCS.getRefractionCorrEnabled(bEnabled);
@@ -863,6 +937,7 @@ bool X2Mount::needsRefactionAdjustments(void)
 #pragma mark - Parking Interface
 bool X2Mount::isParked(void)
 {
+    ATCS_SCOPED_SPAN("X2Mount::isParked");
     int nErr;
     bool bTrackingOn;
     bool bIsPArked;
@@ -871,7 +946,7 @@ bool X2Mount::isParked(void)
     if(!m_bLinked)
         return false;
 
-    X2MutexLocker ml(GetMutex());
+    ATCS_TIMED_LOCK(ml, GetMutex(), "X2Mount::isParked mutex wait");
 
     nErr = mATCS.getAtPark(bIsPArked);
     if(nErr) {
@@ -913,13 +988,14 @@ bool X2Mount::isParked(void)
 
 int X2Mount::startPark(const double& dAz, const double& dAlt)
 {
+    ATCS_SCOPED_SPAN("X2Mount::startPark");
 	double dRa, dDec;
 	int nErr = SB_OK;
 
     if(!m_bLinked)
         return ERR_NOLINK;
 	
-	X2MutexLocker ml(GetMutex());
+    ATCS_TIMED_LOCK(ml, GetMutex(), "X2Mount::startPark mutex wait");
 
 	nErr = m_pTheSkyXForMounts->HzToEq(dAz, dAlt, dRa, dDec);
     if (nErr) {
@@ -965,6 +1041,7 @@ int X2Mount::startPark(const double& dAz, const double& dAlt)
 
 int X2Mount::isCompletePark(bool& bComplete) const
 {
+    ATCS_SCOPED_SPAN("X2Mount::isCompletePark");
     int nErr = SB_OK;
 
     if(!m_bLinked)
@@ -972,7 +1049,7 @@ int X2Mount::isCompletePark(bool& bComplete) const
 
     X2Mount* pMe = (X2Mount*)this;
 
-    X2MutexLocker ml(pMe ->GetMutex());
+    ATCS_TIMED_LOCK(ml, pMe->GetMutex(), "X2Mount::isCompletePark mutex wait");
 
 #ifdef ATCS_X2_DEBUG
 	if (LogFile) {
@@ -1007,12 +1084,13 @@ int X2Mount::endPark(void)
 
 int X2Mount::startUnpark(void)
 {
+    ATCS_SCOPED_SPAN("X2Mount::startUnpark");
     int nErr = SB_OK;
 
     if(!m_bLinked)
         return ERR_NOLINK;
 
-    X2MutexLocker ml(GetMutex());
+    ATCS_TIMED_LOCK(ml, GetMutex(), "X2Mount::startUnpark mutex wait");
 
     nErr = mATCS.unPark();
     if(nErr) {
@@ -1036,6 +1114,7 @@ int X2Mount::startUnpark(void)
 */
 int X2Mount::isCompleteUnpark(bool& bComplete) const
 {
+    ATCS_SCOPED_SPAN("X2Mount::isCompleteUnpark");
     int nErr;
     bool bIsParked;
     bool bTrackingOn;
@@ -1046,7 +1125,7 @@ int X2Mount::isCompleteUnpark(bool& bComplete) const
 
     X2Mount* pMe = (X2Mount*)this;
 
-    X2MutexLocker ml(pMe ->GetMutex());
+    ATCS_TIMED_LOCK(ml, pMe->GetMutex(), "X2Mount::isCompleteUnpark mutex wait");
 
     bComplete = false;
 
@@ -1111,34 +1190,46 @@ bool X2Mount::knowsBeyondThePole()
 }
 
 int X2Mount::beyondThePole(bool& bYes) {
-	// bYes = mATCS.GetIsBeyondThePole();
-	return SB_OK;
+    ATCS_SCOPED_SPAN("X2Mount::beyondThePole");
+    int nErr = SB_OK;
+    if(!m_bLinked)
+        return ERR_NOLINK;
+
+    // answered from the local pier side model, no need for the mutex
+    nErr = mATCS.getBeyondThePole(bYes);
+    if(nErr)
+        return ERR_CMDFAILED;
+    return SB_OK;
 }
 
 
 double X2Mount::flipHourAngle() {
+    ATCS_SCOPED_SPAN("X2Mount::flipHourAngle");
+    double dFlipHourAngle;
+
+    dFlipHourAngle = mATCS.getFlipHourAngle();
 #ifdef ATCS_X2_DEBUG
 	if (LogFile) {
 		time_t ltime = time(NULL);
 		char *timestamp = asctime(localtime(&ltime));
 		timestamp[strlen(timestamp) - 1] = 0;
-		// fprintf(LogFile, "[%s] flipHourAngle called\n", timestamp);
+		fprintf(LogFile, "[%s] flipHourAngle = %f\n", timestamp, dFlipHourAngle);
         fflush(LogFile);
 	}
 #endif
 
-	return 0.0;
+	return dFlipHourAngle;
 }
 
 
 int X2Mount::gemLimits(double& dHoursEast, double& dHoursWest)
 {
+    ATCS_SCOPED_SPAN("X2Mount::gemLimits");
     int nErr = SB_OK;
     if(!m_bLinked)
         return ERR_NOLINK;
 
-    X2MutexLocker ml(GetMutex());
-
+    // cached after the first read, only that one goes to the controller
     nErr = mATCS.getLimits(dHoursEast, dHoursWest);
 
 #ifdef ATCS_X2_DEBUG
@@ -1152,10 +1243,9 @@ int X2Mount::gemLimits(double& dHoursEast, double& dHoursWest)
         fflush(LogFile);
     }
 #endif
-    // temp debugging.
-	dHoursEast = 0.0;
-	dHoursWest = 0.0;
-	return SB_OK;
+    if(nErr)
+        return ERR_CMDFAILED;
+    return SB_OK;
 }
 
 MountTypeInterface::Type X2Mount::mountType()
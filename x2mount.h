@@ -31,11 +31,22 @@
 
 #define PARENT_KEY			"ATCSMount"
 #define CHILD_KEY_PORT_NAME "PortName"
+#define CHILD_KEY_TRANSPORT "Transport"     // 0 = TheSkyX serial, 1 = native Linux serial, 2 = TCP
+#define CHILD_KEY_TCP_ADDRESS "TCPAddress"  // host:port of the serial to Ethernet bridge
+#define CHILD_KEY_SHARED_REACTOR "SharedReactor"    // 1 = all instances share one I/O thread
+#define CHILD_KEY_TRACE "Trace"             // 1 = write a Chrome trace-event file (ATCSTrace.json in home)
+#define CHILD_KEY_RATE_TABLE "NonSiderealTable" // ephemeris rate table followed when custom rates are set
+#define CHILD_KEY_HORIZON_FILE "HorizonFile"    // "azimuth altitude" points, slews below them are refused
+#define CHILD_KEY_TIMED_MOVE "TimedMoveMs"      // > 0 : open loop moves stop on their own after that many ms
+#define CHILD_KEY_SATELLITE_TLE "SatelliteTLE"  // TLE file of the satellite followed in satellite mode
+#define CHILD_KEY_SATELLITE_MODE "SatelliteMode"    // 1 = custom rates follow the SatelliteTLE pass instead of being set as is
 #define MAX_PORT_NAME_SIZE 120
 
 
 // #define ATCS_X2_DEBUG    // Define this to have log files
 
+#define DEF_TCP_ADDRESS                 "127.0.0.1:4001"
+
 #if defined(SB_WIN_BUILD)
 #define DEF_PORT_NAME					"COM1"
 #elif defined(SB_LINUX_BUILD)